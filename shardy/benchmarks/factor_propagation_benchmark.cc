@@ -0,0 +1,304 @@
+/* Copyright 2024 The Shardy Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Micro-benchmarks for the hot kernels of factor propagation.
+//
+// All benchmarks take two arguments: the number of factors in the synthetic
+// sharding rule (2-64) and the number of axes in the mesh (1-6).
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/Support/LLVM.h"
+#include "shardy/dialect/sdy/ir/dialect.h"
+#include "shardy/dialect/sdy/ir/register.h"
+#include "shardy/dialect/sdy/transforms/propagation/aggressive_factor_propagation.h"
+#include "shardy/dialect/sdy/transforms/propagation/basic_factor_propagation.h"
+#include "shardy/dialect/sdy/transforms/propagation/sharding_projection.h"
+#include "benchmark/benchmark.h"
+
+namespace mlir {
+namespace sdy {
+
+namespace {
+
+constexpr StringRef kMeshName = "mesh";
+constexpr int64_t kFactorSize = 4;
+// The maximum number of factors a single tensor is mapped to, so that tensor
+// sizes don't overflow for large rules.
+constexpr int64_t kMaxFactorsPerTensor = 8;
+constexpr int64_t kFactorsPerDim = 2;
+
+// A synthetic sharding rule with its operand and result shardings.
+//
+// Operand `i` is mapped to the window of factors
+// `[4*i, min(4*i + kMaxFactorsPerTensor, numFactors))`, so adjacent operands
+// share factors, and the single result is mapped to the first
+// `kMaxFactorsPerTensor` factors in reverse order. Every `kFactorsPerDim`
+// consecutive factors of a tensor are mapped to the same dimension.
+//
+// Mesh axes are named "a0", "a1", ..., with alternating sizes 4 and 8. Some
+// dimensions are sharded on a single mesh axis (each axis is used at most once
+// per tensor), while all other dimensions are open and unsharded.
+struct SyntheticRule {
+  MeshAttr mesh;
+  OpShardingRuleAttr rule;
+  SmallVector<TensorShardingAttr> operandShardings;
+  SmallVector<TensorShardingAttr> resultShardings;
+};
+
+MeshAttr createMesh(MLIRContext* context, int64_t numAxes) {
+  SmallVector<MeshAxisAttr> axes;
+  for (int64_t i = 0; i < numAxes; ++i) {
+    axes.push_back(MeshAxisAttr::get(context, "a" + std::to_string(i),
+                                     i % 2 == 0 ? 4 : 8));
+  }
+  return MeshAttr::get(context, axes);
+}
+
+// Creates the tensor mapping and sharding of a tensor with the given
+// `factorIndices`, where `tensorIndex` is used to vary which dimensions are
+// sharded.
+std::pair<TensorMappingAttr, TensorShardingAttr> createTensor(
+    MLIRContext* context, MeshAttr mesh, ArrayRef<int64_t> factorIndices,
+    int64_t tensorIndex) {
+  SmallVector<DimMappingAttr> dimMappings;
+  SmallVector<DimensionShardingAttr> dimShardings;
+  llvm::SmallDenseSet<int64_t> usedAxes;
+  int64_t numAxes = mesh.getAxes().size();
+  for (int64_t start = 0; start < static_cast<int64_t>(factorIndices.size());
+       start += kFactorsPerDim) {
+    int64_t dim = dimMappings.size();
+    dimMappings.push_back(DimMappingAttr::get(
+        context, factorIndices.slice(
+                     start, std::min<int64_t>(kFactorsPerDim,
+                                              factorIndices.size() - start))));
+    SmallVector<AxisRefAttr> axes;
+    int64_t axisIndex = (tensorIndex + dim) % numAxes;
+    if ((tensorIndex + dim) % 3 == 0 && usedAxes.insert(axisIndex).second) {
+      axes.push_back(
+          AxisRefAttr::get(context, mesh.getAxes()[axisIndex].getName()));
+    }
+    dimShardings.push_back(
+        DimensionShardingAttr::get(context, axes, /*isClosed=*/false));
+  }
+  return {TensorMappingAttr::get(context, dimMappings),
+          TensorShardingAttr::get(context, kMeshName, dimShardings,
+                                  /*replicatedAxes=*/{})};
+}
+
+SyntheticRule createSyntheticRule(MLIRContext* context, int64_t numFactors,
+                                  int64_t numAxes) {
+  SyntheticRule result;
+  result.mesh = createMesh(context, numAxes);
+
+  SmallVector<TensorMappingAttr> operandMappings, resultMappings;
+  int64_t tensorIndex = 0;
+  for (int64_t start = 0; start < numFactors; start += 4) {
+    SmallVector<int64_t> factorIndices;
+    for (int64_t factor = start;
+         factor < std::min(start + kMaxFactorsPerTensor, numFactors);
+         ++factor) {
+      factorIndices.push_back(factor);
+    }
+    auto [mapping, sharding] =
+        createTensor(context, result.mesh, factorIndices, tensorIndex++);
+    operandMappings.push_back(mapping);
+    result.operandShardings.push_back(sharding);
+  }
+  SmallVector<int64_t> resultFactorIndices;
+  for (int64_t factor = std::min(kMaxFactorsPerTensor, numFactors) - 1;
+       factor >= 0; --factor) {
+    resultFactorIndices.push_back(factor);
+  }
+  auto [mapping, sharding] =
+      createTensor(context, result.mesh, resultFactorIndices, tensorIndex);
+  resultMappings.push_back(mapping);
+  result.resultShardings.push_back(sharding);
+
+  result.rule = OpShardingRuleAttr::get(
+      context, SmallVector<int64_t>(numFactors, kFactorSize), operandMappings,
+      resultMappings);
+  return result;
+}
+
+// Common setup for all benchmarks in this file.
+class FactorPropagationFixture : public benchmark::Fixture {
+ public:
+  void SetUp(benchmark::State& state) override {
+    loadAllRequiredDialects(&context);
+    rule = createSyntheticRule(&context, state.range(0), state.range(1));
+    projection =
+        ShardingProjection::build(rule.operandShardings, rule.resultShardings,
+                                  rule.rule, rule.mesh);
+  }
+
+  void TearDown(benchmark::State& state) override {
+    state.counters["tensors"] = projection.getNumTensors();
+  }
+
+ protected:
+  MLIRContext context;
+  SyntheticRule rule;
+  ShardingProjection projection;
+};
+
+void factorAndMeshArgs(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"factors", "axes"})
+      ->ArgsProduct({{2, 4, 8, 16, 32, 64}, {1, 2, 4, 6}});
+}
+
+// The axis-ref benchmarks only depend on the mesh.
+void meshArgs(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"factors", "axes"})->ArgsProduct({{2}, {1, 2, 4, 6}});
+}
+
+BENCHMARK_DEFINE_F(FactorPropagationFixture, ShardingProjectionBuild)
+(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        ShardingProjection::build(rule.operandShardings, rule.resultShardings,
+                                  rule.rule, rule.mesh));
+  }
+}
+BENCHMARK_REGISTER_F(FactorPropagationFixture, ShardingProjectionBuild)
+    ->Apply(factorAndMeshArgs);
+
+// The propagation benchmarks below propagate on a fresh copy of the projection
+// in each iteration, so this measures the copy overhead included in them.
+BENCHMARK_DEFINE_F(FactorPropagationFixture, ShardingProjectionCopy)
+(benchmark::State& state) {
+  for (auto _ : state) {
+    ShardingProjection copy = projection;
+    benchmark::DoNotOptimize(copy);
+  }
+}
+BENCHMARK_REGISTER_F(FactorPropagationFixture, ShardingProjectionCopy)
+    ->Apply(factorAndMeshArgs);
+
+BENCHMARK_DEFINE_F(FactorPropagationFixture, BasicFactorPropagation)
+(benchmark::State& state) {
+  BasicFactorPropagation factorPropagation;
+  for (auto _ : state) {
+    ShardingProjection copy = projection;
+    benchmark::DoNotOptimize(factorPropagation.propagateFactorShardings(
+        copy, PropagationDirection::BOTH, rule.rule.getFactorSizes(),
+        rule.mesh, /*op=*/nullptr, /*conservativePropagation=*/false));
+  }
+}
+BENCHMARK_REGISTER_F(FactorPropagationFixture, BasicFactorPropagation)
+    ->Apply(factorAndMeshArgs);
+
+BENCHMARK_DEFINE_F(FactorPropagationFixture, AggressiveFactorPropagation)
+(benchmark::State& state) {
+  AggressiveFactorPropagation factorPropagation;
+  for (auto _ : state) {
+    ShardingProjection copy = projection;
+    benchmark::DoNotOptimize(factorPropagation.propagateFactorShardings(
+        copy, PropagationDirection::BOTH, rule.rule.getFactorSizes(),
+        rule.mesh, /*op=*/nullptr, /*conservativePropagation=*/false));
+  }
+}
+BENCHMARK_REGISTER_F(FactorPropagationFixture, AggressiveFactorPropagation)
+    ->Apply(factorAndMeshArgs);
+
+// Creates the sharding attribute of every operand and result of an already
+// propagated projection.
+BENCHMARK_DEFINE_F(FactorPropagationFixture, CreateTensorShardingAttr)
+(benchmark::State& state) {
+  AggressiveFactorPropagation().propagateFactorShardings(
+      projection, PropagationDirection::BOTH, rule.rule.getFactorSizes(),
+      rule.mesh, /*op=*/nullptr, /*conservativePropagation=*/false);
+  for (auto _ : state) {
+    for (auto [operand, mapping] :
+         llvm::zip(projection.getOperands(), rule.rule.getOperandMappings())) {
+      benchmark::DoNotOptimize(operand.createTensorShardingAttr(
+          &context, mapping, rule.rule.getFactorSizes(), kMeshName,
+          rule.mesh));
+    }
+    for (auto [result, mapping] :
+         llvm::zip(projection.getResults(), rule.rule.getResultMappings())) {
+      benchmark::DoNotOptimize(result.createTensorShardingAttr(
+          &context, mapping, rule.rule.getFactorSizes(), kMeshName,
+          rule.mesh));
+    }
+  }
+}
+BENCHMARK_REGISTER_F(FactorPropagationFixture, CreateTensorShardingAttr)
+    ->Apply(factorAndMeshArgs);
+
+// Returns all full axes and all sub-axes of size > 1 of each axis in `mesh`.
+SmallVector<AxisRefAttr> getAllAxisRefs(MLIRContext* context, MeshAttr mesh) {
+  SmallVector<AxisRefAttr> axisRefs;
+  for (MeshAxisAttr axis : mesh.getAxes()) {
+    axisRefs.push_back(AxisRefAttr::get(context, axis.getName()));
+    for (int64_t preSize = 1; preSize < axis.getSize(); preSize *= 2) {
+      for (int64_t size = 2; preSize * size <= axis.getSize(); size *= 2) {
+        if (preSize * size != axis.getSize() || preSize != 1) {
+          axisRefs.push_back(
+              AxisRefAttr::get(context, axis.getName(), preSize, size));
+        }
+      }
+    }
+  }
+  return axisRefs;
+}
+
+// Checks all pairs of axis refs in the mesh for overlap.
+BENCHMARK_DEFINE_F(FactorPropagationFixture, AxisRefOverlaps)
+(benchmark::State& state) {
+  SmallVector<AxisRefAttr> axisRefs = getAllAxisRefs(&context, rule.mesh);
+  for (auto _ : state) {
+    for (AxisRefAttr lhs : axisRefs) {
+      for (AxisRefAttr rhs : axisRefs) {
+        benchmark::DoNotOptimize(lhs.overlaps(rhs));
+        benchmark::DoNotOptimize(lhs.getPrefixWithoutOverlap(rhs));
+      }
+    }
+  }
+  state.counters["pairs"] = axisRefs.size() * axisRefs.size();
+}
+BENCHMARK_REGISTER_F(FactorPropagationFixture, AxisRefOverlaps)
+    ->Apply(meshArgs);
+
+// Checks all pairs of axis refs in the mesh for whether they can be merged,
+// and merges them if so.
+BENCHMARK_DEFINE_F(FactorPropagationFixture, AxisRefMerge)
+(benchmark::State& state) {
+  SmallVector<AxisRefAttr> axisRefs = getAllAxisRefs(&context, rule.mesh);
+  for (auto _ : state) {
+    for (AxisRefAttr lhs : axisRefs) {
+      for (AxisRefAttr rhs : axisRefs) {
+        if (lhs.canMerge(rhs)) {
+          benchmark::DoNotOptimize(lhs.merge(rhs, rule.mesh));
+        }
+      }
+    }
+  }
+  state.counters["pairs"] = axisRefs.size() * axisRefs.size();
+}
+BENCHMARK_REGISTER_F(FactorPropagationFixture, AxisRefMerge)
+    ->Apply(meshArgs);
+
+}  // namespace
+
+}  // namespace sdy
+}  // namespace mlir
@@ -0,0 +1,196 @@
+/* Copyright 2024 The Shardy Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Benchmarks the SDY propagation pipeline and its main stages on synthetic
+// modules of increasing scale (see `SyntheticModuleKind`).
+//
+// Each benchmark reports the number of ops processed per second and the peak
+// resident set size of the process, so they can be tracked across releases.
+//
+// Example:
+//   bazel run -c opt //shardy/benchmarks:propagation_benchmark -- \
+//     --benchmark_filter=transformer
+
+#include <sys/resource.h>
+
+#include <cstdint>
+#include <utility>
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/Pass/PassManager.h"
+#include "mlir/Support/LLVM.h"
+#include "mlir/Support/LogicalResult.h"
+#include "shardy/benchmarks/synthetic_modules.h"
+#include "shardy/dialect/sdy/ir/register.h"
+#include "shardy/dialect/sdy/transforms/export/passes.h"
+#include "shardy/dialect/sdy/transforms/import/passes.h"
+#include "shardy/dialect/sdy/transforms/propagation/basic_propagation.h"
+#include "shardy/dialect/sdy/transforms/propagation/passes.h"
+#include "shardy/dialect/sdy/transforms/propagation/user_priority_propagation.h"
+#include "benchmark/benchmark.h"
+
+namespace mlir {
+namespace sdy {
+
+namespace {
+
+// The stage of the propagation pipeline that is measured.
+enum class Stage {
+  // The full `sdy-propagation-pipeline` (import, propagation and export).
+  kPropagationPipeline,
+  // Only `sdy-user-priority-propagate`, on an already imported module.
+  kUserPriorityPropagation,
+  // Only the export pipeline, on an already propagated module.
+  kExportPipeline,
+};
+
+void addStagePasses(OpPassManager& pm, Stage stage) {
+  switch (stage) {
+    case Stage::kPropagationPipeline:
+      addPropagationPipeline(pm);
+      break;
+    case Stage::kUserPriorityPropagation:
+      pm.addPass(createUserPriorityPropagationPass(PropagationOptions()));
+      break;
+    case Stage::kExportPipeline:
+      addExportPipeline(pm);
+      break;
+  }
+}
+
+// Runs the passes that precede `stage` in the propagation pipeline on
+// `moduleOp`, so the measured passes see the same input as in the pipeline.
+LogicalResult prepareForStage(ModuleOp moduleOp, Stage stage) {
+  PassManager pm(moduleOp.getContext());
+  switch (stage) {
+    case Stage::kPropagationPipeline:
+      return success();
+    case Stage::kUserPriorityPropagation:
+      addImportPipeline(pm);
+      break;
+    case Stage::kExportPipeline:
+      addImportPipeline(pm);
+      pm.addPass(createUserPriorityPropagationPass(PropagationOptions()));
+      break;
+  }
+  return pm.run(moduleOp);
+}
+
+int64_t getPeakRssBytes() {
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  // `ru_maxrss` is in kilobytes on Linux.
+  return static_cast<int64_t>(usage.ru_maxrss) * 1024;
+}
+
+void runBenchmark(benchmark::State& state, SyntheticModuleKind kind,
+                  Stage stage) {
+  MLIRContext context;
+  loadAllRequiredDialects(&context);
+  // Single threaded to get stable numbers that are comparable across machines.
+  context.disableMultithreading();
+
+  int64_t scale = state.range(0);
+  int64_t numCarriedValues = state.range(1);
+  OwningOpRef<ModuleOp> moduleOp =
+      parseSyntheticModule(&context, kind, scale, numCarriedValues);
+  if (!moduleOp) {
+    state.SkipWithError("failed to parse synthetic module");
+    return;
+  }
+  if (failed(prepareForStage(moduleOp.get(), stage))) {
+    state.SkipWithError("failed to prepare synthetic module");
+    return;
+  }
+
+  int64_t numOps = 0;
+  moduleOp->walk([&](Operation*) { ++numOps; });
+
+  PassManager pm(&context);
+  addStagePasses(pm, stage);
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    OwningOpRef<ModuleOp> clonedModuleOp = moduleOp->clone();
+    state.ResumeTiming();
+    if (failed(pm.run(clonedModuleOp.get()))) {
+      state.SkipWithError("pass pipeline failed");
+      return;
+    }
+    state.PauseTiming();
+    // Don't measure the destruction of the cloned module.
+    clonedModuleOp = nullptr;
+    state.ResumeTiming();
+  }
+
+  state.counters["ops"] = static_cast<double>(numOps);
+  state.counters["ops_per_second"] =
+      benchmark::Counter(static_cast<double>(numOps),
+                         benchmark::Counter::kIsIterationInvariantRate);
+  state.counters["peak_rss_bytes"] = benchmark::Counter(
+      static_cast<double>(getPeakRssBytes()), benchmark::Counter::kDefaults,
+      benchmark::Counter::kIs1024);
+}
+
+// Registers a benchmark for each `Stage` with the given `kind`, where the
+// first argument is the scale and the second is the number of carried values
+// (only used by `SyntheticModuleKind::kWhileLoop`).
+void registerBenchmarks(SyntheticModuleKind kind,
+                        ArrayRef<std::pair<int64_t, int64_t>> args) {
+  auto registerStage = [&](Stage stage, StringRef stageName) {
+    benchmark::internal::Benchmark* benchmark = benchmark::RegisterBenchmark(
+        (getSyntheticModuleKindName(kind) + "/" + stageName).str(),
+        [kind, stage](benchmark::State& state) {
+          runBenchmark(state, kind, stage);
+        });
+    benchmark->ArgNames({"scale", "carried"})->Unit(benchmark::kMillisecond);
+    for (auto [scale, numCarriedValues] : args) {
+      benchmark->Args({scale, numCarriedValues});
+    }
+  };
+  registerStage(Stage::kPropagationPipeline, "propagation_pipeline");
+  registerStage(Stage::kUserPriorityPropagation, "user_priority_propagate");
+  registerStage(Stage::kExportPipeline, "export_pipeline");
+}
+
+void registerAllBenchmarks() {
+  registerBenchmarks(SyntheticModuleKind::kTransformer,
+                     {{1, 0}, {4, 0}, {16, 0}, {64, 0}});
+  registerBenchmarks(SyntheticModuleKind::kMixtureOfExperts,
+                     {{1, 0}, {4, 0}, {16, 0}, {64, 0}});
+  registerBenchmarks(SyntheticModuleKind::kConvNet,
+                     {{1, 0}, {8, 0}, {32, 0}, {128, 0}});
+  registerBenchmarks(SyntheticModuleKind::kWhileLoop,
+                     {{1, 16}, {4, 16}, {4, 64}, {16, 64}, {16, 256}});
+}
+
+}  // namespace
+
+}  // namespace sdy
+}  // namespace mlir
+
+int main(int argc, char** argv) {
+  mlir::sdy::registerAllBenchmarks();
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1,134 @@
+/* Copyright 2024 The Shardy Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Benchmarks parsing textual modules full of shardings, with the hand-written
+// fast path for shardings (see `parseShardingFastPath`) against the generic
+// `AsmParser` based parser.
+//
+// The parsed modules are synthetic modules (see `SyntheticModuleKind`) after
+// propagation, so most values have a sharding.
+//
+// Example:
+//   bazel run -c opt //shardy/benchmarks:sharding_parse_benchmark -- \
+//     --benchmark_filter=transformer
+
+#include <cstdint>
+#include <string>
+
+#include "llvm/Support/raw_ostream.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Pass/PassManager.h"
+#include "mlir/Support/LLVM.h"
+#include "shardy/benchmarks/synthetic_modules.h"
+#include "shardy/dialect/sdy/ir/dialect.h"
+#include "shardy/dialect/sdy/ir/register.h"
+#include "shardy/dialect/sdy/transforms/propagation/passes.h"
+#include "benchmark/benchmark.h"
+
+namespace mlir {
+namespace sdy {
+
+namespace {
+
+// Returns the text of a synthetic module of the given `kind` and `scale` after
+// propagation, or an empty string if propagation failed.
+std::string getPropagatedModuleText(MLIRContext* context,
+                                    SyntheticModuleKind kind, int64_t scale) {
+  OwningOpRef<ModuleOp> moduleOp = parseSyntheticModule(context, kind, scale);
+  if (!moduleOp) {
+    return "";
+  }
+  PassManager pm(context);
+  addPropagationPipeline(pm);
+  if (failed(pm.run(moduleOp.get()))) {
+    return "";
+  }
+  std::string text;
+  llvm::raw_string_ostream os(text);
+  moduleOp->print(os);
+  return text;
+}
+
+void runBenchmark(benchmark::State& state, SyntheticModuleKind kind,
+                  bool useFastPath) {
+  MLIRContext context;
+  loadAllRequiredDialects(&context);
+  // Single threaded to get stable numbers that are comparable across machines.
+  context.disableMultithreading();
+
+  std::string text = getPropagatedModuleText(&context, kind, state.range(0));
+  if (text.empty()) {
+    state.SkipWithError("failed to propagate synthetic module");
+    return;
+  }
+
+  setUseShardingFastPathParser(&context, useFastPath);
+  for (auto _ : state) {
+    OwningOpRef<ModuleOp> moduleOp =
+        parseSourceString<ModuleOp>(text, ParserConfig(&context));
+    if (!moduleOp) {
+      state.SkipWithError("failed to parse module");
+      break;
+    }
+    state.PauseTiming();
+    // Don't measure the destruction of the parsed module.
+    moduleOp = nullptr;
+    state.ResumeTiming();
+  }
+
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<int64_t>(text.size()));
+}
+
+void registerBenchmarks(SyntheticModuleKind kind, ArrayRef<int64_t> scales) {
+  auto registerParser = [&](bool useFastPath, StringRef parserName) {
+    benchmark::internal::Benchmark* benchmark = benchmark::RegisterBenchmark(
+        (getSyntheticModuleKindName(kind) + "/" + parserName).str(),
+        [kind, useFastPath](benchmark::State& state) {
+          runBenchmark(state, kind, useFastPath);
+        });
+    benchmark->ArgName("scale")->Unit(benchmark::kMillisecond);
+    for (int64_t scale : scales) {
+      benchmark->Arg(scale);
+    }
+  };
+  registerParser(/*useFastPath=*/true, "fast_path");
+  registerParser(/*useFastPath=*/false, "generic");
+}
+
+void registerAllBenchmarks() {
+  registerBenchmarks(SyntheticModuleKind::kTransformer, {1, 16, 64});
+  registerBenchmarks(SyntheticModuleKind::kMixtureOfExperts, {1, 16, 64});
+  registerBenchmarks(SyntheticModuleKind::kConvNet, {8, 128});
+}
+
+}  // namespace
+
+}  // namespace sdy
+}  // namespace mlir
+
+int main(int argc, char** argv) {
+  mlir::sdy::registerAllBenchmarks();
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1,421 @@
+/* Copyright 2024 The Shardy Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "shardy/benchmarks/synthetic_modules.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Support/LLVM.h"
+
+namespace mlir {
+namespace sdy {
+
+namespace {
+
+using llvm::formatv;
+
+constexpr StringRef kMesh =
+    R"(sdy.mesh @mesh = <["data"=8, "model"=4, "expert"=2]>)";
+
+// Returns the textual f32 tensor type with the given `shape`.
+std::string tensorType(ArrayRef<int64_t> shape) {
+  std::string result = "tensor<";
+  for (int64_t dim : shape) {
+    result += std::to_string(dim) + "x";
+  }
+  return result + "f32>";
+}
+
+// Returns the textual `sdy.sharding` attribute for the given dimension
+// shardings, e.g. `{"data"}, {}`.
+std::string shardingAttr(StringRef dimShardings) {
+  return formatv("{{sdy.sharding = #sdy.sharding<@mesh, [{0}]>}", dimShardings);
+}
+
+// Incrementally builds the text of a module with a single `main` function.
+class ModuleTextBuilder {
+ public:
+  // Adds a function argument of the given `type` with an optional textual
+  // `attrDict`, and returns its SSA name.
+  std::string addArg(StringRef type, StringRef attrDict = "") {
+    std::string name = formatv("%arg{0}", args.size());
+    args.push_back(formatv("{0}: {1} {2}", name, type, attrDict));
+    return name;
+  }
+
+  // Returns a new unique SSA name with the given `prefix`.
+  std::string newValue(StringRef prefix = "v") {
+    return formatv("%{0}{1}", prefix, nextValueId++);
+  }
+
+  // Appends `line` to the function body with the current indentation.
+  void addLine(const Twine& line) {
+    body.append(indent, ' ');
+    body += line.str();
+    body += "\n";
+  }
+
+  void pushIndent() { indent += 2; }
+  void popIndent() { indent -= 2; }
+
+  // Emits `%result = <opName> <operands> : <signature>` and returns the result
+  // SSA name.
+  std::string addOp(StringRef opName, StringRef operandsAndAttrs,
+                    StringRef signature) {
+    std::string result = newValue();
+    addLine(formatv("{0} = {1} {2} : {3}", result, opName, operandsAndAttrs,
+                    signature));
+    return result;
+  }
+
+  // Returns the module text, where `main` returns `result` of type
+  // `resultType`.
+  std::string build(StringRef result, StringRef resultType) {
+    std::string module = kMesh.str() + "\n\n";
+    module += formatv("func.func @main({0}) -> {1} {{\n",
+                      llvm::join(args, ",\n    "), resultType);
+    module += body;
+    module += formatv("  return {0} : {1}\n}\n", result, resultType);
+    return module;
+  }
+
+ private:
+  SmallVector<std::string> args;
+  std::string body;
+  int64_t nextValueId = 0;
+  int64_t indent = 2;
+};
+
+std::string generateTransformer(int64_t numLayers) {
+  constexpr int64_t kBatch = 8, kSeq = 128, kHidden = 256, kFfn = 1024;
+  std::string actType = tensorType({kBatch, kSeq, kHidden});
+  std::string scoresType = tensorType({kBatch, kSeq, kSeq});
+  std::string ffnType = tensorType({kBatch, kSeq, kFfn});
+  std::string projType = tensorType({kHidden, kHidden});
+  std::string w1Type = tensorType({kHidden, kFfn});
+  std::string w2Type = tensorType({kFfn, kHidden});
+
+  ModuleTextBuilder builder;
+  std::string x = builder.addArg(actType, shardingAttr(R"({"data"}, {}, {})"));
+  for (int64_t layer = 0; layer < numLayers; ++layer) {
+    // Every other layer has a prioritized query projection sharding, so that
+    // user-priority propagation has more than one iteration.
+    std::string wq = builder.addArg(
+        projType,
+        layer % 2 ? shardingAttr(R"({}, {"model"}p1)") : std::string());
+    std::string wk = builder.addArg(projType);
+    std::string wv = builder.addArg(projType);
+    std::string w1 = builder.addArg(w1Type, shardingAttr(R"({}, {"model"})"));
+    std::string w2 = builder.addArg(w2Type, shardingAttr(R"({"model"}, {})"));
+
+    auto project = [&](StringRef input, StringRef weight, StringRef weightType,
+                       StringRef resultType) {
+      return builder.addOp(
+          "stablehlo.dot_general",
+          formatv("{0}, {1}, contracting_dims = [2] x [0]", input, weight)
+              .str(),
+          formatv("({0}, {1}) -> {2}", actType, weightType, resultType).str());
+    };
+    std::string q = project(x, wq, projType, actType);
+    std::string k = project(x, wk, projType, actType);
+    std::string v = project(x, wv, projType, actType);
+    std::string scores = builder.addOp(
+        "stablehlo.dot_general",
+        formatv("{0}, {1}, batching_dims = [0] x [0], "
+                "contracting_dims = [2] x [2]",
+                q, k)
+            .str(),
+        formatv("({0}, {0}) -> {1}", actType, scoresType).str());
+    std::string probs =
+        builder.addOp("stablehlo.exponential", scores, scoresType);
+    std::string attn = builder.addOp(
+        "stablehlo.dot_general",
+        formatv("{0}, {1}, batching_dims = [0] x [0], "
+                "contracting_dims = [2] x [1]",
+                probs, v)
+            .str(),
+        formatv("({0}, {1}) -> {1}", scoresType, actType).str());
+    std::string h =
+        builder.addOp("stablehlo.add", formatv("{0}, {1}", attn, x).str(),
+                      actType);
+    std::string up = project(h, w1, w1Type, ffnType);
+    std::string act = builder.addOp("stablehlo.tanh", up, ffnType);
+    std::string down = builder.addOp(
+        "stablehlo.dot_general",
+        formatv("{0}, {1}, contracting_dims = [2] x [0]", act, w2).str(),
+        formatv("({0}, {1}) -> {2}", ffnType, w2Type, actType).str());
+    x = builder.addOp("stablehlo.add", formatv("{0}, {1}", down, h).str(),
+                      actType);
+  }
+  return builder.build(x, actType);
+}
+
+std::string generateMixtureOfExperts(int64_t numLayers) {
+  constexpr int64_t kBatch = 8, kSeq = 64, kHidden = 128, kExperts = 8,
+                    kFfn = 256;
+  std::string actType = tensorType({kBatch, kSeq, kHidden});
+  std::string routerType = tensorType({kHidden, kExperts});
+  std::string logitsType = tensorType({kBatch, kSeq, kExperts});
+  std::string gateType = tensorType({kExperts, kBatch, kSeq});
+  std::string dispatchType = tensorType({kExperts, kBatch, kSeq, kHidden});
+  std::string expertFfnType = tensorType({kExperts, kBatch, kSeq, kFfn});
+  std::string we1Type = tensorType({kExperts, kHidden, kFfn});
+  std::string we2Type = tensorType({kExperts, kFfn, kHidden});
+
+  ModuleTextBuilder builder;
+  std::string x = builder.addArg(actType, shardingAttr(R"({"data"}, {}, {})"));
+  std::string zero = builder.newValue("zero");
+  builder.addLine(
+      formatv("{0} = stablehlo.constant dense<0.000000e+00> : tensor<f32>",
+              zero));
+  for (int64_t layer = 0; layer < numLayers; ++layer) {
+    std::string wr = builder.addArg(routerType);
+    std::string we1 =
+        builder.addArg(we1Type, shardingAttr(R"({"expert"}, {}, {"model"})"));
+    std::string we2 =
+        builder.addArg(we2Type, shardingAttr(R"({"expert"}, {"model"}, {})"));
+
+    std::string logits = builder.addOp(
+        "stablehlo.dot_general",
+        formatv("{0}, {1}, contracting_dims = [2] x [0]", x, wr).str(),
+        formatv("({0}, {1}) -> {2}", actType, routerType, logitsType).str());
+    std::string gate = builder.addOp(
+        "stablehlo.transpose", formatv("{0}, dims = [2, 0, 1]", logits).str(),
+        formatv("({0}) -> {1}", logitsType, gateType).str());
+    std::string dispatch = builder.addOp(
+        "stablehlo.broadcast_in_dim", formatv("{0}, dims = [1, 2, 3]", x).str(),
+        formatv("({0}) -> {1}", actType, dispatchType).str());
+    std::string up = builder.addOp(
+        "stablehlo.dot_general",
+        formatv("{0}, {1}, batching_dims = [0] x [0], "
+                "contracting_dims = [3] x [1]",
+                dispatch, we1)
+            .str(),
+        formatv("({0}, {1}) -> {2}", dispatchType, we1Type, expertFfnType)
+            .str());
+    std::string act = builder.addOp("stablehlo.tanh", up, expertFfnType);
+    std::string down = builder.addOp(
+        "stablehlo.dot_general",
+        formatv("{0}, {1}, batching_dims = [0] x [0], "
+                "contracting_dims = [3] x [1]",
+                act, we2)
+            .str(),
+        formatv("({0}, {1}) -> {2}", expertFfnType, we2Type, dispatchType)
+            .str());
+    std::string gateBroadcast = builder.addOp(
+        "stablehlo.broadcast_in_dim",
+        formatv("{0}, dims = [0, 1, 2]", gate).str(),
+        formatv("({0}) -> {1}", gateType, dispatchType).str());
+    std::string weighted = builder.addOp(
+        "stablehlo.multiply", formatv("{0}, {1}", down, gateBroadcast).str(),
+        dispatchType);
+    std::string combined = builder.addOp(
+        "stablehlo.reduce",
+        formatv("({0} init: {1}) applies stablehlo.add across dimensions = [0]",
+                weighted, zero)
+            .str(),
+        formatv("({0}, tensor<f32>) -> {1}", dispatchType, actType).str());
+    x = builder.addOp("stablehlo.add", formatv("{0}, {1}", combined, x).str(),
+                      actType);
+  }
+  return builder.build(x, actType);
+}
+
+std::string generateConvNet(int64_t numLayers) {
+  constexpr int64_t kBatch = 8, kSpatial = 32, kChannels = 64;
+  std::string actType = tensorType({kBatch, kSpatial, kSpatial, kChannels});
+  std::string kernelType = tensorType({3, 3, kChannels, kChannels});
+
+  ModuleTextBuilder builder;
+  std::string x =
+      builder.addArg(actType, shardingAttr(R"({"data"}, {}, {}, {})"));
+  for (int64_t layer = 0; layer < numLayers; ++layer) {
+    std::string kernel = builder.addArg(
+        kernelType,
+        layer % 2 ? shardingAttr(R"({}, {}, {}, {"model"})") : std::string());
+    std::string conv = builder.newValue();
+    builder.addLine(formatv("{0} = stablehlo.convolution({1}, {2})", conv, x,
+                            kernel));
+    builder.pushIndent();
+    builder.addLine("dim_numbers = [b, 0, 1, f]x[0, 1, i, o]->[b, 0, 1, f],");
+    builder.addLine("window = {stride = [1, 1], pad = [[1, 1], [1, 1]]} {");
+    builder.addLine("  batch_group_count = 1 : i64,");
+    builder.addLine("  feature_group_count = 1 : i64,");
+    builder.addLine("  lhs_dilations = dense<1> : tensor<2xi64>,");
+    builder.addLine("  rhs_dilations = dense<1> : tensor<2xi64>");
+    builder.addLine(
+        formatv("} : ({0}, {1}) -> {0}", actType, kernelType).str());
+    builder.popIndent();
+    std::string act = builder.addOp("stablehlo.tanh", conv, actType);
+    x = builder.addOp("stablehlo.add", formatv("{0}, {1}", act, x).str(),
+                      actType);
+  }
+  return builder.build(x, actType);
+}
+
+// Emits a `stablehlo.while` that carries `inputs` and `counterInit`, whose
+// body nests another loop if `depth > 1`. Returns the SSA names of the
+// carried results (excluding the counter).
+SmallVector<std::string> emitWhileLoop(ModuleTextBuilder& builder,
+                                       ArrayRef<std::string> inputs,
+                                       StringRef counterInit, StringRef one,
+                                       StringRef limit, StringRef carriedType,
+                                       int64_t depth) {
+  std::string loop = builder.newValue("while");
+  SmallVector<std::string> iterArgs, initList, types;
+  for (auto [index, input] : llvm::enumerate(inputs)) {
+    iterArgs.push_back(formatv("{0}_it{1}", loop, index));
+    initList.push_back(formatv("{0} = {1}", iterArgs.back(), input));
+    types.push_back(carriedType.str());
+  }
+  std::string counter = formatv("{0}_counter", loop);
+  initList.push_back(formatv("{0} = {1}", counter, counterInit));
+  types.push_back("tensor<i32>");
+
+  builder.addLine(formatv("{0}:{1} = stablehlo.while({2}) : {3}", loop,
+                          types.size(), llvm::join(initList, ", "),
+                          llvm::join(types, ", ")));
+  builder.pushIndent();
+  builder.addLine("cond {");
+  std::string cond = builder.addOp(
+      "stablehlo.compare ",
+      formatv("LT, {0}, {1}", counter, limit).str(),
+      "(tensor<i32>, tensor<i32>) -> tensor<i1>");
+  builder.addLine(formatv("stablehlo.return {0} : tensor<i1>", cond));
+  builder.addLine("} do {");
+
+  // Mix each carried value with its neighbor, so shardings need to flow
+  // across the carried values through the loop iterations.
+  SmallVector<std::string> next;
+  for (auto [index, iterArg] : llvm::enumerate(iterArgs)) {
+    next.push_back(builder.addOp(
+        "stablehlo.add",
+        formatv("{0}, {1}", iterArg, iterArgs[(index + 1) % iterArgs.size()])
+            .str(),
+        carriedType));
+  }
+  if (depth > 1) {
+    next = emitWhileLoop(builder, next, counterInit, one, limit, carriedType,
+                         depth - 1);
+  }
+  std::string nextCounter = builder.addOp(
+      "stablehlo.add", formatv("{0}, {1}", counter, one).str(), "tensor<i32>");
+  next.push_back(nextCounter);
+  builder.addLine(formatv("stablehlo.return {0} : {1}", llvm::join(next, ", "),
+                          llvm::join(types, ", ")));
+  builder.popIndent();
+  builder.addLine("}");
+
+  SmallVector<std::string> results;
+  for (int64_t index = 0; index < static_cast<int64_t>(inputs.size());
+       ++index) {
+    results.push_back(formatv("{0}#{1}", loop, index));
+  }
+  return results;
+}
+
+std::string generateWhileLoop(int64_t depth, int64_t numCarriedValues) {
+  std::string carriedType = tensorType({32, 64});
+
+  ModuleTextBuilder builder;
+  SmallVector<std::string> inputs;
+  for (int64_t index = 0; index < numCarriedValues; ++index) {
+    switch (index % 3) {
+      case 0:
+        inputs.push_back(
+            builder.addArg(carriedType, shardingAttr(R"({"data"}, {})")));
+        break;
+      case 1:
+        inputs.push_back(
+            builder.addArg(carriedType, shardingAttr(R"({}, {"model"})")));
+        break;
+      default:
+        inputs.push_back(builder.addArg(carriedType));
+    }
+  }
+  std::string zero = builder.newValue("c");
+  builder.addLine(
+      formatv("{0} = stablehlo.constant dense<0> : tensor<i32>", zero));
+  std::string one = builder.newValue("c");
+  builder.addLine(
+      formatv("{0} = stablehlo.constant dense<1> : tensor<i32>", one));
+  std::string limit = builder.newValue("c");
+  builder.addLine(
+      formatv("{0} = stablehlo.constant dense<32> : tensor<i32>", limit));
+
+  SmallVector<std::string> results =
+      emitWhileLoop(builder, inputs, zero, one, limit, carriedType,
+                    std::max<int64_t>(depth, 1));
+  // Sum all carried results into a single output.
+  std::string sum = results.front();
+  for (StringRef result : ArrayRef<std::string>(results).drop_front()) {
+    sum = builder.addOp("stablehlo.add", formatv("{0}, {1}", sum, result).str(),
+                        carriedType);
+  }
+  return builder.build(sum, carriedType);
+}
+
+}  // namespace
+
+StringRef getSyntheticModuleKindName(SyntheticModuleKind kind) {
+  switch (kind) {
+    case SyntheticModuleKind::kTransformer:
+      return "transformer";
+    case SyntheticModuleKind::kMixtureOfExperts:
+      return "moe";
+    case SyntheticModuleKind::kConvNet:
+      return "conv_net";
+    case SyntheticModuleKind::kWhileLoop:
+      return "while_loop";
+  }
+  llvm_unreachable("unknown SyntheticModuleKind");
+}
+
+std::string generateSyntheticModule(SyntheticModuleKind kind, int64_t scale,
+                                    int64_t numCarriedValues) {
+  switch (kind) {
+    case SyntheticModuleKind::kTransformer:
+      return generateTransformer(scale);
+    case SyntheticModuleKind::kMixtureOfExperts:
+      return generateMixtureOfExperts(scale);
+    case SyntheticModuleKind::kConvNet:
+      return generateConvNet(scale);
+    case SyntheticModuleKind::kWhileLoop:
+      return generateWhileLoop(scale, std::max<int64_t>(numCarriedValues, 1));
+  }
+  llvm_unreachable("unknown SyntheticModuleKind");
+}
+
+OwningOpRef<ModuleOp> parseSyntheticModule(MLIRContext* context,
+                                           SyntheticModuleKind kind,
+                                           int64_t scale,
+                                           int64_t numCarriedValues) {
+  return parseSourceString<ModuleOp>(
+      generateSyntheticModule(kind, scale, numCarriedValues), context);
+}
+
+}  // namespace sdy
+}  // namespace mlir
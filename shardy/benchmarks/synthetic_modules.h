@@ -0,0 +1,75 @@
+/* Copyright 2024 The Shardy Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef SHARDY_BENCHMARKS_SYNTHETIC_MODULES_H_
+#define SHARDY_BENCHMARKS_SYNTHETIC_MODULES_H_
+
+#include <cstdint>
+#include <string>
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/Support/LLVM.h"
+
+namespace mlir {
+namespace sdy {
+
+// The kinds of synthetic modules that can be generated.
+//
+// All modules have a single `main` function and a single mesh
+// `@mesh = <["data"=8, "model"=4, "expert"=2]>`. Some of the function inputs
+// are annotated with (possibly prioritized) shardings, while all other values
+// are left for propagation to decide.
+enum class SyntheticModuleKind {
+  // A stack of transformer layers, each with a self-attention block followed
+  // by an MLP block and residual connections. Scale is the number of layers.
+  kTransformer,
+  // A stack of mixture-of-experts layers, each with a router, a per-expert MLP
+  // (batched over the experts) and a weighted combine. Scale is the number of
+  // layers.
+  kMixtureOfExperts,
+  // A stack of residual 3x3 convolution layers. Scale is the number of layers.
+  kConvNet,
+  // Nested `stablehlo.while` loops that carry many values through their
+  // bodies. Scale is the nesting depth.
+  kWhileLoop,
+};
+
+// Returns a short human readable name of `kind`, e.g. "transformer".
+StringRef getSyntheticModuleKindName(SyntheticModuleKind kind);
+
+// Returns the textual representation of a synthetic module of the given `kind`
+// and `scale` (see `SyntheticModuleKind` for the meaning of `scale`).
+//
+// `numCarriedValues` is only used by `SyntheticModuleKind::kWhileLoop`, and is
+// the number of tensors carried through each loop (in addition to the
+// iteration counter).
+std::string generateSyntheticModule(SyntheticModuleKind kind, int64_t scale,
+                                    int64_t numCarriedValues = 16);
+
+// Parses a synthetic module of the given `kind` and `scale` (see
+// `generateSyntheticModule`) in `context`.
+//
+// The `context` is expected to have all required dialects loaded.
+OwningOpRef<ModuleOp> parseSyntheticModule(MLIRContext* context,
+                                           SyntheticModuleKind kind,
+                                           int64_t scale,
+                                           int64_t numCarriedValues = 16);
+
+}  // namespace sdy
+}  // namespace mlir
+
+#endif  // SHARDY_BENCHMARKS_SYNTHETIC_MODULES_H_
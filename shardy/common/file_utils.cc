@@ -16,6 +16,7 @@ limitations under the License.
 #include "shardy/common/file_utils.h"
 
 // NOLINTBEGIN: silence `is an unapproved C++11 header`.
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <system_error>
@@ -43,16 +44,26 @@ class SaveModuleOpPass
   MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(SaveModuleOpPass)
 
   // NOLINTNEXTLINE(clang-diagnostic-shadow-field)
-  explicit SaveModuleOpPass(StringRef dumpDirectory, StringRef fileName) {
+  explicit SaveModuleOpPass(StringRef dumpDirectory, StringRef fileName,
+                            const SaveModuleOpOptions& options) {
     this->dumpDirectory = dumpDirectory.str();
     this->fileName = fileName.str();
+    this->bytecode = options.bytecode;
+    this->compress = options.compress;
+    this->elideElementsAttrsLargerThan = options.elideElementsAttrsLargerThan;
+    this->async = options.async;
   }
 
   SaveModuleOpPass(const SaveModuleOpPass& other) : PassWrapper(other) {}
 
  private:
   void runOnOperation() final {
-    saveModuleOp(getOperation(), dumpDirectory, fileName);
+    SaveModuleOpOptions options;
+    options.bytecode = bytecode;
+    options.compress = compress;
+    options.elideElementsAttrsLargerThan = elideElementsAttrsLargerThan;
+    options.async = async;
+    saveModuleOp(getOperation(), dumpDirectory, fileName, options);
   }
 
   StringRef getArgument() const override { return "sdy-save-module"; }
@@ -69,13 +80,35 @@ class SaveModuleOpPass
   Option<std::string> fileName{
       *this, "file-name",
       llvm::cl::desc("the name of the file without the `.mlir` extension")};
+
+  Option<bool> bytecode{
+      *this, "dump-bytecode",
+      llvm::cl::desc("whether to save MLIR bytecode instead of text"),
+      llvm::cl::init(false)};
+
+  Option<bool> compress{
+      *this, "dump-compress",
+      llvm::cl::desc("whether to compress the file with zstd"),
+      llvm::cl::init(false)};
+
+  Option<int64_t> elideElementsAttrsLargerThan{
+      *this, "dump-elide-elements-attrs-larger-than",
+      llvm::cl::desc("elide elements attrs with more elements than this, a "
+                     "negative value disables elision"),
+      llvm::cl::init(-1)};
+
+  Option<bool> async{
+      *this, "dump-async",
+      llvm::cl::desc("whether to write the file on a background thread"),
+      llvm::cl::init(false)};
 };
 
 }  // namespace
 
-std::unique_ptr<Pass> createSaveModuleOpPass(StringRef dumpDirectory,
-                                             StringRef fileName) {
-  return std::make_unique<SaveModuleOpPass>(dumpDirectory, fileName);
+std::unique_ptr<Pass> createSaveModuleOpPass(
+    StringRef dumpDirectory, StringRef fileName,
+    const SaveModuleOpOptions& options) {
+  return std::make_unique<SaveModuleOpPass>(dumpDirectory, fileName, options);
 }
 
 }  // namespace sdy
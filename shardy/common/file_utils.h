@@ -19,8 +19,10 @@ limitations under the License.
 #include <memory>
 
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/JSON.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/Pass/Pass.h"
+#include "shardy/common/save_module_op.h"
 
 namespace mlir {
 namespace sdy {
@@ -35,14 +37,25 @@ namespace sdy {
 // - any error will be logged to standard error.
 // - do not include a file extension in `fileName`, `.mlir` will be appended
 //   internally.
+// - see `SaveModuleOpOptions` for saving bytecode, compressing it, or writing
+//   it on a background thread.
 void saveModuleOp(ModuleOp moduleOp, StringRef dumpDirectory,
-                  StringRef fileName);
+                  StringRef fileName, const SaveModuleOpOptions& options = {});
+
+// Saves `json` to the given `dumpDirectory` with name `fileName`.
+//
+// NOTE: same behavior as `saveModuleOp`, except `.json` is appended to
+// `fileName` internally. If `pretty` is false, the JSON is saved without any
+// whitespace, which is more compact for large files.
+void saveJson(const llvm::json::Value& json, StringRef dumpDirectory,
+              StringRef fileName, bool pretty = true);
 
 // Saves the `moduleOp` to the given `dumpDirectory` with name `fileName`.
 //
 // NOTE: see `saveModuleOp` for details of the behavior.
-std::unique_ptr<Pass> createSaveModuleOpPass(StringRef dumpDirectory,
-                                             StringRef fileName);
+std::unique_ptr<Pass> createSaveModuleOpPass(
+    StringRef dumpDirectory, StringRef fileName,
+    const SaveModuleOpOptions& options = {});
 
 }  // namespace sdy
 }  // namespace mlir
@@ -0,0 +1,141 @@
+/* Copyright 2024 The Shardy Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "shardy/common/lazy_module_loader.h"
+
+#include <memory>
+#include <optional>
+
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/SourceMgr.h"
+#include "mlir/Bytecode/BytecodeReader.h"
+#include "mlir/IR/Block.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Diagnostics.h"
+#include "mlir/IR/Location.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/IR/Region.h"
+#include "mlir/IR/SymbolInterfaces.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/IR/Verifier.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Support/LLVM.h"
+
+namespace mlir {
+namespace sdy {
+
+namespace {
+
+// Calls `callback` on every symbol referenced by `op` or ops nested in it.
+//
+// Returns false if the references in `op` can't be determined, e.g., because
+// it has an unknown op that defines a symbol table.
+bool forEachReferencedSymbol(Operation* op,
+                             function_ref<void(SymbolRefAttr)> callback) {
+  op->getAttrDictionary().walk(callback);
+  for (Region& region : op->getRegions()) {
+    std::optional<SymbolTable::UseRange> uses =
+        SymbolTable::getSymbolUses(&region);
+    if (!uses) {
+      return false;
+    }
+    for (const SymbolTable::SymbolUse& use : *uses) {
+      callback(use.getSymbolRef());
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+OwningOpRef<ModuleOp> loadModuleWithReachableBodies(
+    const std::shared_ptr<llvm::SourceMgr>& sourceMgr, MLIRContext* context) {
+  const llvm::MemoryBuffer* buffer =
+      sourceMgr->getMemoryBuffer(sourceMgr->getMainFileID());
+  if (!isBytecode(buffer->getMemBufferRef())) {
+    return parseSourceFile<ModuleOp>(*sourceMgr, ParserConfig(context));
+  }
+
+  // The module is verified once all reachable bodies are read, as function
+  // bodies that weren't read yet look like declarations.
+  ParserConfig config(context, /*verifyAfterParse=*/false);
+  BytecodeReader reader(buffer->getMemBufferRef(), config, /*lazyLoad=*/true,
+                        sourceMgr);
+  Block block;
+  // Only the body of the module itself is read, the bodies of the ops in it
+  // (e.g. functions) are read once they are reached.
+  if (failed(reader.readTopLevel(
+          &block, [](Operation* op) { return isa<ModuleOp>(op); }))) {
+    return nullptr;
+  }
+  if (!llvm::hasSingleElement(block) || !isa<ModuleOp>(block.front())) {
+    emitError(UnknownLoc::get(context))
+        << "expected a single top-level builtin.module";
+    return nullptr;
+  }
+  auto moduleOp = cast<ModuleOp>(block.front());
+
+  SymbolTable symbolTable(moduleOp);
+  llvm::DenseSet<Operation*> reachedOps;
+  SmallVector<Operation*> worklist;
+  auto reach = [&](Operation* op) {
+    if (op && reachedOps.insert(op).second) {
+      worklist.push_back(op);
+    }
+  };
+  for (Operation& op : moduleOp.getOps()) {
+    if (auto symbolOp = dyn_cast<SymbolOpInterface>(op);
+        !symbolOp || !symbolOp.isPrivate()) {
+      reach(&op);
+    }
+  }
+  while (!worklist.empty()) {
+    Operation* op = worklist.pop_back_val();
+    // Any op nested in a reached op is read right away.
+    if (reader.isMaterializable(op) &&
+        failed(reader.materialize(op, [](Operation*) { return true; }))) {
+      return nullptr;
+    }
+    if (!forEachReferencedSymbol(op, [&](SymbolRefAttr symbolRef) {
+          reach(symbolTable.lookup(symbolRef.getRootReference()));
+        })) {
+      // We can't tell which symbols are referenced, so we keep all of them.
+      llvm::for_each(moduleOp.getOps(), [&](Operation& other) {
+        reach(&other);
+      });
+    }
+  }
+
+  // The remaining ops that weren't read are private symbols that aren't
+  // referenced by any reachable op, so they are erased instead.
+  if (failed(reader.finalize(
+          [&](Operation* op) { return reachedOps.contains(op); }))) {
+    return nullptr;
+  }
+  if (failed(verify(moduleOp))) {
+    return nullptr;
+  }
+  moduleOp->remove();
+  return OwningOpRef<ModuleOp>(moduleOp);
+}
+
+}  // namespace sdy
+}  // namespace mlir
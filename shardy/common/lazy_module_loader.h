@@ -0,0 +1,47 @@
+/* Copyright 2024 The Shardy Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef SHARDY_COMMON_LAZY_MODULE_LOADER_H_
+#define SHARDY_COMMON_LAZY_MODULE_LOADER_H_
+
+#include <memory>
+
+#include "llvm/Support/SourceMgr.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
+
+namespace mlir {
+namespace sdy {
+
+// Loads the module in the main buffer of `sourceMgr`, which can be either MLIR
+// text or bytecode.
+//
+// For bytecode, the body of each top-level op is only read when it's reachable,
+// i.e., when the op is a root (an op that isn't a private symbol) or is
+// referenced by a reachable op. Private symbols that aren't reachable, e.g.,
+// functions that are never called, are dropped without reading their bodies,
+// as `SymbolDCEPass` would do after loading the entire module.
+//
+// Text can't be read lazily, so it's parsed entirely and nothing is dropped.
+//
+// Returns nullptr and emits an error if the module can't be loaded or verified.
+OwningOpRef<ModuleOp> loadModuleWithReachableBodies(
+    const std::shared_ptr<llvm::SourceMgr>& sourceMgr, MLIRContext* context);
+
+}  // namespace sdy
+}  // namespace mlir
+
+#endif  // SHARDY_COMMON_LAZY_MODULE_LOADER_H_
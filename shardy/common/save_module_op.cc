@@ -15,9 +15,34 @@ limitations under the License.
 
 #include "shardy/common/save_module_op.h"
 
-#include "llvm/Support/Path.h"
-#include "llvm/Support/FormatVariadic.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <utility>
+
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/Compression.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/raw_ostream.h"
+#include "mlir/Bytecode/BytecodeWriter.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/BuiltinDialect.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/DialectResourceBlobManager.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OperationSupport.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/Support/LLVM.h"
+#include "mlir/Support/LogicalResult.h"
+#include "shardy/common/file_utils.h"
 
 namespace mlir {
 namespace sdy {
@@ -27,16 +52,156 @@ static void fileSavingError(StringRef filePath, StringRef message) {
   llvm::errs() << llvm::formatv("error when writing file {0}: {1}\n", filePath,
                                 message);
 }
+
+// The name of the resource that elided elements attrs refer to, same as the
+// one used by the printer when eliding elements attrs.
+constexpr StringRef kElidedResourceName = "__elided__";
+
+// Returns the thread pool that writes files saved asynchronously. A single
+// thread keeps the files written in the order they were saved.
+//
+// The thread pool is destroyed at exit, after waiting for all pending writes.
+llvm::StdThreadPool& getSaveThreadPool() {
+  static llvm::StdThreadPool threadPool(llvm::hardware_concurrency(1));
+  return threadPool;
+}
+
+// Returns a handle to a resource without a blob, which is printed as
+// `dense_resource<__elided__>`.
+DenseResourceElementsHandle getElidedResourceHandle(MLIRContext* context) {
+  auto& manager = DenseResourceElementsHandle::getManagerInterface(context);
+  if (DialectResourceBlobManager::BlobEntry* entry =
+          manager.getBlobManager().lookup(kElidedResourceName)) {
+    return DenseResourceElementsHandle(
+        entry, context->getLoadedDialect<BuiltinDialect>());
+  }
+  return manager.insert(kElidedResourceName);
+}
+
+// Replaces all non-splat elements attrs in `moduleOp` that have more than
+// `limit` elements with an elided resource.
+void elideLargeElementsAttrs(ModuleOp moduleOp, int64_t limit) {
+  DenseResourceElementsHandle handle =
+      getElidedResourceHandle(moduleOp.getContext());
+  moduleOp.walk([&](Operation* op) {
+    // Copy the attributes, as they are modified in the loop.
+    SmallVector<NamedAttribute> attrs(op->getAttrs());
+    for (NamedAttribute attr : attrs) {
+      if (auto elementsAttr = dyn_cast<DenseElementsAttr>(attr.getValue());
+          elementsAttr && !elementsAttr.isSplat() &&
+          elementsAttr.getNumElements() > limit) {
+        op->setAttr(attr.getName(), DenseResourceElementsAttr::get(
+                                        elementsAttr.getType(), handle));
+      }
+    }
+  });
+}
+
+// Serializes `moduleOp` to `os` according to `options`.
+LogicalResult serializeModuleOp(ModuleOp moduleOp,
+                                const SaveModuleOpOptions& options,
+                                raw_ostream& os) {
+  bool elide = options.elideElementsAttrsLargerThan >= 0;
+  if (!options.bytecode) {
+    OpPrintingFlags flags;
+    if (elide) {
+      flags.elideLargeElementsAttrs(options.elideElementsAttrsLargerThan);
+    }
+    moduleOp.print(os, flags);
+    return success();
+  }
+  // The bytecode writer can't elide elements attrs, so we elide them on a
+  // snapshot of the module instead.
+  OwningOpRef<ModuleOp> snapshot;
+  if (elide) {
+    snapshot = moduleOp.clone();
+    elideLargeElementsAttrs(*snapshot, options.elideElementsAttrsLargerThan);
+    moduleOp = *snapshot;
+  }
+  return writeBytecodeToFile(moduleOp, os);
+}
+
+// Writes `contents` to `filePath`, compressing it with zstd if `compress` is
+// true.
+void writeFile(StringRef filePath, StringRef contents, bool compress) {
+  SmallVector<uint8_t> compressed;
+  if (compress) {
+    llvm::compression::zstd::compress(llvm::arrayRefFromStringRef(contents),
+                                      compressed);
+    contents = llvm::toStringRef(compressed);
+  }
+  std::error_code errorCode;
+  llvm::raw_fd_ostream fileStream(filePath, errorCode);
+  if (errorCode) {
+    fileSavingError(filePath, errorCode.message());
+    return;
+  }
+  fileStream << contents;
+  fileStream.close();
+}
+
 }  // namespace
 
 void saveModuleOp(ModuleOp moduleOp, StringRef dumpDirectory,
-                  StringRef fileName) {
+                  StringRef fileName, const SaveModuleOpOptions& options) {
   if (dumpDirectory.empty()) {
     return;
   }
+  bool compress = options.compress;
+  if (compress && !llvm::compression::zstd::isAvailable()) {
+    llvm::errs() << "warning: LLVM was built without zstd, saving "
+                 << fileName << " uncompressed\n";
+    compress = false;
+  }
+
   SmallString<128> filePath(dumpDirectory);
   llvm::sys::path::append(filePath, fileName);
-  filePath.append(".mlir");
+  filePath.append(options.bytecode ? ".mlirbc" : ".mlir");
+  if (compress) {
+    filePath.append(".zst");
+  }
+
+  if (!options.async && !compress) {
+    // Stream directly to the file, to avoid holding the entire serialized
+    // module in memory.
+    std::error_code errorCode;
+    llvm::raw_fd_ostream fileStream(filePath, errorCode);
+    if (errorCode) {
+      fileSavingError(filePath.str(), errorCode.message());
+      return;
+    }
+    if (failed(serializeModuleOp(moduleOp, options, fileStream))) {
+      fileSavingError(filePath.str(), "failed to serialize module");
+    }
+    fileStream.close();
+    return;
+  }
+
+  auto contents = std::make_shared<std::string>();
+  llvm::raw_string_ostream os(*contents);
+  if (failed(serializeModuleOp(moduleOp, options, os))) {
+    fileSavingError(filePath.str(), "failed to serialize module");
+    return;
+  }
+  if (!options.async) {
+    writeFile(filePath, *contents, compress);
+    return;
+  }
+  getSaveThreadPool().async(
+      [filePath = filePath.str().str(), contents = std::move(contents),
+       compress]() { writeFile(filePath, *contents, compress); });
+}
+
+void waitForPendingModuleSaves() { getSaveThreadPool().wait(); }
+
+void saveJson(const llvm::json::Value& json, StringRef dumpDirectory,
+              StringRef fileName, bool pretty) {
+  if (dumpDirectory.empty()) {
+    return;
+  }
+  SmallString<128> filePath(dumpDirectory);
+  llvm::sys::path::append(filePath, fileName);
+  filePath.append(".json");
 
   std::error_code errorCode;
   llvm::raw_fd_ostream fileStream(filePath, errorCode);
@@ -44,7 +209,11 @@ void saveModuleOp(ModuleOp moduleOp, StringRef dumpDirectory,
     fileSavingError(filePath.str(), errorCode.message());
     return;
   }
-  moduleOp.print(fileStream);
+  if (pretty) {
+    fileStream << llvm::formatv("{0:2}", json);
+  } else {
+    fileStream << json;
+  }
   fileStream.close();
 }
 
@@ -16,14 +16,29 @@ limitations under the License.
 #ifndef THIRD_PARTY_OPENXLA_SHARDY_SRC_SHARDY_COMMON_SAVE_MODULE_OP_H_
 #define THIRD_PARTY_OPENXLA_SHARDY_SRC_SHARDY_COMMON_SAVE_MODULE_OP_H_
 
-#include "llvm/ADT/StringRef.h"
-#include "mlir/IR/BuiltinOps.h"
+#include <cstdint>
 
 namespace mlir {
 namespace sdy {
 
-void saveModuleOp(ModuleOp moduleOp, StringRef dumpDirectory,
-                  StringRef fileName);
+// Options for how `saveModuleOp` saves a module.
+struct SaveModuleOpOptions {
+  // Whether to save MLIR bytecode (`.mlirbc`) instead of text (`.mlir`).
+  bool bytecode = false;
+  // Whether to compress the file with zstd (appending `.zst`). Ignored, with a
+  // warning, if LLVM was built without zstd.
+  bool compress = false;
+  // Elements attrs with more elements than this are elided, i.e., replaced
+  // with `dense_resource<__elided__>`. A negative value disables elision.
+  int64_t elideElementsAttrsLargerThan = -1;
+  // Whether to compress and write the file on a background thread. The module
+  // is still serialized to memory on the calling thread, so the caller can
+  // keep modifying it right away.
+  bool async = false;
+};
+
+// Blocks until all files saved with `SaveModuleOpOptions::async` are written.
+void waitForPendingModuleSaves();
 
 }  // namespace sdy
 }  // namespace mlir
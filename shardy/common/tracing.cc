@@ -0,0 +1,281 @@
+/* Copyright 2024 The Shardy Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "shardy/common/tracing.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include "llvm/ADT/STLFunctionalExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/raw_ostream.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/OperationSupport.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Pass/PassInstrumentation.h"
+#include "mlir/Support/LLVM.h"
+#include "mlir/Support/TypeID.h"
+
+namespace mlir {
+namespace sdy {
+
+namespace {
+
+std::mutex enableMutex;
+std::unique_ptr<TraceRecorder> recorderOwner;
+std::atomic<TraceRecorder*> recorderPtr = nullptr;
+
+// Records a span for each pass run, see `createTracingInstrumentation`.
+class TracingInstrumentation : public PassInstrumentation {
+ public:
+  void runBeforePass(Pass* pass, Operation*) override {
+    if (isTracingEnabled()) {
+      openPasses.push_back({pass, std::chrono::steady_clock::now()});
+    }
+  }
+
+  void runAfterPass(Pass* pass, Operation*) override { endSpan(pass); }
+
+  void runAfterPassFailed(Pass* pass, Operation*) override { endSpan(pass); }
+
+  void runAfterPipeline(std::optional<OperationName>,
+                        const PipelineParentInfo& parentInfo) override {
+    // Only the outermost pipeline has no parent pass.
+    if (!parentInfo.parentPass) {
+      if (TraceRecorder* recorder = TraceRecorder::getIfEnabled()) {
+        recorder->flush();
+      }
+    }
+  }
+
+ private:
+  struct OpenPass {
+    Pass* pass;
+    std::chrono::steady_clock::time_point start;
+  };
+
+  void endSpan(Pass* pass) {
+    // A pass that started before tracing was enabled (e.g. by the pass itself)
+    // isn't open.
+    if (openPasses.empty() || openPasses.back().pass != pass) {
+      return;
+    }
+    std::chrono::steady_clock::time_point start = openPasses.back().start;
+    openPasses.pop_back();
+    if (TraceRecorder* recorder = TraceRecorder::getIfEnabled()) {
+      StringRef name = pass->getArgument();
+      recorder->addSpan(name.empty() ? pass->getName() : name, "pass", start);
+    }
+  }
+
+  // The passes that are running on the current thread, from outermost to
+  // innermost. The before and after callbacks of a pass run on the same
+  // thread, and passes on a thread are nested.
+  static thread_local SmallVector<OpenPass> openPasses;
+};
+
+thread_local SmallVector<TracingInstrumentation::OpenPass>
+    TracingInstrumentation::openPasses;
+
+class EnableTracingPass
+    : public PassWrapper<EnableTracingPass, OperationPass<ModuleOp>> {
+ public:
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(EnableTracingPass)
+
+  // NOLINTNEXTLINE(clang-diagnostic-shadow-field)
+  explicit EnableTracingPass(StringRef filePath) {
+    this->filePath = filePath.str();
+  }
+
+  EnableTracingPass(const EnableTracingPass& other) : PassWrapper(other) {}
+
+ private:
+  void runOnOperation() final {
+    if (!filePath.empty()) {
+      enableTracing(filePath);
+    }
+    markAllAnalysesPreserved();
+  }
+
+  StringRef getArgument() const override { return "sdy-enable-tracing"; }
+
+  StringRef getDescription() const override {
+    return "Enables tracing to the specified file, so that the passes after "
+           "this one are traced.";
+  }
+
+  Option<std::string> filePath{*this, "trace-file",
+                               llvm::cl::desc("where to save the trace"),
+                               llvm::cl::init("")};
+};
+
+}  // namespace
+
+TraceRecorder::TraceRecorder(std::string filePath)
+    : filePath(std::move(filePath)),
+      startTime(std::chrono::steady_clock::now()) {}
+
+TraceRecorder::~TraceRecorder() { flush(); }
+
+TraceRecorder* TraceRecorder::getIfEnabled() {
+  static std::once_flag envVarFlag;
+  std::call_once(envVarFlag, [] {
+    if (const char* filePath = std::getenv(kTraceFileEnvVar.data());
+        filePath && *filePath) {
+      enableTracing(filePath);
+    }
+  });
+  return recorderPtr.load(std::memory_order_acquire);
+}
+
+std::chrono::microseconds TraceRecorder::sinceStart(
+    std::chrono::steady_clock::time_point time) const {
+  return std::chrono::duration_cast<std::chrono::microseconds>(time -
+                                                               startTime);
+}
+
+void TraceRecorder::addSpan(StringRef name, StringRef category,
+                            std::chrono::steady_clock::time_point start) {
+  std::chrono::microseconds timestamp = sinceStart(start);
+  std::chrono::microseconds end = sinceStart(std::chrono::steady_clock::now());
+  std::lock_guard<std::mutex> lock(mutex);
+  events.push_back(Event{name.str(), category.str(), 'X', llvm::get_threadid(),
+                         timestamp, (end - timestamp).count()});
+  dirty = true;
+}
+
+void TraceRecorder::addCounter(StringRef name, int64_t value) {
+  std::chrono::microseconds timestamp =
+      sinceStart(std::chrono::steady_clock::now());
+  std::lock_guard<std::mutex> lock(mutex);
+  events.push_back(Event{name.str(), "counter", 'C', llvm::get_threadid(),
+                         timestamp, value});
+  dirty = true;
+}
+
+void TraceRecorder::flush() {
+  llvm::json::Array traceEvents;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!dirty) {
+      return;
+    }
+    dirty = false;
+    for (const Event& event : events) {
+      llvm::json::Object traceEvent{
+          {"name", event.name},
+          {"cat", event.category},
+          {"ph", std::string(1, event.phase)},
+          {"ts", event.timestamp.count()},
+          {"pid", 0},
+          {"tid", static_cast<int64_t>(event.threadId)},
+      };
+      if (event.phase == 'X') {
+        traceEvent["dur"] = event.durationOrValue;
+      } else {
+        traceEvent["args"] =
+            llvm::json::Object{{event.name, event.durationOrValue}};
+      }
+      traceEvents.push_back(std::move(traceEvent));
+    }
+  }
+
+  std::error_code errorCode;
+  llvm::raw_fd_ostream fileStream(filePath, errorCode);
+  if (errorCode) {
+    llvm::errs() << llvm::formatv("error when writing file {0}: {1}\n",
+                                  filePath, errorCode.message());
+    return;
+  }
+  fileStream << llvm::json::Value(llvm::json::Object{
+      {"traceEvents", std::move(traceEvents)},
+      {"displayTimeUnit", "ms"},
+  });
+  fileStream.close();
+}
+
+void enableTracing(StringRef filePath) {
+  std::lock_guard<std::mutex> lock(enableMutex);
+  if (recorderOwner) {
+    // The recorder can't be replaced, as spans that are in progress refer to
+    // it.
+    if (recorderOwner->filePath != filePath) {
+      llvm::errs() << llvm::formatv(
+          "warning: tracing is already enabled to {0}, ignoring {1}\n",
+          recorderOwner->filePath, filePath);
+    }
+    return;
+  }
+  recorderOwner.reset(new TraceRecorder(filePath.str()));
+  recorderPtr.store(recorderOwner.get(), std::memory_order_release);
+}
+
+void addTraceCounter(StringRef name, int64_t value) {
+  if (TraceRecorder* recorder = TraceRecorder::getIfEnabled()) {
+    recorder->addCounter(name, value);
+  }
+}
+
+TraceScope::TraceScope(StringRef name, StringRef category)
+    : recorder(TraceRecorder::getIfEnabled()) {
+  if (!recorder) {
+    return;
+  }
+  this->name = name.str();
+  this->category = category.str();
+  start = std::chrono::steady_clock::now();
+}
+
+TraceScope::TraceScope(llvm::function_ref<std::string()> getName,
+                       StringRef category)
+    : recorder(TraceRecorder::getIfEnabled()) {
+  if (!recorder) {
+    return;
+  }
+  name = getName();
+  this->category = category.str();
+  start = std::chrono::steady_clock::now();
+}
+
+TraceScope::~TraceScope() {
+  if (recorder) {
+    recorder->addSpan(name, category, start);
+  }
+}
+
+std::unique_ptr<PassInstrumentation> createTracingInstrumentation() {
+  return std::make_unique<TracingInstrumentation>();
+}
+
+std::unique_ptr<Pass> createEnableTracingPass(StringRef filePath) {
+  return std::make_unique<EnableTracingPass>(filePath);
+}
+
+}  // namespace sdy
+}  // namespace mlir
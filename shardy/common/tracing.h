@@ -0,0 +1,142 @@
+/* Copyright 2024 The Shardy Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef SHARDY_COMMON_TRACING_H_
+#define SHARDY_COMMON_TRACING_H_
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/STLFunctionalExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Pass/PassInstrumentation.h"
+
+namespace mlir {
+namespace sdy {
+
+// The environment variable that enables tracing when set to a file path.
+inline constexpr llvm::StringLiteral kTraceFileEnvVar = "SDY_TRACE_FILE";
+
+// Records a timeline of spans and counters in the Chrome trace event format,
+// which can be opened in Perfetto (https://ui.perfetto.dev) or
+// chrome://tracing.
+//
+// There is a single process-wide recorder, which is enabled either by
+// `enableTracing` or by setting `SDY_TRACE_FILE` to the path of the trace file.
+// The trace file is written after each run of a pass manager with the tracing
+// instrumentation (see `createTracingInstrumentation`), and when the process
+// exits.
+//
+// Thread safe.
+class TraceRecorder {
+ public:
+  // Returns the process-wide recorder if tracing is enabled, or nullptr.
+  static TraceRecorder* getIfEnabled();
+
+  ~TraceRecorder();
+
+  // Records a span that started at `start` and ended now.
+  void addSpan(StringRef name, StringRef category,
+               std::chrono::steady_clock::time_point start);
+
+  // Records the value of counter `name` at the current time.
+  void addCounter(StringRef name, int64_t value);
+
+  // Writes all events recorded so far to the trace file, if any event was
+  // recorded since the last flush.
+  void flush();
+
+ private:
+  friend void enableTracing(StringRef filePath);
+
+  struct Event {
+    std::string name;
+    std::string category;
+    // 'X' for a complete span, 'C' for a counter.
+    char phase;
+    uint64_t threadId;
+    std::chrono::microseconds timestamp;
+    // The duration of a span, or the value of a counter.
+    int64_t durationOrValue;
+  };
+
+  explicit TraceRecorder(std::string filePath);
+
+  std::chrono::microseconds sinceStart(
+      std::chrono::steady_clock::time_point time) const;
+
+  const std::string filePath;
+  const std::chrono::steady_clock::time_point startTime;
+  std::mutex mutex;
+  std::vector<Event> events;
+  bool dirty = false;
+};
+
+// Enables tracing to `filePath`. Does nothing if tracing is already enabled to
+// `filePath`, and prints a warning if it's already enabled to a different file,
+// in which case the trace is still written to the first file.
+void enableTracing(StringRef filePath);
+
+// Returns true if tracing is enabled.
+inline bool isTracingEnabled() {
+  return TraceRecorder::getIfEnabled() != nullptr;
+}
+
+// Records the value of counter `name` if tracing is enabled.
+void addTraceCounter(StringRef name, int64_t value);
+
+// Records a span from the construction to the destruction of this object, if
+// tracing is enabled.
+class TraceScope {
+ public:
+  TraceScope(StringRef name, StringRef category);
+
+  // Same as above, but `getName` is only called if tracing is enabled, so that
+  // a formatted name isn't built otherwise.
+  TraceScope(llvm::function_ref<std::string()> getName, StringRef category);
+
+  ~TraceScope();
+
+  TraceScope(const TraceScope&) = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+
+ private:
+  TraceRecorder* recorder;
+  std::string name;
+  std::string category;
+  std::chrono::steady_clock::time_point start;
+};
+
+// Returns a pass instrumentation that records a span for each pass run, if
+// tracing is enabled when the pass starts, and writes the trace file after
+// each run of the pass manager.
+//
+// Nested passes are recorded on the thread that runs them, under the span of
+// the adaptor that runs them.
+std::unique_ptr<PassInstrumentation> createTracingInstrumentation();
+
+// Returns a pass that enables tracing to `filePath` when it runs, so that the
+// passes after it in the pipeline are traced.
+std::unique_ptr<Pass> createEnableTracingPass(StringRef filePath);
+
+}  // namespace sdy
+}  // namespace mlir
+
+#endif  // SHARDY_COMMON_TRACING_H_
@@ -0,0 +1,373 @@
+/* Copyright 2024 The Shardy Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "shardy/dialect/sdy/ir/bytecode.h"
+
+#include <cstdint>
+#include <optional>
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/TypeSwitch.h"
+#include "mlir/Bytecode/BytecodeImplementation.h"
+#include "mlir/IR/Attributes.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/Support/LLVM.h"
+#include "mlir/Support/LogicalResult.h"
+#include "shardy/dialect/sdy/ir/dialect.h"
+
+namespace mlir {
+namespace sdy {
+
+namespace {
+
+// The code written before the encoding of each attribute kind.
+//
+// These codes are part of the bytecode format, so existing codes must never be
+// changed or reused, and new codes must be appended.
+enum AttributeCode : uint64_t {
+  kMeshAxisAttr = 0,
+  kMeshAttr = 1,
+  kSubAxisInfoAttr = 2,
+  kAxisRefAttr = 3,
+  kDimensionShardingAttr = 4,
+  kTensorShardingAttr = 5,
+  kTensorShardingPerValueAttr = 6,
+  kDimMappingAttr = 7,
+  kTensorMappingAttr = 8,
+  kOpShardingRuleAttr = 9,
+  kManualAxesAttr = 10,
+  kAxisRefListAttr = 11,
+  kListOfAxisRefListsAttr = 12,
+};
+
+// Bits of the flags written before the axes of a `DimensionShardingAttr`.
+constexpr uint64_t kIsClosedFlag = 1 << 0;
+constexpr uint64_t kHasPriorityFlag = 1 << 1;
+
+// Reads a list of varints that were written by `writeVarInts`.
+LogicalResult readVarInts(DialectBytecodeReader& reader,
+                          SmallVectorImpl<int64_t>& result) {
+  return reader.readList(result, [&](int64_t& value) {
+    uint64_t unsignedValue;
+    if (failed(reader.readVarInt(unsignedValue))) {
+      return failure();
+    }
+    value = unsignedValue;
+    return success();
+  });
+}
+
+// Writes a list of non-negative integers as varints, which unlike signed
+// varints take a single byte for values up to 127.
+void writeVarInts(DialectBytecodeWriter& writer, ArrayRef<int64_t> values) {
+  writer.writeList(values, [&](int64_t value) { writer.writeVarInt(value); });
+}
+
+//===----------------------------------------------------------------------===//
+// Readers
+//===----------------------------------------------------------------------===//
+
+MeshAxisAttr readMeshAxisAttr(DialectBytecodeReader& reader) {
+  StringRef name;
+  uint64_t size;
+  if (failed(reader.readString(name)) || failed(reader.readVarInt(size))) {
+    return nullptr;
+  }
+  return MeshAxisAttr::get(reader.getContext(), name, size);
+}
+
+MeshAttr readMeshAttr(DialectBytecodeReader& reader) {
+  SmallVector<MeshAxisAttr> axes;
+  SmallVector<int64_t> deviceIds;
+  if (failed(reader.readAttributes(axes)) ||
+      failed(readVarInts(reader, deviceIds))) {
+    return nullptr;
+  }
+  return MeshAttr::get(reader.getContext(), axes, deviceIds);
+}
+
+SubAxisInfoAttr readSubAxisInfoAttr(DialectBytecodeReader& reader) {
+  uint64_t preSize, size;
+  if (failed(reader.readVarInt(preSize)) || failed(reader.readVarInt(size))) {
+    return nullptr;
+  }
+  return SubAxisInfoAttr::get(reader.getContext(), preSize, size);
+}
+
+AxisRefAttr readAxisRefAttr(DialectBytecodeReader& reader) {
+  StringRef name;
+  uint64_t preSize;
+  if (failed(reader.readString(name)) || failed(reader.readVarInt(preSize))) {
+    return nullptr;
+  }
+  // The pre-size of a sub-axis is at least 1, so 0 means a full axis.
+  if (preSize == 0) {
+    return AxisRefAttr::get(reader.getContext(), name);
+  }
+  uint64_t size;
+  if (failed(reader.readVarInt(size))) {
+    return nullptr;
+  }
+  return AxisRefAttr::get(reader.getContext(), name, preSize, size);
+}
+
+DimensionShardingAttr readDimensionShardingAttr(
+    DialectBytecodeReader& reader) {
+  uint64_t flags;
+  if (failed(reader.readVarInt(flags))) {
+    return nullptr;
+  }
+  std::optional<int64_t> priority;
+  if (flags & kHasPriorityFlag) {
+    uint64_t priorityValue;
+    if (failed(reader.readVarInt(priorityValue))) {
+      return nullptr;
+    }
+    priority = priorityValue;
+  }
+  SmallVector<AxisRefAttr> axes;
+  if (failed(reader.readAttributes(axes))) {
+    return nullptr;
+  }
+  return DimensionShardingAttr::get(reader.getContext(), axes,
+                                    flags & kIsClosedFlag, priority);
+}
+
+TensorShardingAttr readTensorShardingAttr(DialectBytecodeReader& reader) {
+  Attribute meshOrRef;
+  SmallVector<DimensionShardingAttr> dimShardings;
+  SmallVector<AxisRefAttr> replicatedAxes;
+  if (failed(reader.readAttribute(meshOrRef)) ||
+      failed(reader.readAttributes(dimShardings)) ||
+      failed(reader.readAttributes(replicatedAxes))) {
+    return nullptr;
+  }
+  return TensorShardingAttr::get(reader.getContext(), meshOrRef, dimShardings,
+                                 replicatedAxes);
+}
+
+TensorShardingPerValueAttr readTensorShardingPerValueAttr(
+    DialectBytecodeReader& reader) {
+  SmallVector<TensorShardingAttr> shardings;
+  if (failed(reader.readAttributes(shardings))) {
+    return nullptr;
+  }
+  return TensorShardingPerValueAttr::get(reader.getContext(), shardings);
+}
+
+DimMappingAttr readDimMappingAttr(DialectBytecodeReader& reader) {
+  SmallVector<int64_t> factorIndices;
+  if (failed(readVarInts(reader, factorIndices))) {
+    return nullptr;
+  }
+  return DimMappingAttr::get(reader.getContext(), factorIndices);
+}
+
+TensorMappingAttr readTensorMappingAttr(DialectBytecodeReader& reader) {
+  SmallVector<DimMappingAttr> dimMappings;
+  if (failed(reader.readAttributes(dimMappings))) {
+    return nullptr;
+  }
+  return TensorMappingAttr::get(reader.getContext(), dimMappings);
+}
+
+OpShardingRuleAttr readOpShardingRuleAttr(DialectBytecodeReader& reader) {
+  SmallVector<int64_t> factorSizes;
+  SmallVector<TensorMappingAttr> operandMappings, resultMappings;
+  uint64_t isCustomRule;
+  if (failed(readVarInts(reader, factorSizes)) ||
+      failed(reader.readAttributes(operandMappings)) ||
+      failed(reader.readAttributes(resultMappings)) ||
+      failed(reader.readVarInt(isCustomRule))) {
+    return nullptr;
+  }
+  return OpShardingRuleAttr::get(reader.getContext(), factorSizes,
+                                 operandMappings, resultMappings,
+                                 isCustomRule);
+}
+
+template <typename ArrayOfAttrT, typename ElementT>
+ArrayOfAttrT readArrayOfAttr(DialectBytecodeReader& reader) {
+  SmallVector<ElementT> elements;
+  if (failed(reader.readAttributes(elements))) {
+    return nullptr;
+  }
+  return ArrayOfAttrT::get(reader.getContext(), elements);
+}
+
+//===----------------------------------------------------------------------===//
+// Writers
+//===----------------------------------------------------------------------===//
+
+void write(MeshAxisAttr attr, DialectBytecodeWriter& writer) {
+  writer.writeVarInt(kMeshAxisAttr);
+  writer.writeOwnedString(attr.getName());
+  writer.writeVarInt(attr.getSize());
+}
+
+void write(MeshAttr attr, DialectBytecodeWriter& writer) {
+  writer.writeVarInt(kMeshAttr);
+  writer.writeAttributes(attr.getAxes());
+  writeVarInts(writer, attr.getDeviceIds());
+}
+
+void write(SubAxisInfoAttr attr, DialectBytecodeWriter& writer) {
+  writer.writeVarInt(kSubAxisInfoAttr);
+  writer.writeVarInt(attr.getPreSize());
+  writer.writeVarInt(attr.getSize());
+}
+
+void write(AxisRefAttr attr, DialectBytecodeWriter& writer) {
+  writer.writeVarInt(kAxisRefAttr);
+  // The name is written to the string section once, and referenced by index.
+  writer.writeOwnedString(attr.getName());
+  // The sub-axis info is packed into the axis ref, rather than written as a
+  // separate attribute.
+  if (SubAxisInfoAttr subAxisInfo = attr.getSubAxisInfo()) {
+    writer.writeVarInt(subAxisInfo.getPreSize());
+    writer.writeVarInt(subAxisInfo.getSize());
+  } else {
+    writer.writeVarInt(0);
+  }
+}
+
+void write(DimensionShardingAttr attr, DialectBytecodeWriter& writer) {
+  writer.writeVarInt(kDimensionShardingAttr);
+  std::optional<int64_t> priority = attr.getPriority();
+  uint64_t flags = 0;
+  if (attr.getIsClosed()) {
+    flags |= kIsClosedFlag;
+  }
+  if (priority) {
+    flags |= kHasPriorityFlag;
+  }
+  writer.writeVarInt(flags);
+  if (priority) {
+    writer.writeVarInt(*priority);
+  }
+  writer.writeAttributes(attr.getAxes());
+}
+
+void write(TensorShardingAttr attr, DialectBytecodeWriter& writer) {
+  writer.writeVarInt(kTensorShardingAttr);
+  writer.writeAttribute(attr.getMeshOrRef());
+  writer.writeAttributes(attr.getDimShardings());
+  writer.writeAttributes(attr.getReplicatedAxes());
+}
+
+void write(TensorShardingPerValueAttr attr, DialectBytecodeWriter& writer) {
+  writer.writeVarInt(kTensorShardingPerValueAttr);
+  writer.writeAttributes(attr.getShardings());
+}
+
+void write(DimMappingAttr attr, DialectBytecodeWriter& writer) {
+  writer.writeVarInt(kDimMappingAttr);
+  writeVarInts(writer, attr.getFactorIndices());
+}
+
+void write(TensorMappingAttr attr, DialectBytecodeWriter& writer) {
+  writer.writeVarInt(kTensorMappingAttr);
+  writer.writeAttributes(attr.getDimMappings());
+}
+
+void write(OpShardingRuleAttr attr, DialectBytecodeWriter& writer) {
+  writer.writeVarInt(kOpShardingRuleAttr);
+  writeVarInts(writer, attr.getFactorSizes());
+  writer.writeAttributes(attr.getOperandMappings());
+  writer.writeAttributes(attr.getResultMappings());
+  writer.writeVarInt(attr.getIsCustomRule());
+}
+
+void write(ManualAxesAttr attr, DialectBytecodeWriter& writer) {
+  writer.writeVarInt(kManualAxesAttr);
+  writer.writeAttributes(attr.getValue());
+}
+
+void write(AxisRefListAttr attr, DialectBytecodeWriter& writer) {
+  writer.writeVarInt(kAxisRefListAttr);
+  writer.writeAttributes(attr.getValue());
+}
+
+void write(ListOfAxisRefListsAttr attr, DialectBytecodeWriter& writer) {
+  writer.writeVarInt(kListOfAxisRefListsAttr);
+  writer.writeAttributes(attr.getValue());
+}
+
+struct SdyBytecodeInterface : public BytecodeDialectInterface {
+  using BytecodeDialectInterface::BytecodeDialectInterface;
+
+  Attribute readAttribute(DialectBytecodeReader& reader) const override {
+    uint64_t code;
+    if (failed(reader.readVarInt(code))) {
+      return nullptr;
+    }
+    switch (code) {
+      case kMeshAxisAttr:
+        return readMeshAxisAttr(reader);
+      case kMeshAttr:
+        return readMeshAttr(reader);
+      case kSubAxisInfoAttr:
+        return readSubAxisInfoAttr(reader);
+      case kAxisRefAttr:
+        return readAxisRefAttr(reader);
+      case kDimensionShardingAttr:
+        return readDimensionShardingAttr(reader);
+      case kTensorShardingAttr:
+        return readTensorShardingAttr(reader);
+      case kTensorShardingPerValueAttr:
+        return readTensorShardingPerValueAttr(reader);
+      case kDimMappingAttr:
+        return readDimMappingAttr(reader);
+      case kTensorMappingAttr:
+        return readTensorMappingAttr(reader);
+      case kOpShardingRuleAttr:
+        return readOpShardingRuleAttr(reader);
+      case kManualAxesAttr:
+        return readArrayOfAttr<ManualAxesAttr, StringAttr>(reader);
+      case kAxisRefListAttr:
+        return readArrayOfAttr<AxisRefListAttr, AxisRefAttr>(reader);
+      case kListOfAxisRefListsAttr:
+        return readArrayOfAttr<ListOfAxisRefListsAttr, AxisRefListAttr>(
+            reader);
+    }
+    reader.emitError() << "unknown sdy attribute code: " << code;
+    return nullptr;
+  }
+
+  LogicalResult writeAttribute(Attribute attr,
+                               DialectBytecodeWriter& writer) const override {
+    return TypeSwitch<Attribute, LogicalResult>(attr)
+        .Case<MeshAxisAttr, MeshAttr, SubAxisInfoAttr, AxisRefAttr,
+              DimensionShardingAttr, TensorShardingAttr,
+              TensorShardingPerValueAttr, DimMappingAttr, TensorMappingAttr,
+              OpShardingRuleAttr, ManualAxesAttr, AxisRefListAttr,
+              ListOfAxisRefListsAttr>([&](auto sdyAttr) {
+          write(sdyAttr, writer);
+          return success();
+        })
+        // Fall back to the textual assembly format.
+        .Default([](Attribute) { return failure(); });
+  }
+};
+
+}  // namespace
+
+void addBytecodeInterface(SdyDialect* dialect) {
+  dialect->addInterfaces<SdyBytecodeInterface>();
+}
+
+}  // namespace sdy
+}  // namespace mlir
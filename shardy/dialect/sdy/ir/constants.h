@@ -39,6 +39,12 @@ inline constexpr StringRef kOriginShardingAttr = "sdy.origin_sharding";
 // `sdy.sharding_constraint`, or `sdy.ManualComputationOp` input/output.
 inline constexpr StringRef kOriginShardingNameAttr = "sdy.origin_sharding_name";
 
+// Attribute name for marking an `sdy.propagation_barrier` that stands in for a
+// use of a constant sub-computation, whose splitting was deferred until after
+// propagation.
+inline constexpr StringRef kDeferredConstantSplitAttr =
+    "sdy.deferred_constant_split";
+
 // Default priority for a `DimensionShardingAttr` that doesn't have a
 // user-defined priority.
 inline constexpr int64_t kDefaultPriority = 0;
@@ -36,6 +36,21 @@ ShardableDataFlowOpInterface getOwningShardableDataFlowOp(Value value) {
   return dyn_cast<ShardableDataFlowOpInterface>(getOwningOp(value));
 }
 
+Value getDataFlowEdgeOwner(OpOperand& source) {
+  Operation* op = source.getOwner();
+  op = op->hasTrait<OpTrait::IsTerminator>() ? op->getParentOp() : op;
+  if (auto shardableDataFlowOp = dyn_cast<ShardableDataFlowOpInterface>(op)) {
+    return shardableDataFlowOp.getEdgeOwnerFromSource(source);
+  }
+  if (isDataFlowOp(op)) {
+    return op->getResult(source.getOperandNumber());
+  }
+
+  return nullptr;
+}
+
+}  // namespace
+
 Value getDataFlowEdgeOwner(Value target) {
   if (ShardableDataFlowOpInterface shardableDataFlowOp =
           getOwningShardableDataFlowOp(target)) {
@@ -53,21 +68,6 @@ Value getDataFlowEdgeOwner(Value target) {
   return nullptr;
 }
 
-Value getDataFlowEdgeOwner(OpOperand& source) {
-  Operation* op = source.getOwner();
-  op = op->hasTrait<OpTrait::IsTerminator>() ? op->getParentOp() : op;
-  if (auto shardableDataFlowOp = dyn_cast<ShardableDataFlowOpInterface>(op)) {
-    return shardableDataFlowOp.getEdgeOwnerFromSource(source);
-  }
-  if (isDataFlowOp(op)) {
-    return op->getResult(source.getOperandNumber());
-  }
-
-  return nullptr;
-}
-
-}  // namespace
-
 bool isDataFlowOp(Operation* op) {
   return isa<stablehlo::CaseOp, stablehlo::OptimizationBarrierOp,
              stablehlo::WhileOp, ShardableDataFlowOpInterface>(op);
@@ -114,24 +114,22 @@ DataFlowEdgeOp getDataFlowEdge(OpOperand& source) {
 }
 
 TensorShardingAttr transformTargetSharding(
-    DataFlowEdgeOp dataFlowEdge, TensorShardingAttr sharding,
+    Value edgeOwner, TensorShardingAttr sharding,
     DataFlowShardingTransformType transformType) {
-  Value input = dataFlowEdge.getInput();
   if (ShardableDataFlowOpInterface shardableDataFlowOp =
-          getOwningShardableDataFlowOp(input)) {
-    return shardableDataFlowOp.transformTargetSharding(input, sharding,
+          getOwningShardableDataFlowOp(edgeOwner)) {
+    return shardableDataFlowOp.transformTargetSharding(edgeOwner, sharding,
                                                        transformType);
   }
   return sharding;
 }
 
-SmallVector<Value> getDataFlowSources(DataFlowEdgeOp dataFlowEdge) {
-  Value input = dataFlowEdge.getInput();
+SmallVector<Value> getDataFlowSources(Value edgeOwner) {
   if (ShardableDataFlowOpInterface shardableDataFlowOp =
-          getOwningShardableDataFlowOp(input)) {
-    return shardableDataFlowOp.getEdgeSources(input);
+          getOwningShardableDataFlowOp(edgeOwner)) {
+    return shardableDataFlowOp.getEdgeSources(edgeOwner);
   }
-  auto opResult = dyn_cast<OpResult>(input);
+  auto opResult = dyn_cast<OpResult>(edgeOwner);
   assert(opResult && isDataFlowOp(opResult.getOwner()));
   int resNum = opResult.getResultNumber();
   return TypeSwitch<Operation*, SmallVector<Value>>(opResult.getOwner())
@@ -155,13 +153,12 @@ SmallVector<Value> getDataFlowSources(DataFlowEdgeOp dataFlowEdge) {
           });
 }
 
-SmallVector<Value> getNonEdgeOwnerTargets(DataFlowEdgeOp dataFlowEdge) {
-  Value input = dataFlowEdge.getInput();
-  if (auto shardableDataFlowOp = getOwningShardableDataFlowOp(input)) {
-    return shardableDataFlowOp.getNonEdgeOwnerTargets(input);
+SmallVector<Value> getNonEdgeOwnerTargets(Value edgeOwner) {
+  if (auto shardableDataFlowOp = getOwningShardableDataFlowOp(edgeOwner)) {
+    return shardableDataFlowOp.getNonEdgeOwnerTargets(edgeOwner);
   }
 
-  auto opResult = dyn_cast<OpResult>(input);
+  auto opResult = dyn_cast<OpResult>(edgeOwner);
   assert(opResult && isDataFlowOp(opResult.getOwner()));
   if (auto whileOp = dyn_cast<stablehlo::WhileOp>(opResult.getOwner())) {
     int resNum = opResult.getResultNumber();
@@ -47,6 +47,13 @@ ResultRange getDataFlowEdgeResultOwners(Operation* op);
 // edge owners, returns the owners, otherwise returns an empty range.
 ArrayRef<BlockArgument> getDataFlowEdgeBlockArgumentOwners(Operation* op);
 
+// If `target` is a target of a data-flow edge, returns the owner of the edge,
+// otherwise returns `nullptr`.
+//
+// The owner identifies the edge whether or not it has a `DataFlowEdgeOp`. If
+// it doesn't, the sharding of all targets is held by the owner itself.
+Value getDataFlowEdgeOwner(Value target);
+
 // If `target` is a target of a data-flow edge, returns the corresponding
 // `DataFlowEdgeOp`, otherwise returns `nullptr`.
 DataFlowEdgeOp getDataFlowEdge(Value target);
@@ -55,18 +62,19 @@ DataFlowEdgeOp getDataFlowEdge(Value target);
 // `DataFlowEdgeOp`, otherwise returns `nullptr`.
 DataFlowEdgeOp getDataFlowEdge(OpOperand& source);
 
-// Transforms the `sharding` depending on `transformType`.
+// Transforms the `sharding` of the data-flow edge of `edgeOwner` depending on
+// `transformType`.
 //
 // See `DataFlowShardingTransformType` for more information.
 TensorShardingAttr transformTargetSharding(
-    DataFlowEdgeOp dataFlowEdge, TensorShardingAttr sharding,
+    Value edgeOwner, TensorShardingAttr sharding,
     DataFlowShardingTransformType transformType);
 
-// Returns all sources of the given `dataFlowEdge`.
-SmallVector<Value> getDataFlowSources(DataFlowEdgeOp dataFlowEdge);
+// Returns all sources of the data-flow edge of `edgeOwner`.
+SmallVector<Value> getDataFlowSources(Value edgeOwner);
 
-// Returns all non-edge-owner targets of the given `dataFlowEdge`.
-SmallVector<Value> getNonEdgeOwnerTargets(DataFlowEdgeOp dataFlowEdge);
+// Returns all non-edge-owner targets of the data-flow edge of `edgeOwner`.
+SmallVector<Value> getNonEdgeOwnerTargets(Value edgeOwner);
 
 // Sets the block argument edge owner `shardings` if the `op` is a
 // `ShardableDataFlowOpInterface`.
@@ -15,26 +15,33 @@ limitations under the License.
 
 #include "shardy/dialect/sdy/ir/dialect.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <iterator>
+#include <memory>
 #include <numeric>
 #include <optional>
 #include <string>
+#include <tuple>
 #include <utility>
 
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/raw_ostream.h"
+#include "mlir/IR/AttributeSupport.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/BuiltinTypeInterfaces.h"
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/IR/OpDefinition.h"
+#include "mlir/IR/OpImplementation.h"
 #include "mlir/IR/OperationSupport.h"
 #include "mlir/IR/Region.h"
 #include "mlir/IR/SymbolTable.h"
@@ -45,17 +52,102 @@ limitations under the License.
 #include "mlir/Support/LLVM.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Transforms/InliningUtils.h"
+#include "shardy/dialect/sdy/ir/bytecode.h"
 #include "shardy/dialect/sdy/ir/constants.h"
 #include "shardy/dialect/sdy/ir/enums.cc.inc"
 #include "shardy/dialect/sdy/ir/parsers.h"   // IWYU pragma: keep
 #include "shardy/dialect/sdy/ir/printers.h"  // IWYU pragma: keep
 #include "shardy/dialect/sdy/ir/utils.h"
+#include "shardy/dialect/sdy/ir/verification_cache.h"
 #include "stablehlo/dialect/StablehloOps.h"
 #include "stablehlo/dialect/TypeInference.h"
 
 namespace mlir {
 namespace sdy {
 
+namespace detail {
+
+// The storage of `TensorShardingAttr`, which in addition to the parameters
+// holds data derived from them that is queried often, e.g. during propagation.
+//
+// The derived data is computed once in `construct`, and isn't part of the
+// key.
+struct TensorShardingAttrStorage : public AttributeStorage {
+  using KeyTy = std::tuple<Attribute, ArrayRef<DimensionShardingAttr>,
+                           ArrayRef<AxisRefAttr>>;
+
+  TensorShardingAttrStorage(Attribute meshOrRef,
+                            ArrayRef<DimensionShardingAttr> dimShardings,
+                            ArrayRef<AxisRefAttr> replicatedAxes,
+                            ArrayRef<AxisRefAttr> axisRefs,
+                            ArrayRef<StringRef> boundAxisNames,
+                            bool isFullyClosed, bool isFullyReplicated)
+      : mesh_or_ref(meshOrRef),
+        dim_shardings(dimShardings),
+        replicated_axes(replicatedAxes),
+        axisRefs(axisRefs),
+        boundAxisNames(boundAxisNames),
+        isFullyClosed(isFullyClosed),
+        isFullyReplicated(isFullyReplicated) {}
+
+  KeyTy getAsKey() const {
+    return KeyTy(mesh_or_ref, dim_shardings, replicated_axes);
+  }
+
+  bool operator==(const KeyTy& key) const { return key == getAsKey(); }
+
+  static llvm::hash_code hashKey(const KeyTy& key) {
+    return llvm::hash_combine(std::get<0>(key), std::get<1>(key),
+                              std::get<2>(key));
+  }
+
+  static TensorShardingAttrStorage* construct(
+      AttributeStorageAllocator& allocator, KeyTy&& key) {
+    auto [meshOrRef, dimShardings, replicatedAxes] = key;
+    SmallVector<AxisRefAttr> axisRefs;
+    bool isFullyClosed = true;
+    bool isFullyReplicated = true;
+    for (DimensionShardingAttr dimSharding : dimShardings) {
+      llvm::append_range(axisRefs, dimSharding.getAxes());
+      isFullyClosed &= dimSharding.getIsClosed();
+      isFullyReplicated &= dimSharding.emptyAxes();
+    }
+    llvm::append_range(axisRefs, replicatedAxes);
+
+    SmallVector<StringRef> boundAxisNames;
+    boundAxisNames.reserve(axisRefs.size());
+    for (AxisRefAttr axisRef : axisRefs) {
+      boundAxisNames.push_back(axisRef.getName());
+    }
+    llvm::sort(boundAxisNames);
+    boundAxisNames.erase(
+        std::unique(boundAxisNames.begin(), boundAxisNames.end()),
+        boundAxisNames.end());
+
+    return new (allocator.allocate<TensorShardingAttrStorage>())
+        TensorShardingAttrStorage(
+            meshOrRef, allocator.copyInto(dimShardings),
+            allocator.copyInto(replicatedAxes), allocator.copyInto(axisRefs),
+            allocator.copyInto(ArrayRef<StringRef>(boundAxisNames)),
+            isFullyClosed, isFullyReplicated);
+  }
+
+  // The parameters, named as in ODS.
+  Attribute mesh_or_ref;
+  ArrayRef<DimensionShardingAttr> dim_shardings;
+  ArrayRef<AxisRefAttr> replicated_axes;
+
+  // The axis refs of all dimension shardings, followed by the replicated axes.
+  ArrayRef<AxisRefAttr> axisRefs;
+  // The sorted and unique names of all axis refs. The names are owned by the
+  // `AxisRefAttr`s, which live as long as the context.
+  ArrayRef<StringRef> boundAxisNames;
+  bool isFullyClosed;
+  bool isFullyReplicated;
+};
+
+}  // namespace detail
+
 namespace {
 
 struct ShardyDialectInlinerInterface : public DialectInlinerInterface {
@@ -82,10 +174,56 @@ struct ShardyDialectInlinerInterface : public DialectInlinerInterface {
   }
 };
 
+struct ShardyDialectOpAsmInterface : public OpAsmDialectInterface {
+  using OpAsmDialectInterface::OpAsmDialectInterface;
+
+  // The same few shardings and sharding rules are usually attached to many
+  // ops, so an alias saves printing and parsing them in full at every use.
+  AliasResult getAlias(Attribute attr, raw_ostream& os) const final {
+    if (!static_cast<const SdyDialect*>(getDialect())
+             ->shouldPrintShardingAliases()) {
+      return AliasResult::NoAlias;
+    }
+    return TypeSwitch<Attribute, AliasResult>(attr)
+        .Case([&](TensorShardingAttr) {
+          os << "sharding";
+          return AliasResult::OverridableAlias;
+        })
+        .Case([&](TensorShardingPerValueAttr) {
+          os << "sharding_per_value";
+          return AliasResult::OverridableAlias;
+        })
+        .Case([&](OpShardingRuleAttr) {
+          os << "sharding_rule";
+          return AliasResult::OverridableAlias;
+        })
+        .Default([](Attribute) { return AliasResult::NoAlias; });
+  }
+};
+
 }  // namespace
 
+void setPrintShardingAliases(MLIRContext* context, bool enable) {
+  context->getOrLoadDialect<SdyDialect>()->setPrintShardingAliases(enable);
+}
+
+bool shouldPrintShardingAliases(MLIRContext* context) {
+  return context->getOrLoadDialect<SdyDialect>()->shouldPrintShardingAliases();
+}
+
+void setUseShardingFastPathParser(MLIRContext* context, bool enable) {
+  context->getOrLoadDialect<SdyDialect>()->setUseShardingFastPathParser(enable);
+}
+
+bool shouldUseShardingFastPathParser(MLIRContext* context) {
+  return context->getOrLoadDialect<SdyDialect>()
+      ->shouldUseShardingFastPathParser();
+}
+
 void SdyDialect::initialize() {
-  addInterface<ShardyDialectInlinerInterface>();
+  shardingVerificationCache = std::make_unique<ShardingVerificationCache>();
+  addInterfaces<ShardyDialectInlinerInterface, ShardyDialectOpAsmInterface>();
+  addBytecodeInterface(this);
   addAttributes<
 #define GET_ATTRDEF_LIST
 #include "shardy/dialect/sdy/ir/attrs.cc.inc"
@@ -571,36 +709,34 @@ MeshAttr TensorShardingAttr::getMesh(Operation* op) const {
   return getMeshOrLookup(op, getMeshOrRef());
 }
 
+bool TensorShardingAttr::isFullyClosed() const {
+  return getImpl()->isFullyClosed;
+}
+
+bool TensorShardingAttr::isFullyReplicated() const {
+  return getImpl()->isFullyReplicated;
+}
+
 bool TensorShardingAttr::emptyAxes() const {
-  return getReplicatedAxes().empty() &&
-         llvm::all_of(getDimShardings(),
-                      [](const DimensionShardingAttr& dimSharding) {
-                        return dimSharding.emptyAxes();
-                      });
+  return getImpl()->axisRefs.empty();
+}
+
+ArrayRef<AxisRefAttr> TensorShardingAttr::getAxisRefs() const {
+  return getImpl()->axisRefs;
 }
 
 bool TensorShardingAttr::anyOfAxisRef(
     std::function<bool(AxisRefAttr)> predicate) const {
-  for (DimensionShardingAttr dimSharding : getDimShardings()) {
-    if (llvm::any_of(dimSharding.getAxes(), predicate)) {
-      return true;
-    }
-  }
-  return llvm::any_of(getReplicatedAxes(), predicate);
+  return llvm::any_of(getAxisRefs(), predicate);
 }
 
 void TensorShardingAttr::forEachAxisRef(
     std::function<void(AxisRefAttr)> callback) const {
-  for (DimensionShardingAttr dimSharding : getDimShardings()) {
-    llvm::for_each(dimSharding.getAxes(), callback);
-  }
-  llvm::for_each(getReplicatedAxes(), callback);
+  llvm::for_each(getAxisRefs(), callback);
 }
 
 bool TensorShardingAttr::isBound(StringRef axisName) const {
-  return anyOfAxisRef([axisName](AxisRefAttr axisRef) {
-    return axisName == axisRef.getName();
-  });
+  return llvm::binary_search(getImpl()->boundAxisNames, axisName);
 }
 
 bool TensorShardingAttr::canShard(int64_t dim, StringRef axisName) const {
@@ -1107,6 +1243,41 @@ LogicalResult NamedComputationOp::inferReturnTypes(
 #include "shardy/dialect/sdy/ir/dialect.cc.inc"
 #define GET_ATTRDEF_CLASSES
 #include "shardy/dialect/sdy/ir/attrs.cc.inc"
+
+namespace mlir {
+namespace sdy {
+
+// Defined after the generated attribute classes, which define
+// `generatedAttributeParser` and `generatedAttributePrinter`.
+
+Attribute SdyDialect::parseAttribute(DialectAsmParser& parser,
+                                     Type type) const {
+  // The lexer is moved past the full spec once this returns, so the fast path
+  // doesn't need to consume the tokens of `parser`.
+  if (useShardingFastPathParser) {
+    if (Attribute attr =
+            parseShardingFastPath(parser.getFullSymbolSpec(), getContext())) {
+      return attr;
+    }
+  }
+  llvm::SMLoc typeLoc = parser.getCurrentLocation();
+  StringRef attrTag;
+  Attribute attr;
+  if (generatedAttributeParser(parser, &attrTag, type, attr).has_value()) {
+    return attr;
+  }
+  parser.emitError(typeLoc) << "unknown attribute `" << attrTag
+                            << "` in dialect `" << getNamespace() << "`";
+  return nullptr;
+}
+
+void SdyDialect::printAttribute(Attribute attr,
+                                DialectAsmPrinter& printer) const {
+  (void)generatedAttributePrinter(attr, printer);
+}
+
+}  // namespace sdy
+}  // namespace mlir
 #define GET_OP_INTERFACE_CLASSES
 #include "shardy/dialect/sdy/ir/op_interface.cc.inc"
 #define GET_OP_CLASSES
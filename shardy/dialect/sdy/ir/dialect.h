@@ -18,8 +18,10 @@ limitations under the License.
 
 // IWYU pragma: begin_keep
 
+#include <atomic>
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <string>
 
 #include "llvm/ADT/StringRef.h"
@@ -43,6 +45,15 @@ limitations under the License.
 
 // IWYU pragma: end_keep
 
+namespace mlir {
+namespace sdy {
+
+// Defined in verification_cache.h.
+class ShardingVerificationCache;
+
+}  // namespace sdy
+}  // namespace mlir
+
 // IWYU pragma: begin_exports
 
 // Dialect main class is defined in ODS, we include it here.
@@ -69,6 +80,27 @@ enum class DataFlowShardingTransformType {
   kAfterEdgePropagation
 };
 
+// Sets whether shardings, shardings per value, and sharding rules are printed
+// as aliases, e.g. `#sharding3`, that are defined once at the top of the
+// module, instead of inline at every use, when printing in `context`.
+// Disabled by default.
+void setPrintShardingAliases(MLIRContext* context, bool enable);
+
+// Returns whether shardings and sharding rules are printed as aliases in
+// `context`.
+bool shouldPrintShardingAliases(MLIRContext* context);
+
+// Sets whether `#sdy.sharding` and `#sdy.sharding_per_value` attributes are
+// first parsed with `parseShardingFastPath`, falling back to the generic
+// parser if the fast path doesn't support them, when parsing in `context`.
+// Enabled by default, disabling it is only useful for comparing against the
+// generic parser.
+void setUseShardingFastPathParser(MLIRContext* context, bool enable);
+
+// Returns whether shardings are first parsed with `parseShardingFastPath` in
+// `context`.
+bool shouldUseShardingFastPathParser(MLIRContext* context);
+
 namespace details {
 
 // Default implementation of the `getOpResultEdgeOwnerShardings` method of
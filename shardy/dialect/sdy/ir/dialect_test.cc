@@ -18,10 +18,16 @@ limitations under the License.
 #include <cstdint>
 #include <optional>
 
+#include "llvm/ADT/StringRef.h"
+#include "mlir/AsmParser/AsmParser.h"
+#include "mlir/IR/Attributes.h"
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/Diagnostics.h"
+#include "mlir/IR/Location.h"
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/Support/LLVM.h"
+#include "shardy/dialect/sdy/ir/parsers.h"
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
@@ -30,6 +36,7 @@ namespace sdy {
 
 namespace {
 
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
 
 class DialectTest : public ::testing::Test {
@@ -289,6 +296,38 @@ TEST_F(DialectTest, TensorShardingAttrCanShardOrReplicate) {
   EXPECT_TRUE(sharding.canReplicate("a"));
 }
 
+TEST_F(DialectTest, TensorShardingAttrDerivedData) {
+  TensorShardingAttr sharding = createTensorSharding(
+      {createDimSharding({createAxis("x"), createSubAxis("z", 2, 2)},
+                         /*isClosed=*/true),
+       createDimSharding({}, /*isClosed=*/false),
+       createDimSharding({createSubAxis("z", 1, 2)}, /*isClosed=*/true)},
+      /*replicatedAxes=*/{createAxis("u")});
+
+  EXPECT_THAT(sharding.getAxisRefs(),
+              ElementsAre(createAxis("x"), createSubAxis("z", 2, 2),
+                          createSubAxis("z", 1, 2), createAxis("u")));
+  EXPECT_FALSE(sharding.isFullyClosed());
+  EXPECT_FALSE(sharding.isFullyReplicated());
+  EXPECT_FALSE(sharding.emptyAxes());
+  EXPECT_TRUE(sharding.isBound("z"));
+  EXPECT_FALSE(sharding.isBound("y"));
+
+  TensorShardingAttr replicated = createTensorSharding(
+      {createDimSharding({}, /*isClosed=*/true)},
+      /*replicatedAxes=*/{createAxis("u")});
+  EXPECT_THAT(replicated.getAxisRefs(), ElementsAre(createAxis("u")));
+  EXPECT_TRUE(replicated.isFullyClosed());
+  EXPECT_TRUE(replicated.isFullyReplicated());
+  EXPECT_FALSE(replicated.emptyAxes());
+
+  TensorShardingAttr empty =
+      createTensorSharding({createDimSharding({}, /*isClosed=*/false)});
+  EXPECT_TRUE(empty.getAxisRefs().empty());
+  EXPECT_TRUE(empty.emptyAxes());
+  EXPECT_FALSE(empty.isBound("u"));
+}
+
 TEST_F(DialectTest, TensorShardingAttrGetSharded) {
   DimensionShardingAttr dimSharding0 =
       createDimSharding(createSubAxis("x", 2, 2));
@@ -395,6 +434,72 @@ TEST_F(DialectTest, DimensionShardingAttrGetShardedSize) {
   EXPECT_EQ(dimShardings[0].getShardedSize(mesh), 8);
   EXPECT_EQ(dimShardings[1].getShardedSize(mesh), 3);
 }
+
+TEST_F(DialectTest, VerificationCacheKeyedByDivisibilityAndMesh) {
+  auto meshA = MeshAttr::get(&context, {MeshAxisAttr::get(&context, "a", 2)});
+  auto meshB = MeshAttr::get(&context, {MeshAxisAttr::get(&context, "b", 2)});
+  TensorShardingAttr sharding =
+      createTensorSharding({createDimSharding({createAxis("a")})});
+  Type type = RankedTensorType::get({3}, Float32Type::get(&context));
+  int64_t numErrors = 0;
+  ScopedDiagnosticHandler diagnosticHandler(&context, [&](Diagnostic&) {
+    ++numErrors;
+    return success();
+  });
+  auto emitError = [&](StringRef msg) {
+    return mlir::emitError(UnknownLoc::get(&context), msg);
+  };
+
+  // The first successful verification is cached, but it shouldn't hide a
+  // failure with a different divisibility flag or mesh.
+  EXPECT_TRUE(succeeded(sharding.verifyForType(type, meshA, emitError,
+                                               /*checkDivisibility=*/false)));
+  EXPECT_TRUE(failed(sharding.verifyForType(type, meshA, emitError,
+                                            /*checkDivisibility=*/true)));
+  EXPECT_TRUE(failed(sharding.verifyForType(type, meshB, emitError,
+                                            /*checkDivisibility=*/false)));
+  EXPECT_TRUE(succeeded(sharding.verifyForType(type, meshA, emitError,
+                                               /*checkDivisibility=*/false)));
+  EXPECT_EQ(numErrors, 2);
+}
+
+TEST_F(DialectTest, ShardingFastPathMatchesGenericParser) {
+  for (StringRef shardingStr : {
+           R"(#sdy.sharding<@mesh, []>)",
+           R"(#sdy.sharding<@mesh, [{}, {?}]>)",
+           R"(#sdy.sharding<@mesh, [{"x", "y"}, {"z", ?}p0]>)",
+           R"(#sdy.sharding<@mesh, [{"x":(1)2}p12], replicated={"x":(2)2}>)",
+           R"(#sdy.sharding< @mesh_1 , [ { "x" , ? } ] >)",
+           R"(#sdy.sharding_per_value<[]>)",
+           R"(#sdy.sharding_per_value<[<@a, [{"x"}]>, <@b, [{}]>]>)",
+       }) {
+    setUseShardingFastPathParser(&context, false);
+    Attribute generic = parseAttribute(shardingStr, &context);
+    setUseShardingFastPathParser(&context, true);
+    Attribute fastPath = parseAttribute(shardingStr, &context);
+    ASSERT_NE(generic, Attribute()) << shardingStr;
+    EXPECT_EQ(fastPath, generic) << shardingStr;
+    StringRef spec = shardingStr.drop_front(StringRef("#sdy.").size());
+    EXPECT_EQ(parseShardingFastPath(spec, &context), generic) << shardingStr;
+  }
+}
+
+TEST_F(DialectTest, ShardingFastPathFallsBackToGenericParser) {
+  for (StringRef spec : {
+           R"(sharding<mesh<["x"=2]>, [{"x"}]>)",
+           R"(sharding<@"mesh", [{"x"}]>)",
+           R"(sharding<@mesh, [{"x\"y"}]>)",
+           R"(sharding<@mesh, [{"x"}p01]>)",
+           R"(sharding<@mesh, [{"x"} p 1]>)",
+           R"(sharding<@mesh, [{?, "x"}]>)",
+           R"(sharding<@mesh, [{"x"}], replicated={}>)",
+           R"(sharding<@mesh, [{"x"}]> trailing)",
+           R"(sharding_rule<([i])->([i]) {i=2}>)",
+       }) {
+    EXPECT_EQ(parseShardingFastPath(spec, &context), Attribute()) << spec;
+  }
+}
+
 }  // namespace
 
 }  // namespace sdy
@@ -334,6 +334,209 @@ ParseResult parseStrippedTensorShardingPerValueAttr(
   return success();
 }
 
+namespace {
+
+// A hand-written parser for the common grammar of `TensorShardingAttr` and
+// `TensorShardingPerValueAttr`, which scans the characters of the attribute
+// spec directly, instead of going through the tokens of `AsmParser`.
+//
+// Every method returns a null attribute (or false) when the input doesn't
+// match the grammar, without emitting an error, so the caller can fall back
+// to the generic parser.
+class ShardingFastPathParser {
+ public:
+  ShardingFastPathParser(StringRef spec, MLIRContext* context)
+      : rest(spec), context(context) {}
+
+  // Consumes `prefix`, after any whitespace, if `rest` starts with it.
+  bool consume(StringRef prefix) {
+    rest = rest.ltrim();
+    return rest.consume_front(prefix);
+  }
+
+  bool atEnd() { return rest.ltrim().empty(); }
+
+  // Parses `<[<@mesh, ...>, ..., <@mesh, ...>]>`.
+  TensorShardingPerValueAttr parseTensorShardingPerValue() {
+    SmallVector<TensorShardingAttr> shardings;
+    if (!consume("<") || !consume("[")) {
+      return nullptr;
+    }
+    if (!consume("]")) {
+      do {
+        TensorShardingAttr sharding = parseTensorSharding();
+        if (!sharding) {
+          return nullptr;
+        }
+        shardings.push_back(sharding);
+      } while (consume(","));
+      if (!consume("]")) {
+        return nullptr;
+      }
+    }
+    if (!consume(">")) {
+      return nullptr;
+    }
+    return TensorShardingPerValueAttr::get(context, shardings);
+  }
+
+  // Parses `<@mesh, [{"x", "y"}, {}], replicated={"z"}>`. Inlined meshes
+  // aren't supported.
+  TensorShardingAttr parseTensorSharding() {
+    if (!consume("<") || !consume("@")) {
+      return nullptr;
+    }
+    StringRef meshName = parseBareIdentifier();
+    if (meshName.empty() || !consume(",") || !consume("[")) {
+      return nullptr;
+    }
+    SmallVector<DimensionShardingAttr> dimShardings;
+    if (!consume("]")) {
+      do {
+        DimensionShardingAttr dimSharding = parseDimensionSharding();
+        if (!dimSharding) {
+          return nullptr;
+        }
+        dimShardings.push_back(dimSharding);
+      } while (consume(","));
+      if (!consume("]")) {
+        return nullptr;
+      }
+    }
+    SmallVector<AxisRefAttr> replicatedAxes;
+    if (consume(",")) {
+      if (!consume("replicated") || !consume("=") || !consume("{")) {
+        return nullptr;
+      }
+      do {
+        AxisRefAttr axisRef = parseAxisRef();
+        if (!axisRef) {
+          return nullptr;
+        }
+        replicatedAxes.push_back(axisRef);
+      } while (consume(","));
+      if (!consume("}")) {
+        return nullptr;
+      }
+    }
+    if (!consume(">")) {
+      return nullptr;
+    }
+    return TensorShardingAttr::get(context, meshName, dimShardings,
+                                   replicatedAxes);
+  }
+
+ private:
+  // Parses `{"x", "y":(2)4, ?}p1`.
+  DimensionShardingAttr parseDimensionSharding() {
+    if (!consume("{")) {
+      return nullptr;
+    }
+    SmallVector<AxisRefAttr> axes;
+    bool isClosed = true;
+    if (!consume("}")) {
+      do {
+        if (consume("?")) {
+          isClosed = false;
+          break;
+        }
+        AxisRefAttr axisRef = parseAxisRef();
+        if (!axisRef) {
+          return nullptr;
+        }
+        axes.push_back(axisRef);
+      } while (consume(","));
+      if (!consume("}")) {
+        return nullptr;
+      }
+    }
+    std::optional<int64_t> priority;
+    if (consume("p")) {
+      // The priority is a single `p<digits>` token, so unlike the sizes of a
+      // sub-axis, no whitespace is skipped before the digits. Leading zeros
+      // are rejected by the generic parser.
+      StringRef digits = parseDigits();
+      if (digits.empty() || (digits.size() > 1 && digits.front() == '0') ||
+          !llvm::to_integer(digits, priority.emplace())) {
+        return nullptr;
+      }
+    }
+    return DimensionShardingAttr::get(context, axes, isClosed, priority);
+  }
+
+  // Parses `"x"` or `"x":(2)4`.
+  AxisRefAttr parseAxisRef() {
+    if (!consume("\"")) {
+      return nullptr;
+    }
+    size_t end = rest.find_first_of("\"\\");
+    // Escaped characters are left to the generic parser.
+    if (end == StringRef::npos || rest[end] != '"') {
+      return nullptr;
+    }
+    StringRef name = rest.take_front(end);
+    rest = rest.drop_front(end + 1);
+    if (!consume(":")) {
+      return AxisRefAttr::get(context, name);
+    }
+    int64_t preSize, size;
+    if (!consume("(") || !llvm::to_integer(parseInteger(), preSize) ||
+        !consume(")") || !llvm::to_integer(parseInteger(), size)) {
+      return nullptr;
+    }
+    return AxisRefAttr::get(context, name, preSize, size);
+  }
+
+  // Parses an identifier that can be used as a symbol name without quotes.
+  StringRef parseBareIdentifier() {
+    if (rest.empty() || !(llvm::isAlpha(rest.front()) || rest.front() == '_')) {
+      return StringRef();
+    }
+    return consumeWhile([](char c) {
+      return llvm::isAlnum(c) || c == '_' || c == '$' || c == '.';
+    });
+  }
+
+  // Parses the digits at the start of `rest`, without skipping whitespace.
+  StringRef parseDigits() {
+    return consumeWhile([](char c) { return llvm::isDigit(c); });
+  }
+
+  // Parses the digits of an integer token, after any whitespace.
+  StringRef parseInteger() {
+    rest = rest.ltrim();
+    return parseDigits();
+  }
+
+  // Consumes and returns the longest prefix of `rest` whose characters all
+  // satisfy `pred`.
+  StringRef consumeWhile(function_ref<bool(char)> pred) {
+    StringRef prefix = rest.take_while(pred);
+    rest = rest.drop_front(prefix.size());
+    return prefix;
+  }
+
+  StringRef rest;
+  MLIRContext* context;
+};
+
+}  // namespace
+
+Attribute parseShardingFastPath(StringRef spec, MLIRContext* context) {
+  ShardingFastPathParser parser(spec, context);
+  Attribute attr;
+  // Check the longer mnemonic first, as "sharding" is a prefix of it.
+  if (parser.consume(TensorShardingPerValueAttr::getMnemonic())) {
+    attr = parser.parseTensorShardingPerValue();
+  } else if (parser.consume(TensorShardingAttr::getMnemonic())) {
+    attr = parser.parseTensorSharding();
+  }
+  if (!attr || !parser.atEnd()) {
+    return nullptr;
+  }
+  return attr;
+}
+
 ParseResult ConstantOp::parse(OpAsmParser& parser, OperationState& result) {
   return hlo::parseConstantOp(parser, result);
 }
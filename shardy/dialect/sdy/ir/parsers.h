@@ -18,7 +18,9 @@ limitations under the License.
 
 #include <cstdint>
 
+#include "llvm/ADT/StringRef.h"
 #include "mlir/IR/Attributes.h"
+#include "mlir/IR/MLIRContext.h"
 #include "mlir/IR/OpImplementation.h"
 #include "mlir/IR/Region.h"
 #include "mlir/Support/LLVM.h"
@@ -69,6 +71,17 @@ ParseResult parseSingleBlockRegionNoBlockId(OpAsmParser& parser,
 ParseResult parseStrippedTensorShardingPerValueAttr(
     AsmParser& parser, TensorShardingPerValueAttr& shardingPerValue);
 
+// Parses `spec`, the full spec of an SDY attribute such as
+// `sharding<@mesh, [{"x", "y"}, {}]>` or `sharding_per_value<[<@mesh, ...>]>`,
+// with a hand-written parser for the common grammar of shardings, which is
+// much faster than parsing it token by token with an `AsmParser`.
+//
+// Returns a null attribute, without emitting an error, if `spec` isn't a
+// sharding or a sharding per value, or uses syntax the fast path doesn't
+// support (e.g. an inlined mesh), in which case the generic parser should be
+// used instead.
+Attribute parseShardingFastPath(StringRef spec, MLIRContext* context);
+
 }  // namespace sdy
 }  // namespace mlir
 
@@ -0,0 +1,51 @@
+// RUN: sdy_opt %s -emit-bytecode | sdy_opt | FileCheck %s
+
+// CHECK: sdy.mesh @mesh = <["x"=4, "y"=2]>
+sdy.mesh @mesh = <["x"=4, "y"=2]>
+
+// CHECK: sdy.mesh @empty_mesh = <[]>
+sdy.mesh @empty_mesh = <[]>
+
+// CHECK: sdy.mesh @maximal_mesh = <[], device_ids=[3]>
+sdy.mesh @maximal_mesh = <[], device_ids=[3]>
+
+// CHECK: sdy.mesh @mesh_with_device_ids = <["a"=2, "b"=2], device_ids=[3, 2, 1, 0]>
+sdy.mesh @mesh_with_device_ids = <["a"=2, "b"=2], device_ids=[3, 2, 1, 0]>
+
+// CHECK-LABEL: func @tensor_sharding(
+// CHECK-SAME{LITERAL}: %arg0: tensor<8x8xf32> {sdy.sharding = #sdy.sharding<@mesh, [{"x"}, {"y", ?}p2]>},
+// CHECK-SAME{LITERAL}: %arg1: tensor<8x8xf32> {sdy.sharding = #sdy.sharding<@mesh, [{"x":(1)2}, {}], replicated={"x":(2)2, "y"}>})
+func.func @tensor_sharding(
+    %arg0: tensor<8x8xf32> {sdy.sharding = #sdy.sharding<@mesh, [{"x"}, {"y", ?}p2]>},
+    %arg1: tensor<8x8xf32> {sdy.sharding = #sdy.sharding<@mesh, [{"x":(1)2}, {}], replicated={"x":(2)2, "y"}>})
+    -> (tensor<8x8xf32> {sdy.sharding = #sdy.sharding<mesh<["a"=2, "b"=4]>, [{?}p0, {"b"}]>}) {
+  // CHECK: stablehlo.add %arg0, %arg1 {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{}, {"x", "y"}]>]>}
+  %0 = stablehlo.add %arg0, %arg1 {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{}, {"x", "y"}]>]>} : tensor<8x8xf32>
+  return %0 : tensor<8x8xf32>
+}
+// CHECK-SAME{LITERAL}: -> (tensor<8x8xf32> {sdy.sharding = #sdy.sharding<mesh<["a"=2, "b"=4]>, [{?}p0, {"b"}]>})
+
+// CHECK-LABEL: func @op_sharding_rule
+func.func @op_sharding_rule(%arg0: tensor<2x4xf32>, %arg1: tensor<16x32xf32>) -> (tensor<8xf32>, tensor<16x32xf32>) {
+  // CHECK: {sdy.sharding_rule = #sdy.op_sharding_rule<([i, j])->([ij]) {i=2, j=4}>}
+  %0 = stablehlo.reshape %arg0 {sdy.sharding_rule = #sdy.op_sharding_rule<([i, j])->([ij]) {i=2, j=4}>} : (tensor<2x4xf32>) -> tensor<8xf32>
+  // CHECK: {sdy.sharding_rule = #sdy.op_sharding_rule<([i, j])->([i, j]) {i=16, j=32}, custom>}
+  %1 = stablehlo.custom_call @foo(%arg1) {sdy.sharding_rule = #sdy.op_sharding_rule<([i, j])->([i, j]) {i=16, j=32}, custom>} : (tensor<16x32xf32>) -> tensor<16x32xf32>
+  return %0, %1 : tensor<8xf32>, tensor<16x32xf32>
+}
+
+// CHECK-LABEL: func @manual_axes
+func.func @manual_axes(%arg0: tensor<16x32xf32>) -> tensor<16x32xf32> {
+  // CHECK{LITERAL}: sdy.manual_computation(%arg0) in_shardings=[<@mesh, [{"x"}, {?}]>] out_shardings=[<@mesh, [{"x"}, {?}]>] manual_axes={"x"}
+  %0 = sdy.manual_computation(%arg0) in_shardings=[<@mesh, [{"x"}, {?}]>] out_shardings=[<@mesh, [{"x"}, {?}]>] manual_axes={"x"} (%arg1: tensor<4x32xf32>) {
+    sdy.return %arg1 : tensor<4x32xf32>
+  } : (tensor<16x32xf32>) -> tensor<16x32xf32>
+  return %0 : tensor<16x32xf32>
+}
+
+// CHECK-LABEL: func @axis_ref_lists
+func.func @axis_ref_lists(%arg0 : tensor<16x8xf32> {sdy.sharding = #sdy.sharding<@mesh, [{"y"}, {"x"}]>}) -> tensor<16x8xf32> {
+  // CHECK-NEXT: sdy.all_gather [{}, {"x"}] %arg0 out_sharding=<@mesh, [{"y"}, {}]>
+  %0 = sdy.all_gather [{}, {"x"}] %arg0 out_sharding=<@mesh, [{"y"}, {}]> : tensor<16x8xf32>
+  return %0 : tensor<16x8xf32>
+}
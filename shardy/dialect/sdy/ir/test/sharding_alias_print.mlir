@@ -0,0 +1,38 @@
+// RUN: sdy_opt %s --sdy-print-sharding-aliases | sdy_opt --sdy-print-sharding-aliases | FileCheck %s
+// RUN: sdy_opt %s | FileCheck %s --check-prefix=NO-ALIAS
+
+// CHECK-DAG: #[[SHARDING:.*]] = #sdy.sharding<@mesh, [{"x"}, {}]>
+// The shardings in a sharding per value are printed with their own alias.
+// CHECK-DAG: #[[SHARDING_PER_VALUE:.*]] = #sdy.sharding_per_value<[#[[SHARDING]]]>
+// CHECK-DAG: #[[SHARDING_RULE:.*]] = #sdy.op_sharding_rule<([i, j], [i, j])->([i, j]) {i=8, j=8}>
+
+// NO-ALIAS-NOT: #sharding
+
+sdy.mesh @mesh = <["x"=2]>
+
+// CHECK-LABEL: func @main(
+// CHECK-SAME:    %arg0: tensor<8x8xf32> {sdy.sharding = #[[SHARDING]]}
+// CHECK-SAME:    -> (tensor<8x8xf32> {sdy.sharding = #[[SHARDING]]})
+// NO-ALIAS-LABEL: func @main(
+// NO-ALIAS-SAME:    %arg0: tensor<8x8xf32> {sdy.sharding = #sdy.sharding<@mesh, [{"x"}, {}]>}
+func.func @main(%arg0: tensor<8x8xf32> {sdy.sharding = #sdy.sharding<@mesh, [{"x"}, {}]>})
+    -> (tensor<8x8xf32> {sdy.sharding = #sdy.sharding<@mesh, [{"x"}, {}]>}) {
+  // CHECK-NEXT: stablehlo.add %arg0, %arg0 {sdy.sharding = #[[SHARDING_PER_VALUE]], sdy.sharding_rule = #[[SHARDING_RULE]]}
+  // CHECK-NEXT: stablehlo.multiply %0, %0 {sdy.sharding = #[[SHARDING_PER_VALUE]], sdy.sharding_rule = #[[SHARDING_RULE]]}
+  %0 = stablehlo.add %arg0, %arg0 {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"x"}, {}]>]>, sdy.sharding_rule = #sdy.op_sharding_rule<([i, j], [i, j])->([i, j]) {i=8, j=8}>} : tensor<8x8xf32>
+  %1 = stablehlo.multiply %0, %0 {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"x"}, {}]>]>, sdy.sharding_rule = #sdy.op_sharding_rule<([i, j], [i, j])->([i, j]) {i=8, j=8}>} : tensor<8x8xf32>
+  return %1 : tensor<8x8xf32>
+}
+
+// The stripped shardings of a manual computation are also printed as aliases,
+// and are parsed back by the second `sdy_opt` of the first RUN line.
+// CHECK-LABEL: func @manual_computation(
+// NO-ALIAS-LABEL: func @manual_computation(
+func.func @manual_computation(%arg0: tensor<8x8xf32>) -> tensor<8x8xf32> {
+  // CHECK-NEXT: sdy.manual_computation(%arg0) in_shardings=[#[[SHARDING]]] out_shardings=[#[[SHARDING]]] manual_axes={"x"} (%arg1: tensor<4x8xf32>) {
+  // NO-ALIAS-NEXT: sdy.manual_computation(%arg0) in_shardings=[<@mesh, [{"x"}, {}]>] out_shardings=[<@mesh, [{"x"}, {}]>] manual_axes={"x"}
+  %0 = sdy.manual_computation(%arg0) in_shardings=[<@mesh, [{"x"}, {}]>] out_shardings=[<@mesh, [{"x"}, {}]>] manual_axes={"x"} (%arg1: tensor<4x8xf32>) {
+    sdy.return %arg1 : tensor<4x8xf32>
+  } : (tensor<8x8xf32>) -> tensor<8x8xf32>
+  return %0 : tensor<8x8xf32>
+}
@@ -239,8 +239,13 @@ Operation* getOwningOp(Value value) {
 }
 
 Value getShardableValue(Value value) {
-  if (DataFlowEdgeOp op = getDataFlowEdge(value)) {
-    return op.getResult();
+  if (Value edgeOwner = getDataFlowEdgeOwner(value)) {
+    if (DataFlowEdgeOp op = DataFlowEdgeOp::getDataFlowEdgeUser(edgeOwner)) {
+      return op.getResult();
+    }
+    // The data-flow edge of `value` doesn't have a `DataFlowEdgeOp`, so the
+    // sharding of all targets is held by the edge owner.
+    return edgeOwner;
   }
 
   if (isa<OpResult>(value)) {
@@ -389,15 +394,17 @@ void setShardings(Operation* op, TensorShardingPerValueAttr shardingPerValue) {
   op->setAttr(kShardingAttr, shardingPerValue);
 }
 
-void removeShardingRules(Operation* rootOp) {
-  rootOp->walk([](Operation* op) {
-    if (auto shardingRule =
-            op->getAttrOfType<OpShardingRuleAttr>(kShardingRuleAttr)) {
-      if (!shardingRule.isCustom()) {
-        op->removeAttr(kShardingRuleAttr);
-      }
+void removeShardingRule(Operation* op) {
+  if (auto shardingRule =
+          op->getAttrOfType<OpShardingRuleAttr>(kShardingRuleAttr)) {
+    if (!shardingRule.isCustom()) {
+      op->removeAttr(kShardingRuleAttr);
     }
-  });
+  }
+}
+
+void removeShardingRules(Operation* rootOp) {
+  rootOp->walk([](Operation* op) { removeShardingRule(op); });
 }
 
 SmallVector<TensorShardingAttr> getFullyOpenShardings(MLIRContext* context,
@@ -276,6 +276,9 @@ void setShardings(Operation* op, ArrayRef<TensorShardingAttr> shardings);
 // `TensorShardingPerValueAttr` named `sdy.sharding` consisting of `shardings`.
 void setShardings(Operation* op, TensorShardingPerValueAttr shardingPerValue);
 
+// Removes the sharding rule attr of `op`, unless it's user specified.
+void removeShardingRule(Operation* op);
+
 // Cleanup the module by removing sharding rule attrs. Keep any user specified
 // ones.
 void removeShardingRules(Operation* rootOp);
@@ -0,0 +1,81 @@
+/* Copyright 2024 The Shardy Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef SHARDY_DIALECT_SDY_IR_VERIFICATION_CACHE_H_
+#define SHARDY_DIALECT_SDY_IR_VERIFICATION_CACHE_H_
+
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <tuple>
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/StringRef.h"
+#include "mlir/IR/Attributes.h"
+#include "mlir/IR/Types.h"
+#include "mlir/Support/LLVM.h"
+#include "shardy/dialect/sdy/ir/dialect.h"
+
+namespace mlir {
+namespace sdy {
+
+// Data derived from uniqued attributes during verification, which is shared by
+// all threads verifying ops in the same `MLIRContext`.
+//
+// Attributes are never freed by the `MLIRContext`, so entries are never
+// invalidated. However, a long-lived context can see an unbounded number of
+// distinct meshes and shardings, so each container is cleared once it holds
+// `kMaxEntries` entries.
+class ShardingVerificationCache {
+ public:
+  static constexpr unsigned kMaxEntries = 1 << 16;
+
+  // Returns a map from axis name to axis size for `mesh`, which is computed
+  // once per mesh.
+  //
+  // The map is shared, so that it stays valid if the cache is cleared while
+  // it's in use.
+  std::shared_ptr<const llvm::SmallDenseMap<StringRef, int64_t>>
+  getAxisNameToSize(MeshAttr mesh);
+
+  // Returns true if `sharding` was successfully verified for `type` and `mesh`
+  // with the same `checkDivisibility`.
+  //
+  // Only the checks that depend on these alone are cached, i.e., not the
+  // checks that depend on the op the sharding is attached to.
+  bool isVerified(TensorShardingAttr sharding, Type type, MeshAttr mesh,
+                  bool checkDivisibility) const;
+
+  // Records that `sharding` was successfully verified for `type` and `mesh`
+  // with the given `checkDivisibility`.
+  void setVerified(TensorShardingAttr sharding, Type type, MeshAttr mesh,
+                   bool checkDivisibility);
+
+ private:
+  using VerifiedKey = std::tuple<Attribute, Type, Attribute>;
+
+  mutable std::shared_mutex mutex;
+  llvm::DenseMap<
+      MeshAttr, std::shared_ptr<const llvm::SmallDenseMap<StringRef, int64_t>>>
+      meshToAxisNameToSize;
+  // Indexed by `checkDivisibility`.
+  llvm::DenseSet<VerifiedKey> verified[2];
+};
+
+}  // namespace sdy
+}  // namespace mlir
+
+#endif  // SHARDY_DIALECT_SDY_IR_VERIFICATION_CACHE_H_
@@ -17,8 +17,11 @@ limitations under the License.
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <numeric>
 #include <optional>
+#include <shared_mutex>
 #include <utility>
 #include <vector>
 
@@ -38,6 +41,7 @@ limitations under the License.
 #include "mlir/IR/BuiltinTypeInterfaces.h"
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/IR/Diagnostics.h"
+#include "mlir/IR/MLIRContext.h"
 #include "mlir/IR/SymbolTable.h"
 #include "mlir/IR/TypeRange.h"
 #include "mlir/IR/Types.h"
@@ -46,6 +50,7 @@ limitations under the License.
 #include "shardy/dialect/sdy/ir/constants.h"
 #include "shardy/dialect/sdy/ir/dialect.h"
 #include "shardy/dialect/sdy/ir/utils.h"
+#include "shardy/dialect/sdy/ir/verification_cache.h"
 #include "stablehlo/dialect/StablehloOps.h"
 
 namespace mlir {
@@ -203,6 +208,11 @@ LogicalResult emitBoundAxisInManualComputationError(EmitErrorFn emitError,
          << "parent bounding this axis as manual";
 }
 
+ShardingVerificationCache& getVerificationCache(MLIRContext* context) {
+  return context->getLoadedDialect<SdyDialect>()
+      ->getShardingVerificationCache();
+}
+
 // Verifies the following for `shardingAttr`:
 //
 // If `type` isn't a `ShapedType`, the sharding must have rank 0 and no
@@ -216,21 +226,19 @@ LogicalResult emitBoundAxisInManualComputationError(EmitErrorFn emitError,
 // - All dimension shardings and the replicated axes are each a valid axis-ref
 //   list (see `verifyAxisRefList`).
 // - All sub-axes in `shardingAttr` (see `verifySubAxes`).
-// - If `alreadyManualAxes` is not empty, then it verifies that when
-//   shardingAttr is inside a ManualComputationOp (possibly
-//   nested), then it only operates on axes not already marked as manual.
 // - If a dimension sharding has a priority:
 //     -- The priority is greater than or equal to 0.
 //     -- The dimension has at least one axis if it is closed.
 // - If `checkDivisibility` is true, verifies that each dimension size
 //   is divisible by its sharded size.
-LogicalResult verifyTensorShardingAttr(TensorShardingAttr shardingAttr,
-                                       Type type, MeshAttr mesh,
-                                       EmitErrorFn emitError,
-                                       bool checkDivisibility,
-                                       ManualAxisToOwner alreadyManualAxes) {
-  if (mesh.isMaximal()) {
-    // TODO(bartchr): add some checks after XLA change lands.
+//
+// These checks only depend on the arguments, so a successful result is cached
+// in `cache`.
+LogicalResult verifyTensorShardingAttrForType(
+    TensorShardingAttr shardingAttr, Type type, MeshAttr mesh,
+    EmitErrorFn emitError, bool checkDivisibility,
+    ShardingVerificationCache& cache) {
+  if (cache.isVerified(shardingAttr, type, mesh, checkDivisibility)) {
     return success();
   }
   auto tensorType = dyn_cast<ShapedType>(type);
@@ -249,6 +257,7 @@ LogicalResult verifyTensorShardingAttr(TensorShardingAttr shardingAttr,
              << "and no replicated axes. type: " << type
              << ", sharding: " << shardingAttr;
     }
+    cache.setVerified(shardingAttr, type, mesh, checkDivisibility);
     return success();
   }
 
@@ -263,7 +272,9 @@ LogicalResult verifyTensorShardingAttr(TensorShardingAttr shardingAttr,
            << shardingAttr.getRank() << " != " << rank;
   }
 
-  SmallDenseMap<StringRef, int64_t> axisNameToSize = mesh.getAxisNameToSize();
+  std::shared_ptr<const SmallDenseMap<StringRef, int64_t>>
+      axisNameToSizePtr = cache.getAxisNameToSize(mesh);
+  const SmallDenseMap<StringRef, int64_t>& axisNameToSize = *axisNameToSizePtr;
 
   // Verify dimension shardings
   SmallDenseSet<AxisRefAttr> seenAxisRefs;
@@ -293,7 +304,7 @@ LogicalResult verifyTensorShardingAttr(TensorShardingAttr shardingAttr,
 
     if (dimSize == 0 &&
         llvm::any_of(dimSharding.getAxes(), [&](AxisRefAttr axisRef) {
-          return axisNameToSize[axisRef.getName()] > 1;
+          return axisNameToSize.lookup(axisRef.getName()) > 1;
         })) {
       return emitError("dim ")
           << dim << " of size 0 is sharded on an axis of size > 1";
@@ -321,7 +332,7 @@ LogicalResult verifyTensorShardingAttr(TensorShardingAttr shardingAttr,
 
   // Verify all sub-axes are valid.
   for (auto& [axisName, subAxes] : axisNameToSubAxes) {
-    int64_t axisSize = axisNameToSize[axisName];
+    int64_t axisSize = axisNameToSize.lookup(axisName);
     // We need to sort the sub-axes since this is assumed by `verifySubAxes`.
     llvm::sort(subAxes, axisRefComparator);
     if (failed(verifySubAxes(subAxes, axisName, axisSize, mesh, seenAxisRefs,
@@ -330,6 +341,31 @@ LogicalResult verifyTensorShardingAttr(TensorShardingAttr shardingAttr,
     }
   }
 
+  cache.setVerified(shardingAttr, type, mesh, checkDivisibility);
+  return success();
+}
+
+// Verifies `shardingAttr` is valid for `type` (see
+// `verifyTensorShardingAttrForType`).
+//
+// In addition, if `alreadyManualAxes` is not empty, verifies that when
+// `shardingAttr` is inside a ManualComputationOp (possibly nested), then it
+// only operates on axes not already marked as manual.
+LogicalResult verifyTensorShardingAttr(TensorShardingAttr shardingAttr,
+                                       Type type, MeshAttr mesh,
+                                       EmitErrorFn emitError,
+                                       bool checkDivisibility,
+                                       ManualAxisToOwner alreadyManualAxes) {
+  if (mesh.isMaximal()) {
+    // TODO(bartchr): add some checks after XLA change lands.
+    return success();
+  }
+  if (failed(verifyTensorShardingAttrForType(
+          shardingAttr, type, mesh, emitError, checkDivisibility,
+          getVerificationCache(mesh.getContext())))) {
+    return failure();
+  }
+
   // Verify all sharding and replicated axes don't already exist as a manual
   // axis due to a parent ManualComputationOp.
   if (!alreadyManualAxes.empty()) {
@@ -999,7 +1035,10 @@ LogicalResult AllGatherOp::verify() {
   SmallDenseSet<AxisRefAttr> seenAxisRefs;
   SmallDenseMap<StringRef, SmallVector<AxisRefAttr>> axisNameToSubAxes;
   ArrayRef<AxisRefListAttr> gatheringAxes = getGatheringAxes();
-  SmallDenseMap<StringRef, int64_t> axisNameToSize = mesh.getAxisNameToSize();
+  std::shared_ptr<const SmallDenseMap<StringRef, int64_t>>
+      axisNameToSizePtr =
+          getVerificationCache(getContext()).getAxisNameToSize(mesh);
+  const SmallDenseMap<StringRef, int64_t>& axisNameToSize = *axisNameToSizePtr;
 
   for (AxisRefListAttr axisRefList : gatheringAxes) {
     if (failed(verifyAxisRefList(axisRefList.getValue(), axisNameToSize,
@@ -1118,5 +1157,44 @@ LogicalResult SdyDialect::verifyOperationAttribute(Operation* op,
   return success();
 }
 
+std::shared_ptr<const SmallDenseMap<StringRef, int64_t>>
+ShardingVerificationCache::getAxisNameToSize(MeshAttr mesh) {
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    if (auto it = meshToAxisNameToSize.find(mesh);
+        it != meshToAxisNameToSize.end()) {
+      return it->second;
+    }
+  }
+  auto axisNameToSize = std::make_shared<SmallDenseMap<StringRef, int64_t>>(
+      mesh.getAxisNameToSize());
+  std::unique_lock<std::shared_mutex> lock(mutex);
+  if (meshToAxisNameToSize.size() >= kMaxEntries) {
+    meshToAxisNameToSize.clear();
+  }
+  // Another thread might have added the same mesh in the meantime, in which
+  // case we keep the existing map.
+  return meshToAxisNameToSize.try_emplace(mesh, std::move(axisNameToSize))
+      .first->second;
+}
+
+bool ShardingVerificationCache::isVerified(TensorShardingAttr sharding,
+                                           Type type, MeshAttr mesh,
+                                           bool checkDivisibility) const {
+  std::shared_lock<std::shared_mutex> lock(mutex);
+  return verified[checkDivisibility].contains({sharding, type, mesh});
+}
+
+void ShardingVerificationCache::setVerified(TensorShardingAttr sharding,
+                                            Type type, MeshAttr mesh,
+                                            bool checkDivisibility) {
+  std::unique_lock<std::shared_mutex> lock(mutex);
+  llvm::DenseSet<VerifiedKey>& verifiedSet = verified[checkDivisibility];
+  if (verifiedSet.size() >= kMaxEntries) {
+    verifiedSet.clear();
+  }
+  verifiedSet.insert({sharding, type, mesh});
+}
+
 }  // namespace sdy
 }  // namespace mlir
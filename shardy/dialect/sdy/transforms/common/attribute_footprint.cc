@@ -0,0 +1,267 @@
+/* Copyright 2024 The Shardy Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "shardy/dialect/sdy/transforms/common/attribute_footprint.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/TypeSwitch.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/raw_ostream.h"
+#include "mlir/IR/AttributeSupport.h"
+#include "mlir/IR/Attributes.h"
+#include "mlir/IR/AttrTypeSubElements.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/OperationSupport.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Pass/PassInstrumentation.h"
+#include "mlir/Support/LLVM.h"
+#include "shardy/common/tracing.h"
+#include "shardy/dialect/sdy/ir/dialect.h"
+
+namespace mlir {
+namespace sdy {
+
+namespace {
+
+template <typename T>
+int64_t getArrayBytes(ArrayRef<T> array) {
+  return array.size() * sizeof(T);
+}
+
+// Returns the kind of `attr` and the approximate number of bytes it takes, or
+// std::nullopt if it isn't one of the measured SDY attributes.
+//
+// The size of an attribute is the base storage, a word for each parameter, and
+// the arrays and strings it owns.
+std::optional<std::pair<SdyAttrKind, int64_t>> getKindAndBytes(
+    Attribute attr) {
+  using Result = std::optional<std::pair<SdyAttrKind, int64_t>>;
+  constexpr int64_t kBaseBytes = sizeof(AttributeStorage);
+  constexpr int64_t kWordBytes = sizeof(void*);
+  return TypeSwitch<Attribute, Result>(attr)
+      .Case([&](AxisRefAttr axisRef) -> Result {
+        return std::make_pair(
+            SdyAttrKind::kAxisRef,
+            kBaseBytes + 3 * kWordBytes + axisRef.getName().size());
+      })
+      .Case([&](SubAxisInfoAttr) -> Result {
+        return std::make_pair(SdyAttrKind::kSubAxisInfo,
+                              kBaseBytes + 2 * kWordBytes);
+      })
+      .Case([&](DimensionShardingAttr dimSharding) -> Result {
+        return std::make_pair(
+            SdyAttrKind::kDimensionSharding,
+            kBaseBytes + 5 * kWordBytes + getArrayBytes(dimSharding.getAxes()));
+      })
+      .Case([&](TensorShardingAttr sharding) -> Result {
+        // The storage also holds the derived axis refs and their distinct
+        // names, which are at most as many as the axis refs.
+        ArrayRef<AxisRefAttr> axisRefs = sharding.getAxisRefs();
+        return std::make_pair(
+            SdyAttrKind::kTensorSharding,
+            kBaseBytes + 10 * kWordBytes +
+                getArrayBytes(sharding.getDimShardings()) +
+                getArrayBytes(sharding.getReplicatedAxes()) +
+                getArrayBytes(axisRefs) + axisRefs.size() * sizeof(StringRef));
+      })
+      .Case([&](TensorShardingPerValueAttr shardingPerValue) -> Result {
+        return std::make_pair(
+            SdyAttrKind::kTensorShardingPerValue,
+            kBaseBytes + 2 * kWordBytes +
+                getArrayBytes(shardingPerValue.getShardings()));
+      })
+      .Case([&](OpShardingRuleAttr rule) -> Result {
+        return std::make_pair(SdyAttrKind::kOpShardingRule,
+                              kBaseBytes + 7 * kWordBytes +
+                                  getArrayBytes(rule.getFactorSizes()) +
+                                  getArrayBytes(rule.getOperandMappings()) +
+                                  getArrayBytes(rule.getResultMappings()));
+      })
+      .Case([&](TensorMappingAttr tensorMapping) -> Result {
+        return std::make_pair(
+            SdyAttrKind::kTensorMapping,
+            kBaseBytes + 2 * kWordBytes +
+                getArrayBytes(tensorMapping.getDimMappings()));
+      })
+      .Case([&](DimMappingAttr dimMapping) -> Result {
+        return std::make_pair(
+            SdyAttrKind::kDimMapping,
+            kBaseBytes + 2 * kWordBytes +
+                getArrayBytes(dimMapping.getFactorIndices()));
+      })
+      .Default([](Attribute) -> Result { return std::nullopt; });
+}
+
+std::string formatChange(int64_t change) {
+  return llvm::formatv("{0}{1}", change >= 0 ? "+" : "", change);
+}
+
+class AttributeFootprintInstrumentation : public PassInstrumentation {
+ public:
+  explicit AttributeFootprintInstrumentation(raw_ostream& os) : os(os) {}
+
+  void runBeforePass(Pass* pass, Operation* op) override {
+    if (!isa<ModuleOp>(op)) {
+      return;
+    }
+    SdyAttributeFootprint footprint = SdyAttributeFootprint::collect(op);
+    if (!printedInitial) {
+      os << llvm::formatv(
+          "// -----// SDY attribute footprint before {0} //----- //\n",
+          pass->getName());
+      footprint.print(os);
+      printedInitial = true;
+    }
+    // Module passes can run nested pipelines on the same module, hence the
+    // stack.
+    footprintsBefore.push_back(footprint);
+  }
+
+  void runAfterPass(Pass* pass, Operation* op) override {
+    if (!isa<ModuleOp>(op)) {
+      return;
+    }
+    SdyAttributeFootprint before = footprintsBefore.pop_back_val();
+    SdyAttributeFootprint after = SdyAttributeFootprint::collect(op);
+    os << llvm::formatv(
+        "// -----// SDY attribute footprint after {0} //----- //\n",
+        pass->getName());
+    after.print(os, &before);
+    after.addTraceCounters();
+  }
+
+  void runAfterPassFailed(Pass*, Operation* op) override {
+    if (isa<ModuleOp>(op)) {
+      footprintsBefore.pop_back();
+    }
+  }
+
+ private:
+  raw_ostream& os;
+  bool printedInitial = false;
+  SmallVector<SdyAttributeFootprint> footprintsBefore;
+};
+
+}  // namespace
+
+StringRef getSdyAttrKindName(SdyAttrKind kind) {
+  switch (kind) {
+    case SdyAttrKind::kAxisRef:
+      return "AxisRefAttr";
+    case SdyAttrKind::kSubAxisInfo:
+      return "SubAxisInfoAttr";
+    case SdyAttrKind::kDimensionSharding:
+      return "DimensionShardingAttr";
+    case SdyAttrKind::kTensorSharding:
+      return "TensorShardingAttr";
+    case SdyAttrKind::kTensorShardingPerValue:
+      return "TensorShardingPerValueAttr";
+    case SdyAttrKind::kOpShardingRule:
+      return "OpShardingRuleAttr";
+    case SdyAttrKind::kTensorMapping:
+      return "TensorMappingAttr";
+    case SdyAttrKind::kDimMapping:
+      return "DimMappingAttr";
+  }
+  llvm_unreachable("unknown SdyAttrKind");
+}
+
+SdyAttributeFootprint SdyAttributeFootprint::collect(Operation* op) {
+  SdyAttributeFootprint result;
+  // The walker visits each distinct attribute once, even if it's nested in
+  // attributes of different ops.
+  AttrTypeWalker walker;
+  walker.addWalk([&](Attribute attr) {
+    if (auto kindAndBytes = getKindAndBytes(attr)) {
+      auto [kind, bytes] = *kindAndBytes;
+      AttributeFootprint& footprint =
+          result.footprints[static_cast<int64_t>(kind)];
+      ++footprint.count;
+      footprint.bytes += bytes;
+    }
+  });
+  op->walk([&](Operation* nestedOp) {
+    // Inherent attributes of ops with properties aren't in the attribute
+    // dictionary.
+    NamedAttrList attrs(nestedOp->getRawDictionaryAttrs());
+    nestedOp->getName().populateInherentAttrs(nestedOp, attrs);
+    for (NamedAttribute attr : attrs) {
+      walker.walk(attr.getValue());
+    }
+  });
+  return result;
+}
+
+AttributeFootprint SdyAttributeFootprint::total() const {
+  AttributeFootprint total;
+  for (const AttributeFootprint& footprint : footprints) {
+    total.count += footprint.count;
+    total.bytes += footprint.bytes;
+  }
+  return total;
+}
+
+void SdyAttributeFootprint::print(raw_ostream& os,
+                                  const SdyAttributeFootprint* before) const {
+  auto printLine = [&](StringRef name, const AttributeFootprint& footprint,
+                       const AttributeFootprint* prev) {
+    os << llvm::formatv("{0,-28} {1,10} instances {2,12} bytes", name,
+                        footprint.count, footprint.bytes);
+    if (prev) {
+      os << llvm::formatv(" ({0} instances, {1} bytes)",
+                          formatChange(footprint.count - prev->count),
+                          formatChange(footprint.bytes - prev->bytes));
+    }
+    os << "\n";
+  };
+  for (int64_t kind = 0; kind < kNumSdyAttrKinds; ++kind) {
+    printLine(getSdyAttrKindName(static_cast<SdyAttrKind>(kind)),
+              footprints[kind], before ? &before->footprints[kind] : nullptr);
+  }
+  AttributeFootprint totalBefore;
+  if (before) {
+    totalBefore = before->total();
+  }
+  printLine("total", total(), before ? &totalBefore : nullptr);
+}
+
+void SdyAttributeFootprint::addTraceCounters() const {
+  if (!isTracingEnabled()) {
+    return;
+  }
+  for (int64_t kind = 0; kind < kNumSdyAttrKinds; ++kind) {
+    StringRef name = getSdyAttrKindName(static_cast<SdyAttrKind>(kind));
+    addTraceCounter(llvm::formatv("{0} instances", name).str(),
+                    footprints[kind].count);
+    addTraceCounter(llvm::formatv("{0} bytes", name).str(),
+                    footprints[kind].bytes);
+  }
+}
+
+std::unique_ptr<PassInstrumentation> createAttributeFootprintInstrumentation(
+    raw_ostream& os) {
+  return std::make_unique<AttributeFootprintInstrumentation>(os);
+}
+
+}  // namespace sdy
+}  // namespace mlir
@@ -0,0 +1,100 @@
+/* Copyright 2024 The Shardy Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef SHARDY_DIALECT_SDY_TRANSFORMS_COMMON_ATTRIBUTE_FOOTPRINT_H_
+#define SHARDY_DIALECT_SDY_TRANSFORMS_COMMON_ATTRIBUTE_FOOTPRINT_H_
+
+#include <array>
+#include <cstdint>
+#include <memory>
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/Pass/PassInstrumentation.h"
+#include "mlir/Support/LLVM.h"
+
+namespace mlir {
+namespace sdy {
+
+// The SDY attribute kinds whose footprint is measured.
+enum class SdyAttrKind {
+  kAxisRef,
+  kSubAxisInfo,
+  kDimensionSharding,
+  kTensorSharding,
+  kTensorShardingPerValue,
+  kOpShardingRule,
+  kTensorMapping,
+  kDimMapping,
+};
+
+inline constexpr int64_t kNumSdyAttrKinds = 8;
+
+// Returns the name of `kind`, e.g. "TensorShardingAttr".
+StringRef getSdyAttrKindName(SdyAttrKind kind);
+
+// The number of distinct instances of an attribute kind, and the approximate
+// number of bytes they take in the `MLIRContext`.
+struct AttributeFootprint {
+  int64_t count = 0;
+  int64_t bytes = 0;
+};
+
+// The footprint of each SDY attribute kind that is referenced by some IR.
+//
+// Attributes are uniqued and never freed by the `MLIRContext`, so the context
+// holds at least the attributes referenced by the IR. The bytes are an
+// estimate of the attribute storage, including arrays and strings it owns, but
+// not the overhead of the uniquer.
+class SdyAttributeFootprint {
+ public:
+  // Collects the distinct SDY attributes referenced, directly or nested in
+  // other attributes, by `op` and all ops nested in it.
+  static SdyAttributeFootprint collect(Operation* op);
+
+  const AttributeFootprint& operator[](SdyAttrKind kind) const {
+    return footprints[static_cast<int64_t>(kind)];
+  }
+
+  // Returns the sum of the footprints of all kinds.
+  AttributeFootprint total() const;
+
+  // Prints a line per kind and the total. If `before` is specified, also prints
+  // the change from `before` to this footprint.
+  void print(raw_ostream& os,
+             const SdyAttributeFootprint* before = nullptr) const;
+
+  // Records a trace counter for the count and bytes of each kind, if tracing
+  // is enabled.
+  void addTraceCounters() const;
+
+ private:
+  std::array<AttributeFootprint, kNumSdyAttrKinds> footprints;
+};
+
+// Returns a pass instrumentation that prints the SDY attribute footprint of the
+// module before the first pass, and the footprint and its change after each
+// pass that runs on a `ModuleOp`, to `os`.
+//
+// Passes nested under a `ModuleOp` (e.g. `func.func` passes) are reported as a
+// single pipeline after they all ran.
+std::unique_ptr<PassInstrumentation> createAttributeFootprintInstrumentation(
+    raw_ostream& os = llvm::errs());
+
+}  // namespace sdy
+}  // namespace mlir
+
+#endif  // SHARDY_DIALECT_SDY_TRANSFORMS_COMMON_ATTRIBUTE_FOOTPRINT_H_
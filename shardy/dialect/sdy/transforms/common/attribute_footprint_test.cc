@@ -0,0 +1,94 @@
+/* Copyright 2024 The Shardy Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "shardy/dialect/sdy/transforms/common/attribute_footprint.h"
+
+#include <string>
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Support/LLVM.h"
+#include "shardy/dialect/sdy/ir/register.h"
+#include <gtest/gtest.h>
+
+namespace mlir {
+namespace sdy {
+
+namespace {
+
+class AttributeFootprintTest : public ::testing::Test {
+ protected:
+  void SetUp() override { loadAllRequiredDialects(&context); }
+
+  MLIRContext context;
+};
+
+TEST_F(AttributeFootprintTest, CountsDistinctAttributes) {
+  const std::string program = R"mlir(
+    sdy.mesh @mesh = <["a"=2, "b"=2]>
+
+    func.func @main(
+        %arg0: tensor<8x8xf32> {sdy.sharding = #sdy.sharding<@mesh, [{"a"}, {}]>},
+        %arg1: tensor<8x8xf32> {sdy.sharding = #sdy.sharding<@mesh, [{"a"}, {}]>})
+        -> tensor<8x8xf32> {
+      %0 = stablehlo.add %arg0, %arg1 {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a"}, {"b"}]>]>} : tensor<8x8xf32>
+      return %0 : tensor<8x8xf32>
+    })mlir";
+
+  OwningOpRef<ModuleOp> module =
+      parseSourceString<ModuleOp>(program, &context);
+  ASSERT_TRUE(module);
+
+  SdyAttributeFootprint footprint =
+      SdyAttributeFootprint::collect(module.get());
+  // The sharding of both arguments is the same attribute.
+  EXPECT_EQ(footprint[SdyAttrKind::kTensorSharding].count, 2);
+  EXPECT_EQ(footprint[SdyAttrKind::kTensorShardingPerValue].count, 1);
+  // {"a"}, {} and {"b"}.
+  EXPECT_EQ(footprint[SdyAttrKind::kDimensionSharding].count, 3);
+  EXPECT_EQ(footprint[SdyAttrKind::kAxisRef].count, 2);
+  EXPECT_EQ(footprint[SdyAttrKind::kSubAxisInfo].count, 0);
+  EXPECT_EQ(footprint[SdyAttrKind::kOpShardingRule].count, 0);
+  EXPECT_EQ(footprint.total().count, 8);
+  EXPECT_GT(footprint[SdyAttrKind::kTensorSharding].bytes, 0);
+}
+
+TEST_F(AttributeFootprintTest, CountsShardingRules) {
+  const std::string program = R"mlir(
+    func.func @main(%arg0: tensor<8x8xf32>) -> tensor<8x8xf32> {
+      %0 = stablehlo.add %arg0, %arg0 {sdy.sharding_rule = #sdy.op_sharding_rule<([i, j], [i, j])->([i, j]) {i=8, j=8}>} : tensor<8x8xf32>
+      %1 = stablehlo.negate %0 {sdy.sharding_rule = #sdy.op_sharding_rule<([i, j])->([i, j]) {i=8, j=8}>} : tensor<8x8xf32>
+      return %1 : tensor<8x8xf32>
+    })mlir";
+
+  OwningOpRef<ModuleOp> module =
+      parseSourceString<ModuleOp>(program, &context);
+  ASSERT_TRUE(module);
+
+  SdyAttributeFootprint footprint =
+      SdyAttributeFootprint::collect(module.get());
+  EXPECT_EQ(footprint[SdyAttrKind::kOpShardingRule].count, 2);
+  // Both rules share the `[i, j]` tensor mapping.
+  EXPECT_EQ(footprint[SdyAttrKind::kTensorMapping].count, 1);
+  // [i] and [j].
+  EXPECT_EQ(footprint[SdyAttrKind::kDimMapping].count, 2);
+}
+
+}  // namespace
+
+}  // namespace sdy
+}  // namespace mlir
@@ -15,10 +15,14 @@ limitations under the License.
 
 #include "shardy/dialect/sdy/transforms/common/op_properties.h"
 
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
 #include "mlir/IR/OpDefinition.h"
 #include "mlir/IR/Operation.h"
 #include "mlir/IR/Value.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
 #include "mlir/Support/LLVM.h"
+#include "shardy/dialect/sdy/ir/dialect.h"
 #include "shardy/dialect/sdy/ir/utils.h"
 #include "stablehlo/dialect/Base.h"
 #include "stablehlo/dialect/StablehloOps.h"
@@ -39,5 +43,18 @@ bool isElementwise(Operation* op) {
   return false;
 }
 
+bool isConstantExpression(Operation* op,
+                          const llvm::SetVector<Operation*>& constantOps) {
+  if (isa<ConstantOp, stablehlo::IotaOp>(op)) {
+    return true;
+  }
+  return (isa<stablehlo::BroadcastInDimOp, stablehlo::SliceOp>(op) ||
+          isElementwise(op)) &&
+         isPure(op) && llvm::all_of(op->getOperands(), [&](Value operand) {
+           return operand.getDefiningOp() &&
+                  constantOps.contains(operand.getDefiningOp());
+         });
+}
+
 }  // namespace sdy
 }  // namespace mlir
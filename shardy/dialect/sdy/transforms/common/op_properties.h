@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef SHARDY_DIALECT_SDY_TRANSFORMS_COMMON_OP_PROPERTIES_H_
 #define SHARDY_DIALECT_SDY_TRANSFORMS_COMMON_OP_PROPERTIES_H_
 
+#include "llvm/ADT/SetVector.h"
 #include "mlir/IR/Operation.h"
 
 namespace mlir {
@@ -27,6 +28,16 @@ namespace sdy {
 // the element in the input tensors with the same index.
 bool isElementwise(Operation* op);
 
+// Returns true if the given op is either:
+// - A constant or iota op.
+// - A broadcast, slice, or pure element-wise op whose operands are all
+// constants (exist in `constantOps`).
+//
+// This defines the constant sub-computations that `sdy-constant-splitter`
+// splits and `sdy-constant-merger` merges.
+bool isConstantExpression(Operation* op,
+                          const llvm::SetVector<Operation*>& constantOps);
+
 }  // namespace sdy
 }  // namespace mlir
 
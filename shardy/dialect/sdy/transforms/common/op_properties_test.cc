@@ -18,9 +18,12 @@ limitations under the License.
 #include <cassert>
 #include <string>
 
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallVector.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/Operation.h"
 #include "mlir/IR/OwningOpRef.h"
 #include "mlir/Parser/Parser.h"
 #include "mlir/Support/LLVM.h"
@@ -122,6 +125,33 @@ TEST_F(IsElementwiseTest, BitcastConvertOpDifferentBitWidth) {
       isElementwise(getFirstOp<stablehlo::BitcastConvertOp>(module.get())));
 }
 
+TEST(IsConstantExpressionTest, ConstantSubComputation) {
+  MLIRContext context;
+  loadAllRequiredDialects(&context);
+  const std::string program = R"mlir(
+    func.func @main(%arg0: tensor<8xi32>) -> tensor<8xi32> {
+      %0 = stablehlo.iota dim = 0 : tensor<8xi32>
+      %1 = stablehlo.add %0, %0 : tensor<8xi32>
+      %2 = stablehlo.add %1, %arg0 : tensor<8xi32>
+      return %2 : tensor<8xi32>
+    })mlir";
+
+  OwningOpRef<ModuleOp> module =
+      parseSourceString<ModuleOp>(program, &context);
+  ASSERT_TRUE(module);
+
+  auto mainFn = cast<func::FuncOp>(module->lookupSymbol("main"));
+  llvm::SetVector<Operation*> constantOps;
+  SmallVector<bool> results;
+  for (Operation& op : mainFn.getBody().front().without_terminator()) {
+    results.push_back(isConstantExpression(&op, constantOps));
+    if (results.back()) {
+      constantOps.insert(&op);
+    }
+  }
+  EXPECT_EQ(results, SmallVector<bool>({true, true, false}));
+}
+
 }  // namespace
 
 }  // namespace sdy
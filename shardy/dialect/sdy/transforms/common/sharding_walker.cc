@@ -76,7 +76,7 @@ void processSharding(const ValueOrFuncResult& valueOrFuncResult,
 
 // Applies `callback` on each sharding in `shardings` if present, and
 // corresponding value in `values`, and calls `setShardingsFn` on the results if
-// `transformShardings` is true.
+// `transformShardings` is true and any sharding has changed.
 void processShardings(
     ArrayRef<TensorShardingAttr> shardings, ValueRange values,
     bool transformShardings, TransformShardingForTensorFn callback,
@@ -95,7 +95,9 @@ void processShardings(
   for (auto [sharding, value] : llvm::zip_equal(shardings, values)) {
     newShardings.push_back(callback(sharding, value));
   }
-  setShardingsFn(newShardings);
+  if (newShardings != shardings) {
+    setShardingsFn(newShardings);
+  }
 }
 
 // Same as above but for `TensorShardingPerValueAttr`.
@@ -111,71 +113,78 @@ void processShardings(
                           });
 }
 
+// Applies `callback` on the shardings of `op` (but not of ops nested in it),
+// and replaces them with the result if `transformShardings` is true.
+void processOpShardings(Operation* op, TransformShardingForTensorFn callback,
+                        bool transformShardings) {
+  TypeSwitch<Operation*, void>(op)
+      .Case<FuncOp>([&](FuncOp funcOp) {
+        for (BlockArgument arg : funcOp.getArguments()) {
+          processSharding(arg, transformShardings, callback);
+        }
+        for (int64_t resNum = 0; resNum < funcOp.getNumResults(); ++resNum) {
+          processSharding(FuncResult(funcOp, resNum), transformShardings,
+                          callback);
+        }
+      })
+      .Case<ManualComputationOp>(
+          [&](ManualComputationOp manualComputationOp) {
+            processShardings(
+                manualComputationOp.getInShardings(),
+                manualComputationOp.getBody().getArguments(),
+                transformShardings, callback,
+                [&](TensorShardingPerValueAttr newShardings) {
+                  manualComputationOp.setInShardingsAttr(newShardings);
+                });
+            processShardings(
+                manualComputationOp.getOutShardings(),
+                manualComputationOp.getResults(), transformShardings,
+                callback, [&](TensorShardingPerValueAttr newShardings) {
+                  manualComputationOp.setOutShardingsAttr(newShardings);
+                });
+          })
+      .Case<ShardableDataFlowOpInterface>(
+          [&](ShardableDataFlowOpInterface shardableDataFlowOp) {
+            processShardings(
+                shardableDataFlowOp.getBlockArgumentEdgeOwnerShardings(),
+                shardableDataFlowOp.getBlockArgumentEdgeOwners(),
+                transformShardings, callback,
+                [&](ArrayRef<TensorShardingAttr> newShardings) {
+                  shardableDataFlowOp.setBlockArgumentEdgeOwnerShardings(
+                      newShardings);
+                });
+            processShardings(
+                shardableDataFlowOp.getOpResultEdgeOwnerShardings(),
+                shardableDataFlowOp.getOpResultEdgeOwners(),
+                transformShardings, callback,
+                [&](ArrayRef<TensorShardingAttr> newShardings) {
+                  shardableDataFlowOp.setOpResultEdgeOwnerShardings(
+                      newShardings);
+                });
+          })
+      .Default([&](Operation* op) {
+        if (op->getNumResults() == 1) {
+          // For ops with a single result, we use `get/setSharding` instead of
+          // `get/setShardings`, since the latter only handle ops with an
+          // unregistered sharding attribute, to also handle SDY ops like
+          // `ShardingConstraintOp`.
+          Value result = op->getResult(0);
+          processSharding(result, transformShardings, callback);
+        } else {
+          processShardings(getShardings(op), op->getResults(),
+                           transformShardings, callback,
+                           [&](ArrayRef<TensorShardingAttr> newShardings) {
+                             setShardings(op, newShardings);
+                           });
+        }
+      });
+}
+
 void walkShardings(Operation* rootOp, TransformShardingForTensorFn callback,
                    ConsumeOpFn consumeOpFn, bool transformShardings) {
   rootOp->walk<WalkOrder::PreOrder>([&](Operation* op) {
     consumeOpFn(op);
-    TypeSwitch<Operation*, void>(op)
-        .Case<FuncOp>([&](FuncOp funcOp) {
-          for (BlockArgument arg : funcOp.getArguments()) {
-            processSharding(arg, transformShardings, callback);
-          }
-          for (int64_t resNum = 0; resNum < funcOp.getNumResults(); ++resNum) {
-            processSharding(FuncResult(funcOp, resNum), transformShardings,
-                            callback);
-          }
-        })
-        .Case<ManualComputationOp>(
-            [&](ManualComputationOp manualComputationOp) {
-              processShardings(
-                  manualComputationOp.getInShardings(),
-                  manualComputationOp.getBody().getArguments(),
-                  transformShardings, callback,
-                  [&](TensorShardingPerValueAttr newShardings) {
-                    manualComputationOp.setInShardingsAttr(newShardings);
-                  });
-              processShardings(
-                  manualComputationOp.getOutShardings(),
-                  manualComputationOp.getResults(), transformShardings,
-                  callback, [&](TensorShardingPerValueAttr newShardings) {
-                    manualComputationOp.setOutShardingsAttr(newShardings);
-                  });
-            })
-        .Case<ShardableDataFlowOpInterface>(
-            [&](ShardableDataFlowOpInterface shardableDataFlowOp) {
-              processShardings(
-                  shardableDataFlowOp.getBlockArgumentEdgeOwnerShardings(),
-                  shardableDataFlowOp.getBlockArgumentEdgeOwners(),
-                  transformShardings, callback,
-                  [&](ArrayRef<TensorShardingAttr> newShardings) {
-                    shardableDataFlowOp.setBlockArgumentEdgeOwnerShardings(
-                        newShardings);
-                  });
-              processShardings(
-                  shardableDataFlowOp.getOpResultEdgeOwnerShardings(),
-                  shardableDataFlowOp.getOpResultEdgeOwners(),
-                  transformShardings, callback,
-                  [&](ArrayRef<TensorShardingAttr> newShardings) {
-                    shardableDataFlowOp.setOpResultEdgeOwnerShardings(
-                        newShardings);
-                  });
-            })
-        .Default([&](Operation* op) {
-          if (op->getNumResults() == 1) {
-            // For ops with a single result, we use `get/setSharding` instead of
-            // `get/setShardings`, since the latter only handle ops with an
-            // unregistered sharding attribute, to also handle SDY ops like
-            // `ShardingConstraintOp`.
-            Value result = op->getResult(0);
-            processSharding(result, transformShardings, callback);
-          } else {
-            processShardings(getShardings(op), op->getResults(),
-                             transformShardings, callback,
-                             [&](ArrayRef<TensorShardingAttr> newShardings) {
-                               setShardings(op, newShardings);
-                             });
-          }
-        });
+    processOpShardings(op, callback, transformShardings);
   });
 }
 
@@ -229,5 +238,14 @@ void transformShardings(Operation* rootOp, TransformShardingFn transformFn,
       consumeOpFn);
 }
 
+void transformOpShardings(Operation* op, TransformShardingFn transformFn) {
+  processOpShardings(
+      op,
+      [transformFn](TensorShardingAttr newSharding, const ValueOrFuncResult&) {
+        return transformFn(newSharding);
+      },
+      /*transformShardings=*/true);
+}
+
 }  // namespace sdy
 }  // namespace mlir
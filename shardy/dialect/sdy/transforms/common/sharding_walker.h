@@ -92,6 +92,12 @@ void transformShardings(
     Operation* rootOp, TransformShardingFn transformFn,
     ConsumeOpFn consumeOpFn = [](Operation*) {});
 
+// Updates any `TensorShardingAttr` of `op` itself, but not of ops nested in
+// it, by applying `transformFn` on it.
+//
+// This allows transforming shardings as part of another walk.
+void transformOpShardings(Operation* op, TransformShardingFn transformFn);
+
 }  // namespace sdy
 }  // namespace mlir
 
@@ -0,0 +1,92 @@
+/* Copyright 2024 The Shardy Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstddef>
+#include <memory>  // IWYU pragma: keep
+#include <utility>
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallVector.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/Block.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/OperationSupport.h"
+#include "mlir/Pass/Pass.h"  // IWYU pragma: keep
+#include "mlir/Support/LLVM.h"
+#include "shardy/dialect/sdy/ir/dialect.h"
+#include "shardy/dialect/sdy/transforms/common/op_properties.h"
+
+namespace mlir {
+namespace sdy {
+
+#define GEN_PASS_DEF_CONSTANTMERGERPASS
+#include "shardy/dialect/sdy/transforms/export/passes.h.inc"
+
+namespace {
+
+using func::FuncOp;
+
+struct ConstantMergerPass
+    : public impl::ConstantMergerPassBase<ConstantMergerPass> {
+  using ConstantMergerPassBase::ConstantMergerPassBase;
+
+  void runOnOperation() final {
+    FuncOp funcOp = getOperation();
+
+    llvm::SetVector<Operation*> constantOps;
+    // The constant ops that were kept so far, bucketed by their block and
+    // hash. The operands of each op are already merged when it's visited, so
+    // two ops are identical iff they are equivalent with the exact same
+    // operands.
+    llvm::DenseMap<std::pair<Block*, size_t>, SmallVector<Operation*>>
+        uniqueConstantOps;
+    SmallVector<Operation*> opsToErase;
+    funcOp.walk([&](Operation* op) {
+      if (!isConstantExpression(op, constantOps)) {
+        return;
+      }
+      SmallVector<Operation*>& candidates = uniqueConstantOps[{
+          op->getBlock(), OperationEquivalence::computeHash(
+                              op, OperationEquivalence::directHashValue,
+                              OperationEquivalence::ignoreHashValue,
+                              OperationEquivalence::IgnoreLocations)}];
+      for (Operation* candidate : candidates) {
+        if (OperationEquivalence::isEquivalentTo(
+                candidate, op, OperationEquivalence::IgnoreLocations)) {
+          // `candidate` is before `op` in the same block, so it dominates all
+          // uses of `op`.
+          op->replaceAllUsesWith(candidate);
+          opsToErase.push_back(op);
+          return;
+        }
+      }
+      candidates.push_back(op);
+      constantOps.insert(op);
+    });
+
+    // The merged ops no longer have any uses, as long as we erase them in
+    // reverse order.
+    for (Operation* op : llvm::reverse(opsToErase)) {
+      op->erase();
+    }
+  }
+};
+
+}  // namespace
+
+}  // namespace sdy
+}  // namespace mlir
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include "llvm/Support/CommandLine.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Pass/PassRegistry.h"
@@ -24,24 +25,60 @@ namespace mlir {
 namespace sdy {
 
 void addExportPipeline(OpPassManager& pm, StringRef dumpDirectory,
-                       bool skipConvertToReshard) {
-  pm.addPass(createRemoveShardingGroupsPass());
-  if (!skipConvertToReshard) {
-    pm.addNestedPass<func::FuncOp>(createShardingConstraintToReshardPass());
+                       bool skipConvertToReshard, bool fuseExportPasses,
+                       const SaveModuleOpOptions& saveModuleOpOptions) {
+  if (fuseExportPasses) {
+    // The constant merger doesn't depend on sharding groups or sharding
+    // constraints, so it can run before the fused pass.
+    pm.addNestedPass<func::FuncOp>(createConstantMergerPass());
+    FusedExportPassOptions fusedExportOptions;
+    fusedExportOptions.convertToReshard = !skipConvertToReshard;
+    pm.addNestedPass<func::FuncOp>(createFusedExportPass(fusedExportOptions));
+  } else {
+    pm.addPass(createRemoveShardingGroupsPass());
+    if (!skipConvertToReshard) {
+      pm.addNestedPass<func::FuncOp>(createShardingConstraintToReshardPass());
+    }
+    // Merge the constant sub-computations that ended up with identical
+    // shardings, before the shardings of data flow edges are moved to their
+    // owners.
+    pm.addNestedPass<func::FuncOp>(createConstantMergerPass());
+    pm.addNestedPass<func::FuncOp>(createSinkDataFlowEdgesPass());
+    pm.addNestedPass<func::FuncOp>(
+        createUpdateNonDivisibleInputOutputShardingsPass());
   }
-  pm.addNestedPass<func::FuncOp>(createSinkDataFlowEdgesPass());
-  pm.addNestedPass<func::FuncOp>(
-      createUpdateNonDivisibleInputOutputShardingsPass());
-  pm.addPass(mlir::sdy::createSaveModuleOpPass(dumpDirectory,
-                                               "sdy_module_after_sdy_export"));
+  if (!dumpDirectory.empty()) {
+    HotspotReportPassOptions hotspotReportOptions;
+    hotspotReportOptions.dumpDirectory = dumpDirectory.str();
+    pm.addPass(createHotspotReportPass(hotspotReportOptions));
+  }
+  pm.addPass(mlir::sdy::createSaveModuleOpPass(
+      dumpDirectory, "sdy_module_after_sdy_export", saveModuleOpOptions));
 }
 
+namespace {
+
+struct ExportPipelineOptions
+    : public PassPipelineOptions<ExportPipelineOptions> {
+  Option<bool> fuseExportPasses{
+      *this, "fuse-export-passes",
+      llvm::cl::desc("Whether to replace the passes that can be fused with a "
+                     "single `sdy-fused-export` pass."),
+      llvm::cl::init(false)};
+};
+
+}  // namespace
+
 void registerExportPipeline() {
-  PassPipelineRegistration<>(
+  PassPipelineRegistration<ExportPipelineOptions>(
       "sdy-export-pipeline",
       "Run a sequence of export passes needed as a post-processing step for "
       "Shardy propagation",
-      [](OpPassManager& pm) { return addExportPipeline(pm); });
+      [](OpPassManager& pm, const ExportPipelineOptions& options) {
+        return addExportPipeline(pm, /*dumpDirectory=*/"",
+                                 /*skipConvertToReshard=*/false,
+                                 options.fuseExportPasses);
+      });
 }
 
 }  // namespace sdy
@@ -0,0 +1,51 @@
+/* Copyright 2024 The Shardy Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef SHARDY_DIALECT_SDY_TRANSFORMS_EXPORT_EXPORT_UTILS_H_
+#define SHARDY_DIALECT_SDY_TRANSFORMS_EXPORT_EXPORT_UTILS_H_
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Support/LLVM.h"
+#include "shardy/dialect/sdy/ir/dialect.h"
+
+// The per-op logic of the export passes, shared by each pass and the fused
+// export pass.
+
+namespace mlir {
+namespace sdy {
+
+// Replaces `op` with a `ReshardOp` of `input` with the same sharding and
+// discardable attributes (see `ShardingConstraintToReshardPass`).
+ReshardOp replaceShardingConstraintWithReshard(ShardingConstraintOp op,
+                                               Value input,
+                                               RewriterBase& rewriter);
+
+// If `op` is a data flow op, moves the shardings of its `DataFlowEdgeOp`s to
+// the corresponding edge owners (see `SinkDataFlowEdgesPass`). The
+// `DataFlowEdgeOp`s aren't erased.
+void sinkDataFlowEdgeShardings(Operation* op);
+
+// Updates the input and output shardings of `funcOp` to the largest prefix of
+// each sharding that evenly shards the tensor (see
+// `UpdateNonDivisibleInputOutputShardingsPass`).
+void updateNonDivisibleInputOutputShardings(func::FuncOp funcOp);
+
+}  // namespace sdy
+}  // namespace mlir
+
+#endif  // SHARDY_DIALECT_SDY_TRANSFORMS_EXPORT_EXPORT_UTILS_H_
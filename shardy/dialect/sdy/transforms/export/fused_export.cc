@@ -0,0 +1,89 @@
+/* Copyright 2024 The Shardy Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>  // IWYU pragma: keep
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/IR/Visitors.h"
+#include "mlir/Pass/Pass.h"  // IWYU pragma: keep
+#include "mlir/Support/LLVM.h"
+#include "shardy/dialect/sdy/ir/dialect.h"
+#include "shardy/dialect/sdy/ir/utils.h"
+#include "shardy/dialect/sdy/transforms/common/sharding_walker.h"
+#include "shardy/dialect/sdy/transforms/export/export_utils.h"
+
+namespace mlir {
+namespace sdy {
+
+#define GEN_PASS_DEF_FUSEDEXPORTPASS
+#include "shardy/dialect/sdy/transforms/export/passes.h.inc"
+
+namespace {
+
+struct FusedExportPass : public impl::FusedExportPassBase<FusedExportPass> {
+  using FusedExportPassBase::FusedExportPassBase;
+
+  void runOnOperation() final {
+    func::FuncOp funcOp = getOperation();
+    IRRewriter rewriter(funcOp.getContext());
+
+    // Closes the shardings and drops the sharding rule of an op once it has
+    // its final shardings.
+    auto finalizeOp = [&](Operation* op) {
+      if (closeShardings) {
+        transformOpShardings(op, TensorShardingAttr::getClosedLike);
+      }
+      if (dropShardingRules) {
+        removeShardingRule(op);
+      }
+    };
+
+    // Since the walk is in forward pre-order, a data flow op is visited before
+    // its `DataFlowEdgeOp`s, which are either its users or in its regions, so
+    // the edges can be erased when they are visited. Erasing the visited op
+    // requires skipping it. See `SinkDataFlowEdgesPass` for more details.
+    funcOp.walk<WalkOrder::PreOrder>([&](Operation* op) {
+      if (isa<ShardingGroupOp>(op)) {
+        op->erase();
+        return WalkResult::skip();
+      }
+      if (auto dataFlowEdgeOp = dyn_cast<DataFlowEdgeOp>(op)) {
+        rewriter.replaceOp(dataFlowEdgeOp, dataFlowEdgeOp.getInput());
+        return WalkResult::skip();
+      }
+      if (auto shardingConstraintOp = dyn_cast<ShardingConstraintOp>(op);
+          shardingConstraintOp && convertToReshard) {
+        // The `ReshardOp` is inserted before the visited op, so it won't be
+        // visited.
+        finalizeOp(replaceShardingConstraintWithReshard(
+            shardingConstraintOp, shardingConstraintOp.getInput(), rewriter));
+        return WalkResult::skip();
+      }
+      if (auto nestedFuncOp = dyn_cast<func::FuncOp>(op)) {
+        updateNonDivisibleInputOutputShardings(nestedFuncOp);
+      }
+      sinkDataFlowEdgeShardings(op);
+      finalizeOp(op);
+      return WalkResult::advance();
+    });
+  }
+};
+
+}  // namespace
+
+}  // namespace sdy
+}  // namespace mlir
@@ -0,0 +1,327 @@
+/* Copyright 2024 The Shardy Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+#include <memory>  // IWYU pragma: keep
+#include <string>
+#include <utility>
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/ScopedPrinter.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/Diagnostics.h"
+#include "mlir/IR/Location.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Pass/Pass.h"  // IWYU pragma: keep
+#include "mlir/Support/LLVM.h"
+#include "shardy/common/file_utils.h"
+#include "shardy/dialect/sdy/ir/constants.h"
+#include "shardy/dialect/sdy/ir/dialect.h"
+#include "shardy/dialect/sdy/ir/utils.h"
+
+namespace mlir {
+namespace sdy {
+
+#define GEN_PASS_DEF_HOTSPOTREPORTPASS
+#include "shardy/dialect/sdy/transforms/export/passes.h.inc"
+
+namespace {
+
+using func::FuncOp;
+
+// A tensor that is resharded or replicated, or a neighbor of one, with its
+// sharding and the user shardings its axes originated from.
+struct TensorInfo {
+  std::string description;
+  Location loc;
+  TensorShardingAttr sharding;
+  // The `kOriginShardingAttr` dictionary saved by propagation with
+  // `debug-sharding-origins=true`, or nullptr.
+  DictionaryAttr origins;
+};
+
+// Returns the user shardings in `origins` (see `TensorInfo::origins`), without
+// duplicates, or "none" if there are none.
+std::string getOriginNames(DictionaryAttr origins) {
+  SmallVector<StringRef> names;
+  if (origins) {
+    for (NamedAttribute entry : origins) {
+      if (auto name = dyn_cast<StringAttr>(entry.getValue());
+          name && !llvm::is_contained(names, name.getValue())) {
+        names.push_back(name.getValue());
+      }
+    }
+  }
+  return names.empty() ? "none" : llvm::join(names, ", ");
+}
+
+// Returns what caused `reshardOp`, based on the sharding origins saved by
+// propagation with `debug-sharding-origins=true`, or "unknown" if there are
+// none.
+std::string getReshardReason(ReshardOp reshardOp, const TensorInfo& operandInfo,
+                             const TensorInfo& resultInfo) {
+  if (auto originName =
+          reshardOp->getAttrOfType<StringAttr>(kOriginShardingNameAttr)) {
+    return llvm::formatv("user sharding constraint {0}", originName.getValue());
+  }
+  if (operandInfo.origins || resultInfo.origins) {
+    return llvm::formatv(
+        "sharding conflict between origins [{0}] of the operand and [{1}] of "
+        "the result",
+        getOriginNames(operandInfo.origins),
+        getOriginNames(resultInfo.origins));
+  }
+  return "unknown";
+}
+
+// Returns the size in bytes of `type`, or 0 if it isn't a statically shaped
+// tensor with an integer, float or complex element type.
+int64_t getSizeInBytes(Type type) {
+  auto tensorType = dyn_cast<RankedTensorType>(type);
+  if (!tensorType || !tensorType.hasStaticShape()) {
+    return 0;
+  }
+  Type elementType = tensorType.getElementType();
+  int64_t numParts = 1;
+  if (auto complexType = dyn_cast<ComplexType>(elementType)) {
+    elementType = complexType.getElementType();
+    numParts = 2;
+  }
+  if (!elementType.isIntOrFloat()) {
+    return 0;
+  }
+  return tensorType.getNumElements() * numParts *
+         llvm::divideCeil(elementType.getIntOrFloatBitWidth(), 8);
+}
+
+TensorInfo getTensorInfo(Value value) {
+  if (auto blockArg = dyn_cast<BlockArgument>(value)) {
+    Operation* parentOp = blockArg.getOwner()->getParentOp();
+    DictionaryAttr origins;
+    std::string description;
+    if (auto funcOp = dyn_cast<FuncOp>(parentOp)) {
+      origins = funcOp.getArgAttrOfType<DictionaryAttr>(
+          blockArg.getArgNumber(), kOriginShardingAttr);
+      description = llvm::formatv("@{0} input {1}", funcOp.getSymName(),
+                                  blockArg.getArgNumber());
+    } else {
+      description = llvm::formatv("{0} block argument {1}",
+                                  parentOp->getName(), blockArg.getArgNumber());
+    }
+    return TensorInfo{std::move(description), value.getLoc(),
+                      getSharding(value), origins};
+  }
+  auto result = cast<OpResult>(value);
+  Operation* op = result.getOwner();
+  return TensorInfo{
+      llvm::formatv("{0} result {1}", op->getName(), result.getResultNumber()),
+      value.getLoc(), getSharding(value),
+      op->getAttrOfType<DictionaryAttr>(kOriginShardingAttr)};
+}
+
+TensorInfo getFuncResultInfo(FuncOp funcOp, int64_t resNum) {
+  return TensorInfo{
+      llvm::formatv("@{0} output {1}", funcOp.getSymName(), resNum),
+      getBodyTerminator(funcOp)->getOperand(resNum).getLoc(),
+      getFuncResultSharding(funcOp, resNum),
+      funcOp.getResultAttrOfType<DictionaryAttr>(resNum, kOriginShardingAttr)};
+}
+
+llvm::json::Object toJson(const TensorInfo& info) {
+  llvm::json::Object json{
+      {"tensor", info.description},
+      {"location", llvm::to_string(info.loc)},
+      {"sharding", info.sharding ? llvm::to_string(info.sharding) : "none"},
+  };
+  if (info.origins) {
+    llvm::json::Object origins;
+    for (NamedAttribute entry : info.origins) {
+      if (auto origin = dyn_cast<StringAttr>(entry.getValue())) {
+        origins[entry.getName().strref()] = origin.str();
+      }
+    }
+    json["origins"] = std::move(origins);
+  }
+  return json;
+}
+
+bool isReplicated(TensorShardingAttr sharding) {
+  return !sharding || sharding.isFullyReplicated();
+}
+
+// Returns the neighbors of `value` (the operands of its defining op, the
+// results of its users, and the function outputs it's returned as) that are
+// sharded along at least one axis.
+SmallVector<TensorInfo> getShardedNeighbors(Value value) {
+  SmallVector<TensorInfo> neighbors;
+  auto addIfSharded = [&](Value neighbor) {
+    if (!isReplicated(getSharding(neighbor))) {
+      neighbors.push_back(getTensorInfo(neighbor));
+    }
+  };
+  if (Operation* defOp = value.getDefiningOp()) {
+    llvm::for_each(defOp->getOperands(), addIfSharded);
+  }
+  for (OpOperand& use : value.getUses()) {
+    Operation* user = use.getOwner();
+    if (auto funcOp = dyn_cast<FuncOp>(user->getParentOp());
+        funcOp && user == getBodyTerminator(funcOp)) {
+      TensorInfo info = getFuncResultInfo(funcOp, use.getOperandNumber());
+      if (!isReplicated(info.sharding)) {
+        neighbors.push_back(std::move(info));
+      }
+      continue;
+    }
+    llvm::for_each(user->getResults(), addIfSharded);
+  }
+  return neighbors;
+}
+
+// Sorts `entries` by size in bytes in descending order, keeping the module
+// order for entries of the same size, and keeps the first `numEntries`.
+template <typename EntryT>
+void keepLargest(SmallVector<EntryT>& entries, int64_t numEntries) {
+  llvm::stable_sort(entries, [](const EntryT& a, const EntryT& b) {
+    return a.second > b.second;
+  });
+  if (static_cast<int64_t>(entries.size()) > numEntries) {
+    entries.truncate(numEntries);
+  }
+}
+
+struct HotspotReportPass
+    : public impl::HotspotReportPassBase<HotspotReportPass> {
+  using HotspotReportPassBase::HotspotReportPassBase;
+
+  void runOnOperation() final {
+    ModuleOp moduleOp = getOperation();
+    markAllAnalysesPreserved();
+    if (dumpDirectory.empty() && !emitRemarks) {
+      return;
+    }
+
+    SmallVector<std::pair<ReshardOp, int64_t>> reshards;
+    SmallVector<std::pair<Value, int64_t>> replicatedTensors;
+    auto addIfReplicated = [&](Value value) {
+      if (int64_t bytes = getSizeInBytes(value.getType());
+          bytes > 0 && isReplicated(getSharding(value))) {
+        replicatedTensors.emplace_back(value, bytes);
+      }
+    };
+    moduleOp.walk([&](Operation* op) {
+      if (auto reshardOp = dyn_cast<ReshardOp>(op)) {
+        if (int64_t bytes = getSizeInBytes(reshardOp.getType()); bytes > 0) {
+          reshards.emplace_back(reshardOp, bytes);
+        }
+        return;
+      }
+      if (auto funcOp = dyn_cast<FuncOp>(op)) {
+        if (!funcOp.isDeclaration()) {
+          llvm::for_each(funcOp.getArguments(), addIfReplicated);
+        }
+        return;
+      }
+      // Tensors in the body of a `ManualComputationOp` are local to each
+      // device, so a missing sharding doesn't mean they are replicated.
+      if (op->getParentOfType<ManualComputationOp>()) {
+        return;
+      }
+      llvm::for_each(op->getResults(), addIfReplicated);
+    });
+    keepLargest(reshards, numEntries);
+    keepLargest(replicatedTensors, numEntries);
+
+    llvm::json::Array reshardsJson;
+    for (auto [index, reshardEntry] : llvm::enumerate(reshards)) {
+      auto [reshardOp, bytes] = reshardEntry;
+      TensorInfo operandInfo = getTensorInfo(reshardOp.getInput());
+      TensorInfo resultInfo = getTensorInfo(reshardOp.getResult());
+      // Unless the reshard came from a sharding constraint, it was created
+      // after propagation, so the origins of the target sharding are on the
+      // user that required it, if any.
+      for (Operation* user : reshardOp->getUsers()) {
+        if (resultInfo.origins) {
+          break;
+        }
+        resultInfo.origins =
+            user->getAttrOfType<DictionaryAttr>(kOriginShardingAttr);
+      }
+      std::string reason = getReshardReason(reshardOp, operandInfo, resultInfo);
+      if (emitRemarks) {
+        emitRemark(reshardOp.getLoc())
+            << "hotspot reshard #" << index + 1 << " of " << bytes
+            << " bytes from "
+            << (operandInfo.sharding ? llvm::to_string(operandInfo.sharding)
+                                     : "no sharding")
+            << " to " << resultInfo.sharding << ", caused by " << reason;
+      }
+      reshardsJson.push_back(llvm::json::Object{
+          {"bytes", bytes},
+          {"location", llvm::to_string(reshardOp.getLoc())},
+          {"reason", reason},
+          {"from", toJson(operandInfo)},
+          {"to", toJson(resultInfo)},
+      });
+    }
+
+    llvm::json::Array replicatedJson;
+    for (auto [index, replicatedEntry] : llvm::enumerate(replicatedTensors)) {
+      auto [value, bytes] = replicatedEntry;
+      TensorInfo info = getTensorInfo(value);
+      SmallVector<TensorInfo> neighbors = getShardedNeighbors(value);
+      if (emitRemarks) {
+        InFlightDiagnostic remark = emitRemark(info.loc);
+        remark << "hotspot replicated tensor #" << index + 1 << ": "
+               << info.description << " of " << bytes << " bytes, ";
+        if (neighbors.empty()) {
+          remark << "no sharded neighbors";
+        } else {
+          remark << "sharded neighbors: ";
+          llvm::interleaveComma(neighbors, remark, [&](const TensorInfo& n) {
+            remark << n.description << " " << n.sharding;
+          });
+        }
+      }
+      llvm::json::Array neighborsJson;
+      for (const TensorInfo& neighbor : neighbors) {
+        neighborsJson.push_back(toJson(neighbor));
+      }
+      llvm::json::Object entry = toJson(info);
+      entry["bytes"] = bytes;
+      entry["sharded_neighbors"] = std::move(neighborsJson);
+      replicatedJson.push_back(std::move(entry));
+    }
+
+    saveJson(
+        llvm::json::Object{{"reshards", std::move(reshardsJson)},
+                           {"replicated_tensors", std::move(replicatedJson)}},
+        dumpDirectory, "sdy_hotspot_report");
+  }
+};
+
+}  // namespace
+
+}  // namespace sdy
+}  // namespace mlir
@@ -24,6 +24,7 @@ limitations under the License.
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Support/LLVM.h"
+#include "shardy/common/save_module_op.h"
 #include "shardy/dialect/sdy/ir/dialect.h"
 
 // IWYU pragma: end_keep
@@ -37,8 +38,16 @@ namespace sdy {
 
 // Adds a sequence of export passes needed as a post-processing step for SDY
 // propagation.
+//
+// If `fuseExportPasses` is true, the passes that can be fused are replaced with
+// a single `FusedExportPass`.
+//
+// The module after export is saved to `dumpDirectory`, if not empty, according
+// to `saveModuleOpOptions`.
 void addExportPipeline(OpPassManager& pm, StringRef dumpDirectory = "",
-                       bool skipConvertToReshard = false);
+                       bool skipConvertToReshard = false,
+                       bool fuseExportPasses = false,
+                       const SaveModuleOpOptions& saveModuleOpOptions = {});
 
 // Register the sdy-export-pipeline.
 void registerExportPipeline();
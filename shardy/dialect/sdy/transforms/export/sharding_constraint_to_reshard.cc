@@ -18,12 +18,17 @@ limitations under the License.
 #include <utility>
 
 #include "mlir/Dialect/Func/IR/FuncOps.h"  // IWYU pragma: keep
+#include "mlir/IR/Attributes.h"
 #include "mlir/IR/PatternMatch.h"
+#include "mlir/IR/Value.h"
 #include "mlir/Pass/Pass.h"  // IWYU pragma: keep
 #include "mlir/Rewrite/FrozenRewritePatternSet.h"
+#include "mlir/Support/LLVM.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Transforms/DialectConversion.h"
+#include "shardy/dialect/sdy/ir/constants.h"
 #include "shardy/dialect/sdy/ir/dialect.h"
+#include "shardy/dialect/sdy/transforms/export/export_utils.h"
 
 namespace mlir {
 namespace sdy {
@@ -42,8 +47,7 @@ class ShardingConstraintPattern
   LogicalResult matchAndRewrite(
       ShardingConstraintOp op, OpAdaptor adaptor,
       ConversionPatternRewriter& rewriter) const override {
-    rewriter.replaceOpWithNewOp<ReshardOp>(op, adaptor.getInput())
-        .setShardingAttr(adaptor.getSharding());
+    replaceShardingConstraintWithReshard(op, adaptor.getInput(), rewriter);
     return success();
   }
 };
@@ -79,5 +83,23 @@ struct ShardingConstraintToReshardPass
 
 }  // namespace
 
+ReshardOp replaceShardingConstraintWithReshard(ShardingConstraintOp op,
+                                               Value input,
+                                               RewriterBase& rewriter) {
+  rewriter.setInsertionPoint(op);
+  auto reshardOp =
+      rewriter.create<ReshardOp>(op.getLoc(), input, op.getSharding());
+  // Keep the sharding origin debug attributes, which are only set if
+  // propagation ran with `debug-sharding-origins=true`, so that the reshard can
+  // be traced back to the sharding constraint.
+  for (StringRef attrName : {kOriginShardingAttr, kOriginShardingNameAttr}) {
+    if (Attribute attr = op->getDiscardableAttr(attrName)) {
+      reshardOp->setDiscardableAttr(attrName, attr);
+    }
+  }
+  rewriter.replaceOp(op, reshardOp);
+  return reshardOp;
+}
+
 }  // namespace sdy
 }  // namespace mlir
@@ -30,6 +30,7 @@ limitations under the License.
 #include "shardy/dialect/sdy/ir/data_flow_utils.h"
 #include "shardy/dialect/sdy/ir/dialect.h"
 #include "shardy/dialect/sdy/ir/utils.h"
+#include "shardy/dialect/sdy/transforms/export/export_utils.h"
 
 namespace mlir {
 namespace sdy {
@@ -100,20 +101,7 @@ struct SinkDataFlowEdgesPass
         rewriter.replaceOp(dataFlowEdgeOp, dataFlowEdgeOp.getInput());
         return WalkResult::skip();
       }
-      if (!isDataFlowOp(op)) {
-        return WalkResult::advance();
-      }
-      if (SmallVector<TensorShardingAttr> blockArgShardings =
-              getShardingsFromDataFlowEdges(
-                  getDataFlowEdgeBlockArgumentOwners(op));
-          !blockArgShardings.empty()) {
-        setBlockArgumentEdgeOwnerShardings(op, blockArgShardings);
-      }
-      if (SmallVector<TensorShardingAttr> resultShardings =
-              getShardingsFromDataFlowEdges(getDataFlowEdgeResultOwners(op));
-          !resultShardings.empty()) {
-        setOpResultEdgeOwnerShardings(op, resultShardings);
-      }
+      sinkDataFlowEdgeShardings(op);
       return WalkResult::advance();
     });
   }
@@ -121,5 +109,21 @@ struct SinkDataFlowEdgesPass
 
 }  // namespace
 
+void sinkDataFlowEdgeShardings(Operation* op) {
+  if (!isDataFlowOp(op)) {
+    return;
+  }
+  if (SmallVector<TensorShardingAttr> blockArgShardings =
+          getShardingsFromDataFlowEdges(getDataFlowEdgeBlockArgumentOwners(op));
+      !blockArgShardings.empty()) {
+    setBlockArgumentEdgeOwnerShardings(op, blockArgShardings);
+  }
+  if (SmallVector<TensorShardingAttr> resultShardings =
+          getShardingsFromDataFlowEdges(getDataFlowEdgeResultOwners(op));
+      !resultShardings.empty()) {
+    setOpResultEdgeOwnerShardings(op, resultShardings);
+  }
+}
+
 }  // namespace sdy
 }  // namespace mlir
@@ -1,4 +1,5 @@
 // RUN: sdy_opt %s -sdy-close-shardings | FileCheck %s
+// RUN: sdy_opt %s -sdy-fused-export='close-shardings=true' | FileCheck %s
 
 sdy.mesh @mesh = <["x"=4, "y"=2]>
 
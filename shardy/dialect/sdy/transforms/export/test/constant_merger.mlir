@@ -0,0 +1,71 @@
+// RUN: sdy_opt %s -sdy-constant-merger | FileCheck %s
+
+sdy.mesh @mesh = <["a"=2, "b"=2]>
+
+// CHECK-LABEL: func @merge_identical_constants
+func.func @merge_identical_constants(%arg0: tensor<8x16xf32>) -> (tensor<8x16xf32>, tensor<8x16xf32>) {
+  // CHECK-NEXT: %[[CONST:.*]] = sdy.constant {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a"}, {}]>]>} dense<1.000000e+00>
+  // CHECK-NEXT: %[[ADD_0:.*]] = stablehlo.add %[[CONST]], %arg0
+  // CHECK-NEXT: %[[ADD_1:.*]] = stablehlo.add %[[CONST]], %[[ADD_0]]
+  // CHECK-NEXT: return %[[ADD_0]], %[[ADD_1]]
+  %0 = sdy.constant {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a"}, {}]>]>} dense<1.000000e+00> : tensor<8x16xf32>
+  %1 = sdy.constant {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a"}, {}]>]>} dense<1.000000e+00> : tensor<8x16xf32>
+  %2 = stablehlo.add %0, %arg0 : tensor<8x16xf32>
+  %3 = stablehlo.add %1, %2 : tensor<8x16xf32>
+  return %2, %3 : tensor<8x16xf32>, tensor<8x16xf32>
+}
+
+// CHECK-LABEL: func @different_shardings_not_merged
+func.func @different_shardings_not_merged(%arg0: tensor<8x16xf32>) -> (tensor<8x16xf32>, tensor<8x16xf32>) {
+  // CHECK-NEXT: %[[CONST_0:.*]] = sdy.constant {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a"}, {}]>]>} dense<1.000000e+00>
+  // CHECK-NEXT: %[[CONST_1:.*]] = sdy.constant {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{}, {"b"}]>]>} dense<1.000000e+00>
+  // CHECK-NEXT: %[[CONST_2:.*]] = sdy.constant dense<1.000000e+00>
+  // CHECK-NEXT: %[[ADD_0:.*]] = stablehlo.add %[[CONST_0]], %arg0
+  // CHECK-NEXT: %[[ADD_1:.*]] = stablehlo.add %[[CONST_1]], %[[CONST_2]]
+  // CHECK-NEXT: return %[[ADD_0]], %[[ADD_1]]
+  %0 = sdy.constant {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a"}, {}]>]>} dense<1.000000e+00> : tensor<8x16xf32>
+  %1 = sdy.constant {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{}, {"b"}]>]>} dense<1.000000e+00> : tensor<8x16xf32>
+  %2 = sdy.constant dense<1.000000e+00> : tensor<8x16xf32>
+  %3 = stablehlo.add %0, %arg0 : tensor<8x16xf32>
+  %4 = stablehlo.add %1, %2 : tensor<8x16xf32>
+  return %3, %4 : tensor<8x16xf32>, tensor<8x16xf32>
+}
+
+// CHECK-LABEL: func @different_values_not_merged
+func.func @different_values_not_merged() -> (tensor<8x16xf32>, tensor<8x16xf32>) {
+  // CHECK-NEXT: %[[CONST_0:.*]] = sdy.constant dense<1.000000e+00>
+  // CHECK-NEXT: %[[CONST_1:.*]] = sdy.constant dense<2.000000e+00>
+  // CHECK-NEXT: return %[[CONST_0]], %[[CONST_1]]
+  %0 = sdy.constant dense<1.000000e+00> : tensor<8x16xf32>
+  %1 = sdy.constant dense<2.000000e+00> : tensor<8x16xf32>
+  return %0, %1 : tensor<8x16xf32>, tensor<8x16xf32>
+}
+
+// CHECK-LABEL: func @merge_identical_sub_computations
+func.func @merge_identical_sub_computations(%arg0: tensor<5x8xi32>) -> (tensor<4x8xi32>, tensor<4x8xi32>) {
+  // CHECK-NEXT: %[[IOTA:.*]] = stablehlo.iota dim = 0 {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a"}, {}]>]>}
+  // CHECK-NEXT: %[[CONST:.*]] = sdy.constant {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a"}, {}]>]>} dense<2>
+  // CHECK-NEXT: %[[MAX:.*]] = stablehlo.maximum %[[IOTA]], %[[CONST]] {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a"}, {}]>]>}
+  // CHECK-NEXT: %[[DOT_0:.*]] = stablehlo.dot_general %[[MAX]], %arg0
+  // CHECK-NEXT: %[[DOT_1:.*]] = stablehlo.dot_general %[[MAX]], %arg0
+  // CHECK-NEXT: return %[[DOT_0]], %[[DOT_1]]
+  %0 = stablehlo.iota dim = 0 {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a"}, {}]>]>} : tensor<4x5xi32>
+  %1 = stablehlo.iota dim = 0 {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a"}, {}]>]>} : tensor<4x5xi32>
+  %2 = sdy.constant {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a"}, {}]>]>} dense<2> : tensor<4x5xi32>
+  %3 = sdy.constant {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a"}, {}]>]>} dense<2> : tensor<4x5xi32>
+  %4 = stablehlo.maximum %0, %2 {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a"}, {}]>]>} : tensor<4x5xi32>
+  %5 = stablehlo.maximum %1, %3 {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a"}, {}]>]>} : tensor<4x5xi32>
+  %6 = stablehlo.dot_general %4, %arg0, contracting_dims = [1] x [0] : (tensor<4x5xi32>, tensor<5x8xi32>) -> tensor<4x8xi32>
+  %7 = stablehlo.dot_general %5, %arg0, contracting_dims = [1] x [0] : (tensor<4x5xi32>, tensor<5x8xi32>) -> tensor<4x8xi32>
+  return %6, %7 : tensor<4x8xi32>, tensor<4x8xi32>
+}
+
+// CHECK-LABEL: func @non_constant_ops_not_merged
+func.func @non_constant_ops_not_merged(%arg0: tensor<8x16xf32>) -> (tensor<8x16xf32>, tensor<8x16xf32>) {
+  // CHECK-NEXT: %[[ADD_0:.*]] = stablehlo.add %arg0, %arg0
+  // CHECK-NEXT: %[[ADD_1:.*]] = stablehlo.add %arg0, %arg0
+  // CHECK-NEXT: return %[[ADD_0]], %[[ADD_1]]
+  %0 = stablehlo.add %arg0, %arg0 : tensor<8x16xf32>
+  %1 = stablehlo.add %arg0, %arg0 : tensor<8x16xf32>
+  return %0, %1 : tensor<8x16xf32>, tensor<8x16xf32>
+}
@@ -1,4 +1,5 @@
 // RUN: sdy_opt %s -sdy-drop-sharding-rules | FileCheck %s
+// RUN: sdy_opt %s -sdy-fused-export='drop-sharding-rules=true' | FileCheck %s
 
 sdy.mesh @mesh = <["x"=4, "y"=2]>
 
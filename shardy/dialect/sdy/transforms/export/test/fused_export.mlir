@@ -0,0 +1,28 @@
+// RUN: sdy_opt %s -sdy-fused-export='close-shardings=true drop-sharding-rules=true' | FileCheck %s
+// RUN: sdy_opt %s -sdy-fused-export='convert-to-reshard=false' | FileCheck %s --check-prefix=NO-RESHARD
+
+sdy.mesh @mesh = <["a"=2, "b"=2]>
+
+// CHECK-LABEL: func @all_export_steps
+// CHECK-SAME:    %arg0: tensor<6x8xf32> {sdy.sharding = #sdy.sharding<@mesh, [{"a"}, {}]>}
+// CHECK-SAME:    -> (tensor<6x8xf32> {sdy.sharding = #sdy.sharding<@mesh, [{}, {"a"}]>})
+func.func @all_export_steps(%arg0: tensor<6x8xf32> {sdy.sharding = #sdy.sharding<@mesh, [{"a", "b"}, {?}]>})
+    -> (tensor<6x8xf32> {sdy.sharding = #sdy.sharding<@mesh, [{}, {"a", ?}], replicated={"b"}>}) {
+  // CHECK-NEXT: %[[OPT_BARRIER:.*]] = stablehlo.optimization_barrier
+  // CHECK-SAME:   {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{}, {"b"}]>]>} %arg0
+  // CHECK-NEXT: %[[RESHARD:.*]] = sdy.reshard %[[OPT_BARRIER]] <@mesh, [{}, {"a"}]>
+  // CHECK-NEXT: %[[ADD:.*]] = stablehlo.add %[[RESHARD]], %[[RESHARD]]
+  // CHECK-SAME:   {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{}, {"a"}]>]>}
+  // CHECK-NOT:    sdy.sharding_rule
+  // CHECK-NEXT: return %[[ADD]]
+  //
+  // NO-RESHARD-NOT: sdy.sharding_group
+  // NO-RESHARD-NOT: sdy.data_flow_edge
+  // NO-RESHARD:     sdy.sharding_constraint
+  %0 = stablehlo.optimization_barrier %arg0 : tensor<6x8xf32>
+  %1 = sdy.data_flow_edge %0 sharding=<@mesh, [{}, {"b", ?}]> : tensor<6x8xf32>
+  sdy.sharding_group %1 group_id = 0 : tensor<6x8xf32>
+  %2 = sdy.sharding_constraint %1 <@mesh, [{}, {"a", ?}]> : tensor<6x8xf32>
+  %3 = stablehlo.add %2, %2 {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{?}, {"a", ?}]>]>, sdy.sharding_rule = #sdy.op_sharding_rule<([i, j],[i, j])->([i, j]) {i=6, j=8}>} : tensor<6x8xf32>
+  return %3 : tensor<6x8xf32>
+}
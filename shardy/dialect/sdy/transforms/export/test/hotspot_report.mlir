@@ -0,0 +1,26 @@
+// RUN: sdy_opt %s -sdy-hotspot-report="num-entries=3 emit-remarks=true" 2>&1 | FileCheck %s
+
+sdy.mesh @mesh = <["x"=4]>
+
+// CHECK: remark: hotspot reshard #1 of 512 bytes from no sharding to #sdy.sharding<@mesh, [{"x"}, {}]>, caused by unknown
+// CHECK: remark: hotspot reshard #2 of 256 bytes from #sdy.sharding<@mesh, [{"x"}, {}]> to #sdy.sharding<@mesh, [{}, {"x"}]>, caused by user sharding constraint constraint_0
+// CHECK: remark: hotspot reshard #3 of 128 bytes from #sdy.sharding<@mesh, [{}, {"x"}]> to #sdy.sharding<@mesh, [{"x"}, {}]>, caused by sharding conflict between origins [input: 0] of the operand and [output: 0] of the result
+// CHECK: remark: hotspot replicated tensor #1: @main input 1 of 1024 bytes, no sharded neighbors
+// CHECK: remark: hotspot replicated tensor #2: stablehlo.slice result 0 of 512 bytes, sharded neighbors: sdy.reshard result 0 #sdy.sharding<@mesh, [{"x"}, {}]>
+// CHECK-NOT: remark: hotspot
+// CHECK-LABEL: func @main
+func.func @main(%arg0: tensor<8x8xf32> {sdy.sharding = #sdy.sharding<@mesh, [{"x"}, {}]>},
+                %arg1: tensor<16x16xf32>) -> (tensor<8x8xf32>, tensor<8x16xf32>) {
+  %0 = sdy.reshard %arg0 <@mesh, [{}, {"x"}]> {sdy.origin_sharding_name = "constraint_0"} : tensor<8x8xf32>
+  %1 = stablehlo.slice %arg1 [0:8, 0:16] : (tensor<16x16xf32>) -> tensor<8x16xf32>
+  %2 = sdy.reshard %1 <@mesh, [{"x"}, {}]> : tensor<8x16xf32>
+  %3 = stablehlo.negate %2 {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"x"}, {}]>]>} : tensor<8x16xf32>
+  return %0, %3 : tensor<8x8xf32>, tensor<8x16xf32>
+}
+
+// CHECK-LABEL: func @origins
+func.func @origins(%arg0: tensor<4x8xf32> {sdy.sharding = #sdy.sharding<@mesh, [{}, {"x"}]>, sdy.origin_sharding = {x = "input: 0"}}) -> tensor<4x8xf32> {
+  %0 = sdy.reshard %arg0 <@mesh, [{"x"}, {}]> : tensor<4x8xf32>
+  %1 = stablehlo.negate %0 {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"x"}, {}]>]>, sdy.origin_sharding = {x = "output: 0"}} : tensor<4x8xf32>
+  return %1 : tensor<4x8xf32>
+}
@@ -1,4 +1,5 @@
 // RUN: sdy_opt %s -sdy-remove-sharding-groups | FileCheck %s
+// RUN: sdy_opt %s -sdy-fused-export | FileCheck %s
 
 // CHECK-LABEL: func @sharding_group_ops
 func.func @sharding_group_ops(%arg0: tensor<32x96xf32>) -> tensor<32x96xf32> {
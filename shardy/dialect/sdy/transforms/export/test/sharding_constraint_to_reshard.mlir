@@ -1,4 +1,5 @@
 // RUN: sdy_opt %s -sdy-sharding-constraint-to-reshard | FileCheck %s
+// RUN: sdy_opt %s -sdy-fused-export | FileCheck %s
 
 sdy.mesh @mesh = <["a"=2, "b"=2]>
 
@@ -8,3 +9,10 @@ func.func @sharding_constraint_to_reshard(%arg0: tensor<8x8xf32>) -> tensor<8x8x
   %0 = sdy.sharding_constraint %arg0 <@mesh, [{"a"}, {?}]> :  tensor<8x8xf32>
   return %0 : tensor<8x8xf32>
 }
+
+// CHECK-LABEL: func @keeps_only_sharding_origin_attrs
+func.func @keeps_only_sharding_origin_attrs(%arg0: tensor<8x8xf32>) -> tensor<8x8xf32> {
+  // CHECK: %0 = sdy.reshard %arg0 <@mesh, [{"a"}, {?}]> {sdy.origin_sharding_name = "constraint_0"} : tensor<8x8xf32>
+  %0 = sdy.sharding_constraint %arg0 <@mesh, [{"a"}, {?}]> {foo = "bar", sdy.origin_sharding_name = "constraint_0"} :  tensor<8x8xf32>
+  return %0 : tensor<8x8xf32>
+}
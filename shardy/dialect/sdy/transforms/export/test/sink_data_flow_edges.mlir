@@ -1,4 +1,5 @@
 // RUN: sdy_opt %s -sdy-sink-data-flow-edges | FileCheck %s
+// RUN: sdy_opt %s -sdy-fused-export | FileCheck %s
 
 sdy.mesh @mesh = <["a"=2, "b"=2, "c"=2]>
 sdy.mesh @other_mesh = <["c"=4]>
@@ -1,4 +1,5 @@
 // RUN: sdy_opt %s -sdy-update-non-divisible-input-output-shardings | FileCheck %s
+// RUN: sdy_opt %s -sdy-fused-export | FileCheck %s
 
 sdy.mesh @mesh_x_4_y_2 = <["x"=4, "y"=2]>
 sdy.mesh @mesh_x_8_y_3 = <["x"=8, "y"=3]>
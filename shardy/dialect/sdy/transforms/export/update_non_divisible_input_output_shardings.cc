@@ -33,6 +33,7 @@ limitations under the License.
 #include "shardy/dialect/sdy/ir/constants.h"
 #include "shardy/dialect/sdy/ir/dialect.h"
 #include "shardy/dialect/sdy/ir/utils.h"
+#include "shardy/dialect/sdy/transforms/export/export_utils.h"
 
 namespace mlir {
 namespace sdy {
@@ -143,27 +144,30 @@ struct UpdateNonDivisibleInputOutputShardingsPass
       UpdateNonDivisibleInputOutputShardingsPassBase;
 
   void runOnOperation() final {
-    func::FuncOp funcOp = getOperation();
-    // Update arguments.
-    updateValueShardings(
-        funcOp.getArgumentTypes(),
-        [&](int64_t index) { return getSharding(funcOp.getArgument(index)); },
-        [&](int64_t index, TensorShardingAttr sharding) {
-          setSharding(funcOp.getArgument(index), sharding);
-        },
-        funcOp);
-    // Update results.
-    updateValueShardings(
-        funcOp.getResultTypes(),
-        [&](int64_t index) { return getFuncResultSharding(funcOp, index); },
-        [&](int64_t index, TensorShardingAttr sharding) {
-          setFuncResultSharding(funcOp, index, sharding);
-        },
-        funcOp);
+    updateNonDivisibleInputOutputShardings(getOperation());
   }
 };
 
 }  // namespace
 
+void updateNonDivisibleInputOutputShardings(func::FuncOp funcOp) {
+  // Update arguments.
+  updateValueShardings(
+      funcOp.getArgumentTypes(),
+      [&](int64_t index) { return getSharding(funcOp.getArgument(index)); },
+      [&](int64_t index, TensorShardingAttr sharding) {
+        setSharding(funcOp.getArgument(index), sharding);
+      },
+      funcOp);
+  // Update results.
+  updateValueShardings(
+      funcOp.getResultTypes(),
+      [&](int64_t index) { return getFuncResultSharding(funcOp, index); },
+      [&](int64_t index, TensorShardingAttr sharding) {
+        setFuncResultSharding(funcOp, index, sharding);
+      },
+      funcOp);
+}
+
 }  // namespace sdy
 }  // namespace mlir
@@ -27,6 +27,7 @@ limitations under the License.
 #include "shardy/dialect/sdy/ir/data_flow_utils.h"
 #include "shardy/dialect/sdy/ir/dialect.h"
 #include "shardy/dialect/sdy/ir/utils.h"
+#include "shardy/dialect/sdy/transforms/import/import_utils.h"
 
 namespace mlir {
 namespace sdy {
@@ -36,35 +37,41 @@ namespace sdy {
 
 namespace {
 
+void addDataFlowEdgesForOwners(ValueRange edgeOwners, IRRewriter& rewriter) {
+  // We are iterating the owners in a reversed order because we set the
+  // insertion point after each value and we would like to keep the data flow
+  // edges for the arguments/results in the same order as they appear.
+  for (Value edgeOwner : llvm::reverse(edgeOwners)) {
+    rewriter.setInsertionPointAfterValue(edgeOwner);
+    if (!isStaticShapedType(edgeOwner.getType())) {
+      // Skip non-static-shaped tensors, e.g., tokens.
+      continue;
+    }
+    auto dataFlowEdge = rewriter.create<DataFlowEdgeOp>(
+        edgeOwner.getLoc(), edgeOwner, getSharding(edgeOwner));
+    rewriter.replaceAllUsesExcept(edgeOwner, dataFlowEdge, dataFlowEdge);
+  }
+}
+
+}  // namespace
+
+void addDataFlowEdges(Operation* op, IRRewriter& rewriter) {
+  // Add the data flow edges for result owners and block argument owners.
+  addDataFlowEdgesForOwners(getDataFlowEdgeResultOwners(op), rewriter);
+  addDataFlowEdgesForOwners(getDataFlowEdgeBlockArgumentOwners(op), rewriter);
+}
+
+namespace {
+
 struct AddDataFlowEdgesPass
     : public impl::AddDataFlowEdgesPassBase<AddDataFlowEdgesPass> {
   using AddDataFlowEdgesPassBase::AddDataFlowEdgesPassBase;
 
-  void addDataFlowEdges(ValueRange edgeOwners, IRRewriter& rewriter) {
-    // We are iterating the owners in a reversed order because we set the
-    // insertion point after each value and we would like to keep the data flow
-    // edges for the arguments/results in the same order as they appear.
-    for (Value edgeOwner : llvm::reverse(edgeOwners)) {
-      rewriter.setInsertionPointAfterValue(edgeOwner);
-      if (!isStaticShapedType(edgeOwner.getType())) {
-        // Skip non-static-shaped tensors, e.g., tokens.
-        continue;
-      }
-      auto dataFlowEdge = rewriter.create<DataFlowEdgeOp>(
-          edgeOwner.getLoc(), edgeOwner, getSharding(edgeOwner));
-      rewriter.replaceAllUsesExcept(edgeOwner, dataFlowEdge, dataFlowEdge);
-    }
-  }
-
   void runOnOperation() final {
     func::FuncOp funcOp = getOperation();
     IRRewriter rewriter(funcOp);
 
-    funcOp.walk([&](Operation* op) {
-      // Add the data flow edges for result owners and block argument owners.
-      addDataFlowEdges(getDataFlowEdgeResultOwners(op), rewriter);
-      addDataFlowEdges(getDataFlowEdgeBlockArgumentOwners(op), rewriter);
-    });
+    funcOp.walk([&](Operation* op) { addDataFlowEdges(op, rewriter); });
   }
 };
 
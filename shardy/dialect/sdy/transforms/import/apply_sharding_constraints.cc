@@ -22,8 +22,10 @@ limitations under the License.
 #include "mlir/IR/Value.h"
 #include "mlir/Pass/Pass.h"  // IWYU pragma: keep
 #include "mlir/Support/LLVM.h"
+#include "shardy/dialect/sdy/ir/data_flow_utils.h"
 #include "shardy/dialect/sdy/ir/dialect.h"
 #include "shardy/dialect/sdy/ir/utils.h"
+#include "shardy/dialect/sdy/transforms/import/import_utils.h"
 
 namespace mlir {
 namespace sdy {
@@ -65,8 +67,11 @@ bool isUsedByOtherShardingConstraint(
 // Returns true if `input` should have its sharding set to `sharding` of the
 // sharding constraint `op`.
 bool shouldApply(Value input, TensorShardingAttr sharding, Operation* op) {
-  if (getSharding(input) || input.getDefiningOp<DataFlowEdgeOp>()) {
-    // `input` already has a sharding or is produced by a `DataFlowEdgeOp`.
+  if (getSharding(input) || input.getDefiningOp<DataFlowEdgeOp>() ||
+      getDataFlowEdgeOwner(input) == input) {
+    // `input` already has a sharding, or is produced by a `DataFlowEdgeOp`, or
+    // is the owner of a data-flow edge without a `DataFlowEdgeOp` (in which
+    // case it holds the sharding of all targets of the edge).
     return false;
   }
 
@@ -123,56 +128,59 @@ ShardingConstraintOp getFirstShardingConstraintInChain(
   return prevShardingConstraintOp;
 }
 
+}  // namespace
+
+void applyShardingConstraints(Operation* op) {
+  TypeSwitch<Operation*>(op)
+      .Case<ShardingConstraintOp>(
+          [](ShardingConstraintOp shardingConstraintOp) {
+            Value input = shardingConstraintOp.getInput();
+            TensorShardingAttr sharding = shardingConstraintOp.getSharding();
+            if (shouldApply(input, sharding, shardingConstraintOp)) {
+              setSharding(input, sharding);
+            }
+
+            // If `shardingConstraintOp` is the last op in a chain of at least
+            // two sharding constraints, and the input of the chain isn't used
+            // by any other sharding constraint, then replace all uses of the
+            // input that are defined after `shardingConstraintOp` (and in the
+            // same block) with the latter.
+            // TODO(b/377454801): reconsider this logic.
+            if (ShardingConstraintOp firstInChain =
+                    getFirstShardingConstraintInChain(shardingConstraintOp);
+                firstInChain && firstInChain != shardingConstraintOp &&
+                !isUsedByOtherShardingConstraint(firstInChain.getInput(),
+                                                 firstInChain)) {
+              firstInChain.getInput().replaceUsesWithIf(
+                  shardingConstraintOp.getResult(), [&](OpOperand& use) {
+                    return use.getOwner() != firstInChain &&
+                           shardingConstraintOp->getBlock() ==
+                               use.getOwner()->getBlock() &&
+                           shardingConstraintOp->isBeforeInBlock(
+                               use.getOwner());
+                  });
+            }
+          })
+      .Case<ManualComputationOp>([](ManualComputationOp manualComputationOp) {
+        for (auto [operand, sharding] : llvm::zip_equal(
+                 manualComputationOp.getOperands(),
+                 manualComputationOp.getInShardings().getShardings())) {
+          if (shouldApply(operand, sharding, manualComputationOp)) {
+            setSharding(operand, sharding);
+          }
+        }
+      });
+}
+
+namespace {
+
 struct ApplyShardingConstraintsPass
     : public impl::ApplyShardingConstraintsPassBase<
           ApplyShardingConstraintsPass> {
   using ApplyShardingConstraintsPassBase::ApplyShardingConstraintsPassBase;
 
   void runOnOperation() final {
-    getOperation().walk([](Operation* op) {
-      TypeSwitch<Operation*>(op)
-          .Case<ShardingConstraintOp>(
-              [](ShardingConstraintOp shardingConstraintOp) {
-                Value input = shardingConstraintOp.getInput();
-                TensorShardingAttr sharding =
-                    shardingConstraintOp.getSharding();
-                if (shouldApply(input, sharding, shardingConstraintOp)) {
-                  setSharding(input, sharding);
-                }
-
-                // If `shardingConstraintOp` is the last op in a chain of at
-                // least two sharding constraints, and the input of the chain
-                // isn't used by any other sharding constraint, then replace
-                // all uses of the input that are defined after
-                // `shardingConstraintOp` (and in the same block) with the
-                // latter.
-                // TODO(b/377454801): reconsider this logic.
-                if (ShardingConstraintOp firstInChain =
-                        getFirstShardingConstraintInChain(shardingConstraintOp);
-                    firstInChain && firstInChain != shardingConstraintOp &&
-                    !isUsedByOtherShardingConstraint(firstInChain.getInput(),
-                                                     firstInChain)) {
-                  firstInChain.getInput().replaceUsesWithIf(
-                      shardingConstraintOp.getResult(), [&](OpOperand& use) {
-                        return use.getOwner() != firstInChain &&
-                               shardingConstraintOp->getBlock() ==
-                                   use.getOwner()->getBlock() &&
-                               shardingConstraintOp->isBeforeInBlock(
-                                   use.getOwner());
-                      });
-                }
-              })
-          .Case<ManualComputationOp>(
-              [](ManualComputationOp manualComputationOp) {
-                for (auto [operand, sharding] : llvm::zip_equal(
-                         manualComputationOp.getOperands(),
-                         manualComputationOp.getInShardings().getShardings())) {
-                  if (shouldApply(operand, sharding, manualComputationOp)) {
-                    setSharding(operand, sharding);
-                  }
-                }
-              });
-    });
+    getOperation().walk([](Operation* op) { applyShardingConstraints(op); });
   }
 };
 
@@ -0,0 +1,148 @@
+/* Copyright 2024 The Shardy Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>  // IWYU pragma: keep
+#include <optional>
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/IR/Threading.h"
+#include "mlir/Pass/Pass.h"  // IWYU pragma: keep
+#include "mlir/Support/LLVM.h"
+#include "shardy/dialect/sdy/ir/dialect.h"
+#include "shardy/dialect/sdy/transforms/common/sharding_walker.h"
+#include "shardy/dialect/sdy/transforms/import/import_utils.h"
+
+namespace mlir {
+namespace sdy {
+
+#define GEN_PASS_DEF_CANONICALIZESHARDINGSPASS
+#include "shardy/dialect/sdy/transforms/import/passes.h.inc"
+
+namespace {
+
+// Appends `axisRef` to `axisRefs`, or merges it with the last axis-ref in
+// `axisRefs` if they are consecutive sub-axes of the same full axis. A sub-axis
+// that spans the entire full axis is replaced with the full axis.
+void addOrMergeAxisRef(SmallVector<AxisRefAttr>& axisRefs, AxisRefAttr axisRef,
+                       MeshAttr mesh) {
+  if (!axisRefs.empty() && axisRefs.back().canMerge(axisRef)) {
+    axisRefs.back() = axisRefs.back().merge(axisRef, mesh);
+    return;
+  }
+  if (SubAxisInfoAttr subAxisInfo = axisRef.getSubAxisInfo();
+      subAxisInfo && subAxisInfo.getPreSize() == 1 &&
+      subAxisInfo.getSize() == mesh.getAxisSize(axisRef.getName())) {
+    axisRef = AxisRefAttr::get(axisRef.getContext(), axisRef.getName());
+  }
+  axisRefs.push_back(axisRef);
+}
+
+// Returns `axisRefs` with consecutive sub-axes of the same full axis merged,
+// or `std::nullopt` if nothing was merged.
+std::optional<SmallVector<AxisRefAttr>> mergeSubAxes(
+    ArrayRef<AxisRefAttr> axisRefs, MeshAttr mesh) {
+  SmallVector<AxisRefAttr> newAxisRefs;
+  for (AxisRefAttr axisRef : axisRefs) {
+    addOrMergeAxisRef(newAxisRefs, axisRef, mesh);
+  }
+  if (ArrayRef<AxisRefAttr>(newAxisRefs) == axisRefs) {
+    return std::nullopt;
+  }
+  return newAxisRefs;
+}
+
+}  // namespace
+
+TensorShardingAttr canonicalizeSharding(TensorShardingAttr sharding,
+                                        const SymbolTable& symbolTable) {
+  MeshAttr mesh = sharding.getMesh(symbolTable);
+  if (!mesh || mesh.isMaximal() ||
+      sharding.anyOfAxisRef([&](AxisRefAttr axisRef) {
+        return !mesh.hasAxis(axisRef.getName());
+      })) {
+    // Left for the verifier to report.
+    return sharding;
+  }
+  MLIRContext* context = sharding.getContext();
+  bool modified = false;
+
+  SmallVector<DimensionShardingAttr> newDimShardings(
+      sharding.getDimShardings());
+  for (DimensionShardingAttr& dimSharding : newDimShardings) {
+    if (std::optional<SmallVector<AxisRefAttr>> newAxes =
+            mergeSubAxes(dimSharding.getAxes(), mesh)) {
+      dimSharding = DimensionShardingAttr::get(context, *newAxes,
+                                               dimSharding.getIsClosed(),
+                                               dimSharding.getPriority());
+      modified = true;
+    }
+  }
+
+  // Sorting the replicated axes first brings sub-axes of the same full axis
+  // next to each other, so they can be merged, and identical axes next to
+  // each other, so they can be deduped.
+  ArrayRef<AxisRefAttr> replicatedAxes = sharding.getReplicatedAxes();
+  auto meshComparator = AxisRefAttr::getMeshComparator(mesh);
+  SmallVector<AxisRefAttr> sortedReplicatedAxes(replicatedAxes);
+  llvm::sort(sortedReplicatedAxes, meshComparator);
+  SmallVector<AxisRefAttr> newReplicatedAxes;
+  for (AxisRefAttr axisRef : sortedReplicatedAxes) {
+    if (newReplicatedAxes.empty() || newReplicatedAxes.back() != axisRef) {
+      addOrMergeAxisRef(newReplicatedAxes, axisRef, mesh);
+    }
+  }
+  modified |= ArrayRef<AxisRefAttr>(newReplicatedAxes) != replicatedAxes;
+
+  if (!modified) {
+    return sharding;
+  }
+  return TensorShardingAttr::get(context, sharding.getMeshOrRef(),
+                                 newDimShardings, newReplicatedAxes);
+}
+
+namespace {
+
+struct CanonicalizeShardingsPass
+    : public impl::CanonicalizeShardingsPassBase<CanonicalizeShardingsPass> {
+  using CanonicalizeShardingsPassBase::CanonicalizeShardingsPassBase;
+
+  void runOnOperation() final {
+    ModuleOp moduleOp = getOperation();
+    SymbolTable symbolTable(moduleOp);
+    // Ops in the module other than meshes (e.g. functions) are independent,
+    // and the symbol table is only read, so we canonicalize them in parallel.
+    SmallVector<Operation*> rootOps;
+    for (Operation& op : moduleOp.getOps()) {
+      if (!isa<MeshOp>(op)) {
+        rootOps.push_back(&op);
+      }
+    }
+    parallelForEach(moduleOp.getContext(), rootOps, [&](Operation* rootOp) {
+      transformShardings(rootOp, [&](TensorShardingAttr sharding) {
+        return canonicalizeSharding(sharding, symbolTable);
+      });
+    });
+  }
+};
+
+}  // namespace
+
+}  // namespace sdy
+}  // namespace mlir
@@ -17,7 +17,10 @@ limitations under the License.
 #include <memory>  // IWYU pragma: keep
 #include <utility>
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallVector.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinAttributes.h"
@@ -25,13 +28,15 @@ limitations under the License.
 #include "mlir/IR/Operation.h"
 #include "mlir/IR/PatternMatch.h"
 #include "mlir/IR/Value.h"
-#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/IR/Visitors.h"
 #include "mlir/Pass/Pass.h"  // IWYU pragma: keep
 #include "mlir/Rewrite/FrozenRewritePatternSet.h"
 #include "mlir/Support/LLVM.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Transforms/DialectConversion.h"
+#include "shardy/dialect/sdy/ir/constants.h"
 #include "shardy/dialect/sdy/ir/dialect.h"
+#include "shardy/dialect/sdy/ir/utils.h"
 #include "shardy/dialect/sdy/transforms/common/op_properties.h"
 #include "stablehlo/dialect/StablehloOps.h"
 
@@ -62,23 +67,6 @@ void eraseShardingGroupUsers(Operation* op) {
   }
 }
 
-// Returns true if the given op is either:
-// - A constant or iota op.
-// - A broadcast, slice, or pure element-wise op whose operands are all
-// constants (exist in `constantOps`).
-bool isConstantExpression(Operation* op,
-                          const llvm::SetVector<Operation*>& constantOps) {
-  if (isa<ConstantOp, stablehlo::IotaOp>(op)) {
-    return true;
-  }
-  return (isa<stablehlo::BroadcastInDimOp, stablehlo::SliceOp>(op) ||
-          isElementwise(op)) &&
-         isPure(op) && llvm::all_of(op->getOperands(), [&](Value operand) {
-           return operand.getDefiningOp() &&
-                  constantOps.contains(operand.getDefiningOp());
-         });
-}
-
 // Recursively clones all operands of the given op, that are not already mapped
 // in `mapping`, and finally clones the op itself.
 void cloneSubComputation(OpResult opResult, IRMapping& mapping) {
@@ -109,6 +97,52 @@ Value cloneSubComputation(OpResult opResult) {
   return mapping.lookup(opResult);
 }
 
+// Returns true if a value in the sub-computation whose root is `op` is used by
+// a `ShardingGroupOp`.
+//
+// `cache` holds the result for ops that were already visited.
+bool hasShardingGroupUsers(Operation* op,
+                           llvm::DenseMap<Operation*, bool>& cache) {
+  if (auto it = cache.find(op); it != cache.end()) {
+    return it->second;
+  }
+  bool result =
+      llvm::any_of(
+          op->getUsers(),
+          [](Operation* user) { return isa<ShardingGroupOp>(user); }) ||
+      llvm::any_of(op->getOperands(), [&](Value operand) {
+        Operation* defOp = operand.getDefiningOp();
+        return defOp && hasShardingGroupUsers(defOp, cache);
+      });
+  cache[op] = result;
+  return result;
+}
+
+// Returns true if `op` is a marker for a deferred use of a constant
+// sub-computation.
+bool isDeferredSplitMarker(Operation* op) {
+  auto barrierOp = dyn_cast<PropagationBarrierOp>(op);
+  return barrierOp && barrierOp->hasAttr(kDeferredConstantSplitAttr);
+}
+
+// Creates a marker for the use of the constant sub-computation whose root is
+// `opResult` by `user`, right before `user`.
+//
+// The marker doesn't allow propagating shardings through it, so the use gets
+// its own sharding in isolation, without cloning the sub-computation. The
+// marker starts with the sharding of the root, if any, so that a user sharding
+// of the constant still reaches the use, as it would through a clone.
+Value createDeferredSplitMarker(OpResult opResult, Operation* user) {
+  OpBuilder builder(user);
+  auto markerOp = builder.create<PropagationBarrierOp>(
+      opResult.getLoc(), opResult, PropagationDirection::NONE);
+  markerOp->setAttr(kDeferredConstantSplitAttr, builder.getUnitAttr());
+  if (TensorShardingAttr sharding = getSharding(opResult)) {
+    setSharding(markerOp.getResult(), sharding);
+  }
+  return markerOp.getResult();
+}
+
 // Converts stablehlo::ConstantOp to sdy::ConstantOp.
 class ConstantPattern : public OpConversionPattern<stablehlo::ConstantOp> {
   using OpConversionPattern::OpConversionPattern;
@@ -151,8 +185,9 @@ struct ConstantSplitterPass
 
     // Then we split constant sub-computations for each non-constant user.
     llvm::SetVector<Operation*> constantOps;
+    llvm::DenseMap<Operation*, bool> hasShardingGroupUsersCache;
     funcOp.walk([&](Operation* op) {
-      if (isa<ShardingGroupOp>(op)) {
+      if (isa<ShardingGroupOp>(op) || isDeferredSplitMarker(op)) {
         return;
       }
       if (isConstantExpression(op, constantOps)) {
@@ -167,16 +202,35 @@ struct ConstantSplitterPass
           // and replace the `operand` with the cloned defining op. The cloned
           // constant sub-computation has only one user `op`, so that it is
           // isolated from the rest of the computation.
-          operand.set(cloneSubComputation(defOpResult));
+          //
+          // If splitting is deferred, we instead isolate the use with a marker,
+          // and only clone the sub-computation after propagation, once for
+          // each distinct sharding of its uses. A root with a single use is
+          // already isolated, so it doesn't need a marker.
+          if (deferSplitting &&
+              !hasShardingGroupUsers(defOpResult.getOwner(),
+                                     hasShardingGroupUsersCache)) {
+            if (!defOpResult.hasOneUse()) {
+              operand.set(createDeferredSplitMarker(defOpResult, op));
+            }
+          } else {
+            operand.set(cloneSubComputation(defOpResult));
+          }
         }
       }
     });
 
     // Since for every op in `constantOps` that has a use that isn't in
     // `constantOps`, we replaced the use with a clone of the entire
-    // sub-computation, we can now erase all ops in `constantOps` as long as we
-    // iterate in reverse order.
+    // sub-computation or a marker (unless it's the only use), we can now erase
+    // all ops in `constantOps` that are only used by sharding groups, as long
+    // as we iterate in reverse order.
     for (Operation* op : llvm::reverse(constantOps)) {
+      if (llvm::any_of(op->getUsers(), [](Operation* user) {
+            return !isa<ShardingGroupOp>(user);
+          })) {
+        continue;
+      }
       eraseShardingGroupUsers(op);
       op->erase();
     }
@@ -0,0 +1,107 @@
+/* Copyright 2024 The Shardy Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>  // IWYU pragma: keep
+
+#include "llvm/ADT/SmallVector.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/IR/Threading.h"
+#include "mlir/IR/Visitors.h"
+#include "mlir/Pass/Pass.h"  // IWYU pragma: keep
+#include "mlir/Support/LLVM.h"
+#include "shardy/dialect/sdy/ir/dialect.h"
+#include "shardy/dialect/sdy/transforms/common/sharding_walker.h"
+#include "shardy/dialect/sdy/transforms/import/import_utils.h"
+
+namespace mlir {
+namespace sdy {
+
+#define GEN_PASS_DEF_FUSEDIMPORTPASS
+#include "shardy/dialect/sdy/transforms/import/passes.h.inc"
+
+namespace {
+
+struct FusedImportPass : public impl::FusedImportPassBase<FusedImportPass> {
+  using FusedImportPassBase::FusedImportPassBase;
+
+  void runOnOperation() final {
+    ModuleOp moduleOp = getOperation();
+    MLIRContext* context = moduleOp.getContext();
+    SymbolTable symbolTable(moduleOp);
+    MeshLifter meshLifter(moduleOp, symbolTable);
+
+    // Ops in the module other than meshes (e.g. functions) are independent, so
+    // after creating the `MeshOp`s for their inlined meshes, each of them is
+    // imported on its own thread.
+    SmallVector<Operation*> rootOps;
+    for (Operation& op : moduleOp.getOps()) {
+      if (!isa<MeshOp>(op)) {
+        rootOps.push_back(&op);
+      }
+    }
+    meshLifter.addInlinedMeshes(rootOps);
+
+    bool hasMeshesToReplace = meshLifter.hasMeshesToReplace();
+    parallelForEach(context, rootOps, [&](Operation* rootOp) {
+      IRRewriter rewriter(context);
+      // The data flow edges of an op are inserted after it (or at the start of
+      // its blocks), and have the same sharding as their owner, which was
+      // already lifted, so it doesn't matter that the walk skips the edges
+      // after it.
+      rootOp->walk<WalkOrder::PreOrder>([&](Operation* op) {
+        if (hasMeshesToReplace) {
+          transformOpShardings(op, [&](TensorShardingAttr sharding) {
+            return meshLifter.getLiftedSharding(sharding);
+          });
+        }
+        if (auto manualComputationOp = dyn_cast<ManualComputationOp>(op)) {
+          cleanupManualAxes(manualComputationOp, symbolTable);
+        }
+        if (!implicitDataFlowEdges) {
+          addDataFlowEdges(op, rewriter);
+        }
+      });
+      rootOp->walk([&](Operation* op) { applyShardingConstraints(op); });
+    });
+
+    // Sharding groups are unified across the entire module, so they are
+    // collected serially, after applying all sharding constraints.
+    ShardingGroupImporter shardingGroupImporter;
+    if (moduleOp
+            .walk([&](ShardingGroupOp shardingGroupOp) {
+              if (failed(shardingGroupImporter.addShardingGroup(
+                      shardingGroupOp))) {
+                return WalkResult::interrupt();
+              }
+              return WalkResult::advance();
+            })
+            .wasInterrupted()) {
+      signalPassFailure();
+      return;
+    }
+    if (failed(shardingGroupImporter.unifyAndApplyShardings())) {
+      signalPassFailure();
+    }
+  }
+};
+
+}  // namespace
+
+}  // namespace sdy
+}  // namespace mlir
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include "llvm/Support/CommandLine.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Pass/PassRegistry.h"
@@ -25,23 +26,42 @@ limitations under the License.
 namespace mlir {
 namespace sdy {
 
-void addImportPipeline(OpPassManager& pm, StringRef dumpDirectory) {
-  pm.addPass(mlir::sdy::createSaveModuleOpPass(dumpDirectory,
-                                               "sdy_module_before_sdy_import"));
+void addImportPipeline(OpPassManager& pm, const ImportOptions& options) {
+  // The pass manager verifies the module after each pass, so this needs to be
+  // the first pass for it to see non-canonical shardings.
+  if (options.canonicalizeShardings) {
+    pm.addPass(createCanonicalizeShardingsPass());
+  }
+  pm.addPass(mlir::sdy::createSaveModuleOpPass(
+      options.dumpDirectory, "sdy_module_before_sdy_import",
+      options.saveModuleOpOptions));
   // We need to apply the inliner pass so we have a single main function,
   // otherwise we would need to propagate shardings between call ops and callee
   // functions.
   pm.addPass(createInlinerPass());
   pm.addPass(createSymbolDCEPass());
-  pm.addPass(createLiftInlinedMeshesPass());
-  pm.addNestedPass<func::FuncOp>(createConstantSplitterPass());
-  pm.addNestedPass<func::FuncOp>(createAddDataFlowEdgesPass());
-  pm.addPass(createManualAxesCleanupPass());
-  pm.addNestedPass<func::FuncOp>(createApplyShardingConstraintsPass());
-  // The sharding group import pass must run after applying sharding
-  // constraints. This ensures we can detect sharding conflicts between group
-  // members which have pre-propagation shardings due to sharding constraints.
-  pm.addPass(createShardingGroupImportPass());
+  ConstantSplitterPassOptions constantSplitterOptions;
+  constantSplitterOptions.deferSplitting = options.deferConstantSplitting;
+  if (options.fuseImportPasses) {
+    pm.addNestedPass<func::FuncOp>(
+        createConstantSplitterPass(constantSplitterOptions));
+    FusedImportPassOptions fusedImportOptions;
+    fusedImportOptions.implicitDataFlowEdges = options.implicitDataFlowEdges;
+    pm.addPass(createFusedImportPass(fusedImportOptions));
+  } else {
+    pm.addPass(createLiftInlinedMeshesPass());
+    pm.addNestedPass<func::FuncOp>(
+        createConstantSplitterPass(constantSplitterOptions));
+    if (!options.implicitDataFlowEdges) {
+      pm.addNestedPass<func::FuncOp>(createAddDataFlowEdgesPass());
+    }
+    pm.addPass(createManualAxesCleanupPass());
+    pm.addNestedPass<func::FuncOp>(createApplyShardingConstraintsPass());
+    // The sharding group import pass must run after applying sharding
+    // constraints. This ensures we can detect sharding conflicts between group
+    // members which have pre-propagation shardings due to sharding constraints.
+    pm.addPass(createShardingGroupImportPass());
+  }
 
   GreedyRewriteConfig config;
   config.useTopDownTraversal = true;
@@ -49,16 +69,46 @@ void addImportPipeline(OpPassManager& pm, StringRef dumpDirectory) {
   pm.addPass(createCanonicalizerPass(
       /*config=*/config, /*disabledPatterns=*/{},
       /*enabledPatterns=*/{"DedupShardingGroupPattern"}));
-  pm.addPass(mlir::sdy::createSaveModuleOpPass(dumpDirectory,
-                                               "sdy_module_after_sdy_import"));
+  pm.addPass(mlir::sdy::createSaveModuleOpPass(
+      options.dumpDirectory, "sdy_module_after_sdy_import",
+      options.saveModuleOpOptions));
 }
 
+namespace {
+
+struct ImportPipelineOptions
+    : public PassPipelineOptions<ImportPipelineOptions> {
+  Option<bool> canonicalizeShardings{
+      *this, "canonicalize-shardings",
+      llvm::cl::desc("Whether to canonicalize all shardings before any other "
+                     "pass, for modules that were built without verification."),
+      llvm::cl::init(false)};
+  Option<bool> fuseImportPasses{
+      *this, "fuse-import-passes",
+      llvm::cl::desc("Whether to replace the passes that can be fused with a "
+                     "single `sdy-fused-import` pass."),
+      llvm::cl::init(false)};
+  Option<bool> implicitDataFlowEdges{
+      *this, "implicit-data-flow-edges",
+      llvm::cl::desc("Whether to skip adding `sdy.data_flow_edge` ops, and use "
+                     "the sharding of each edge owner instead."),
+      llvm::cl::init(false)};
+};
+
+}  // namespace
+
 void registerImportPipeline() {
-  PassPipelineRegistration<>(
+  PassPipelineRegistration<ImportPipelineOptions>(
       "sdy-import-pipeline",
       "Run a sequence of import passes needed as a pre-processing step for "
       "Shardy propagation",
-      [](OpPassManager& pm) { return addImportPipeline(pm); });
+      [](OpPassManager& pm, const ImportPipelineOptions& pipelineOptions) {
+        ImportOptions options;
+        options.canonicalizeShardings = pipelineOptions.canonicalizeShardings;
+        options.fuseImportPasses = pipelineOptions.fuseImportPasses;
+        options.implicitDataFlowEdges = pipelineOptions.implicitDataFlowEdges;
+        return addImportPipeline(pm, options);
+      });
 }
 
 }  // namespace sdy
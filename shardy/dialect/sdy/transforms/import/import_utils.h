@@ -0,0 +1,163 @@
+/* Copyright 2024 The Shardy Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef SHARDY_DIALECT_SDY_TRANSFORMS_IMPORT_IMPORT_UTILS_H_
+#define SHARDY_DIALECT_SDY_TRANSFORMS_IMPORT_IMPORT_UTILS_H_
+
+#include <cstdint>
+#include <utility>
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/SmallVector.h"
+#include "mlir/IR/Attributes.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Support/LLVM.h"
+#include "shardy/dialect/sdy/ir/dialect.h"
+
+// The per-op logic of the import passes, shared by each pass and the fused
+// import pass.
+
+namespace mlir {
+namespace sdy {
+
+// Replaces the meshes of `TensorShardingAttr`s in a module with references to
+// a unique `MeshOp` (see `LiftInlinedMeshesPass`).
+class MeshLifter {
+ public:
+  // Erases any `MeshOp` in `moduleOp` that is identical to a previous one.
+  //
+  // `symbolTable` must be the symbol table of `moduleOp`, and is updated with
+  // any erased or added `MeshOp`.
+  MeshLifter(ModuleOp moduleOp, SymbolTable& symbolTable);
+
+  // Creates a `MeshOp` for `mesh` if there isn't an identical one.
+  void addInlinedMesh(MeshAttr mesh);
+
+  // Creates a `MeshOp` for each mesh inlined in a sharding in `rootOps`, if
+  // there isn't an identical one.
+  //
+  // The root ops must be independent (e.g. functions), as their inlined meshes
+  // are collected in parallel. The `MeshOp`s are then created in the order
+  // the meshes are encountered in `rootOps`, which is the same order a single
+  // walk of `rootOps` would create them in.
+  void addInlinedMeshes(ArrayRef<Operation*> rootOps);
+
+  // Returns `sharding` with its mesh replaced by a reference to an identical
+  // `MeshOp`, which must already exist (see `addInlinedMesh`).
+  //
+  // Doesn't modify the lifter, so it can be called from multiple threads.
+  TensorShardingAttr getLiftedSharding(TensorShardingAttr sharding) const;
+
+  // Returns true if any sharding might have a mesh that should be replaced,
+  // i.e., a `MeshOp` was deduped or a `MeshOp` was added for an inlined mesh.
+  bool hasMeshesToReplace() const { return hasMeshesToReplaceFlag; }
+
+ private:
+  Location loc;
+  SymbolTable& symbolTable;
+  OpBuilder builder;
+  // A map from both:
+  // 1. `FlatSymbolRefAttr` referencing a `MeshOp` that was deduped.
+  // 2. `MeshAttr` in an existing `MeshOp` or inlined in a
+  //    `TensorShardingAttr`.
+  // To the name of an existing or new `MeshOp` that should now be referenced
+  // instead.
+  llvm::SmallDenseMap<Attribute, StringAttr> meshOrRefToNewName;
+  bool hasMeshesToReplaceFlag = false;
+};
+
+// Adds a `DataFlowEdgeOp` for each data flow edge owner of `op`, i.e., its
+// results and block arguments that are edge owners (see
+// `AddDataFlowEdgesPass`).
+void addDataFlowEdges(Operation* op, IRRewriter& rewriter);
+
+// Sorts the manual axes of `op` and adds the manual axes that its in/out
+// shardings don't use to their replicated axes (see `ManualAxesCleanupPass`).
+void cleanupManualAxes(ManualComputationOp op, const SymbolTable& symbolTable);
+
+// Returns `sharding` in canonical form, i.e., with consecutive sub-axes of the
+// same full axis merged, and with sorted and deduped replicated axes (see
+// `CanonicalizeShardingsPass`).
+//
+// Returns `sharding` as is if its mesh can't be found in `symbolTable`.
+TensorShardingAttr canonicalizeSharding(TensorShardingAttr sharding,
+                                        const SymbolTable& symbolTable);
+
+// Applies the sharding of a `ShardingConstraintOp`, or the in shardings of a
+// `ManualComputationOp`, to their inputs if appropriate (see
+// `ApplyShardingConstraintsPass`). Does nothing for any other op.
+void applyShardingConstraints(Operation* op);
+
+// Unifies and validates sharding groups (see `ShardingGroupImportPass`).
+//
+// Groups are unified as they are added, with a union-find over a flat array of
+// the original group ids.
+class ShardingGroupImporter {
+ public:
+  // Adds `op` to the collected sharding groups, and validates that its value
+  // has the same shape and `ManualComputationOp` parent as the other values in
+  // its group. The group of `op` is merged with any other group its value is
+  // in.
+  //
+  // Emits an error and returns failure if `op` is invalid.
+  LogicalResult addShardingGroup(ShardingGroupOp op);
+
+  // Reindexes the group ids of the collected sharding groups, and applies the
+  // initial sharding of a value in each group (if any) to all values in the
+  // group.
+  //
+  // Should be called after all sharding groups were added, and the sharding
+  // constraints were applied.
+  //
+  // Emits an error and returns failure if values in the same group have
+  // different initial shardings.
+  LogicalResult unifyAndApplyShardings();
+
+ private:
+  // An original group id, with its parent in the union-find forest, and the
+  // `ManualComputationOp` parent and shape of its values.
+  struct GroupNode {
+    int64_t groupId;
+    int64_t parent;
+    ManualComputationOp manualComp;
+    ArrayRef<int64_t> tensorShape;
+  };
+
+  // Returns the root of the unified group of `node`, and makes it the parent
+  // of all nodes on the path to it.
+  int64_t findRoot(int64_t node);
+
+  // Merges the unified groups of `lhs` and `rhs`, such that the root is the
+  // node with the minimum original group id.
+  void unionGroups(int64_t lhs, int64_t rhs);
+
+  SmallVector<GroupNode> nodes;
+  llvm::DenseMap<int64_t, int64_t> groupIdToNode;
+  // The node of the first group each value was added to, in order of addition.
+  llvm::MapVector<Value, int64_t> valueToNode;
+  SmallVector<std::pair<ShardingGroupOp, int64_t>> opsAndNodes;
+};
+
+}  // namespace sdy
+}  // namespace mlir
+
+#endif  // SHARDY_DIALECT_SDY_TRANSFORMS_IMPORT_IMPORT_UTILS_H_
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <memory>  // IWYU pragma: keep
 #include <optional>
@@ -21,16 +22,22 @@ limitations under the License.
 
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/FormatVariadic.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/Operation.h"
 #include "mlir/IR/SymbolTable.h"
+#include "mlir/IR/Threading.h"
 #include "mlir/Pass/Pass.h"  // IWYU pragma: keep
 #include "mlir/Support/LLVM.h"
 #include "shardy/dialect/sdy/ir/dialect.h"
 #include "shardy/dialect/sdy/transforms/common/sharding_walker.h"
+#include "shardy/dialect/sdy/transforms/import/import_utils.h"
 
 namespace mlir {
 namespace sdy {
@@ -61,67 +68,111 @@ TensorShardingAttr replaceMesh(TensorShardingAttr sharding,
                                  sharding.getReplicatedAxes());
 }
 
+}  // namespace
+
+MeshLifter::MeshLifter(ModuleOp moduleOp, SymbolTable& symbolTable)
+    : loc(moduleOp.getLoc()),
+      symbolTable(symbolTable),
+      builder(moduleOp.getContext()) {
+  MeshOp lastMeshOp;
+  for (auto meshOp : llvm::make_early_inc_range(moduleOp.getOps<MeshOp>())) {
+    if (auto insertedIt = meshOrRefToNewName.try_emplace(
+            meshOp.getMesh(), meshOp.getSymNameAttr());
+        !insertedIt.second) {
+      // This is a duplicate mesh, we map its name (as a FlatSymbolRefAttr) to
+      // the name of the identical mesh that was already inserted, so we can
+      // replace the former with the latter in any sharding in the module that
+      // referenced it. We can also erase the mesh because we know it won't be
+      // used after this pass.
+      // NOTE: assigning to a map entry a value that is read from the same map
+      // can lead to use-after-free (if rehash is triggered).
+      StringAttr newMeshName = insertedIt.first->second;
+      meshOrRefToNewName[FlatSymbolRefAttr::get(meshOp.getSymNameAttr())] =
+          newMeshName;
+      symbolTable.erase(meshOp);
+      hasMeshesToReplaceFlag = true;
+    } else {
+      lastMeshOp = meshOp;
+    }
+  }
+
+  if (lastMeshOp) {
+    builder.setInsertionPointAfter(lastMeshOp);
+  } else {
+    builder.setInsertionPointToStart(moduleOp.getBody());
+  }
+}
+
+void MeshLifter::addInlinedMesh(MeshAttr mesh) {
+  // Taking `newMeshName` by reference so we can update it if `mesh` isn't
+  // already in the map.
+  StringAttr& newMeshName = meshOrRefToNewName[mesh];
+  if (newMeshName) {
+    return;
+  }
+  // TODO(tomnatan): give better names for meshes with device IDs, e.g.,
+  // `@some_mesh_arbitrary_device_order` when there is an identical
+  // `@some_mesh` without device IDs.
+  newMeshName = symbolTable.insert(createNewMeshOp(loc, mesh, builder));
+  hasMeshesToReplaceFlag = true;
+}
+
+void MeshLifter::addInlinedMeshes(ArrayRef<Operation*> rootOps) {
+  SmallVector<llvm::SetVector<MeshAttr>> inlinedMeshesPerRootOp(rootOps.size());
+  parallelFor(builder.getContext(), 0, rootOps.size(), [&](size_t index) {
+    walkShardings(rootOps[index], [&](TensorShardingAttr sharding) {
+      if (auto mesh = dyn_cast<MeshAttr>(sharding.getMeshOrRef())) {
+        inlinedMeshesPerRootOp[index].insert(mesh);
+      }
+    });
+  });
+  for (const llvm::SetVector<MeshAttr>& inlinedMeshes :
+       inlinedMeshesPerRootOp) {
+    llvm::for_each(inlinedMeshes,
+                   [&](MeshAttr mesh) { addInlinedMesh(mesh); });
+  }
+}
+
+TensorShardingAttr MeshLifter::getLiftedSharding(
+    TensorShardingAttr sharding) const {
+  auto it = meshOrRefToNewName.find(sharding.getMeshOrRef());
+  if (it == meshOrRefToNewName.end()) {
+    assert(!isa<MeshAttr>(sharding.getMeshOrRef()) &&
+           "inlined mesh wasn't added to the lifter");
+    return sharding;
+  }
+  return replaceMesh(sharding, it->second);
+}
+
+namespace {
+
 struct LiftInlinedMeshesPass
     : public impl::LiftInlinedMeshesPassBase<LiftInlinedMeshesPass> {
   using LiftInlinedMeshesPassBase::LiftInlinedMeshesPassBase;
 
   void runOnOperation() final {
     ModuleOp moduleOp = getOperation();
+    MLIRContext* context = moduleOp.getContext();
     SymbolTable symbolTable(moduleOp);
+    MeshLifter meshLifter(moduleOp, symbolTable);
 
-    // A map from both:
-    // 1. `FlatSymbolRefAttr` referencing a `MeshOp` that was deduped.
-    // 2. `MeshAttr` in an existing `MeshOp` or inlined in a
-    //    `TensorShardingAttr`.
-    // To the name of an existing or new `MeshOp` that should now be referenced
-    // instead.
-    llvm::SmallDenseMap<Attribute, StringAttr> meshOrRefToNewName;
-
-    MeshOp lastMeshOp;
-    for (auto meshOp : llvm::make_early_inc_range(moduleOp.getOps<MeshOp>())) {
-      if (auto insertedIt = meshOrRefToNewName.try_emplace(
-              meshOp.getMesh(), meshOp.getSymNameAttr());
-          !insertedIt.second) {
-        // This is a duplicate mesh, we map its name (as a FlatSymbolRefAttr) to
-        // the name of the identical mesh that was already inserted, so we can
-        // replace the former with the latter in any sharding in the module that
-        // referenced it. We can also erase the mesh because we know it won't be
-        // used after this pass.
-        // NOTE: assigning to a map entry a value that is read from the same map
-        // can lead to use-after-free (if rehash is triggered).
-        StringAttr newMeshName = insertedIt.first->second;
-        meshOrRefToNewName[FlatSymbolRefAttr::get(meshOp.getSymNameAttr())] =
-            newMeshName;
-        symbolTable.erase(meshOp);
-      } else {
-        lastMeshOp = meshOp;
+    // Ops in the module other than meshes (e.g. functions) are independent.
+    SmallVector<Operation*> rootOps;
+    for (Operation& op : moduleOp.getOps()) {
+      if (!isa<MeshOp>(op)) {
+        rootOps.push_back(&op);
       }
     }
+    meshLifter.addInlinedMeshes(rootOps);
 
-    OpBuilder builder(moduleOp);
-    if (lastMeshOp) {
-      builder.setInsertionPointAfter(lastMeshOp);
-    } else {
-      builder.setInsertionPointToStart(moduleOp.getBody());
+    if (!meshLifter.hasMeshesToReplace()) {
+      return;
     }
-
-    transformShardings(moduleOp, [&](TensorShardingAttr sharding) {
-      // Taking `newMeshName` by reference so we can update it if `sharding`
-      // has an inlined mesh that isn't already in the map.
-      StringAttr& newMeshName = meshOrRefToNewName[sharding.getMeshOrRef()];
-      if (newMeshName) {
-        return replaceMesh(sharding, newMeshName);
-      }
-      if (auto mesh = dyn_cast<MeshAttr>(sharding.getMeshOrRef())) {
-        // Inlined mesh with a new `MeshAttr`.
-        // TODO(tomnatan): give better names for meshes with device IDs, e.g.,
-        // `@some_mesh_arbitrary_device_order` when there is an identical
-        // `@some_mesh` without device IDs.
-        newMeshName = symbolTable.insert(
-            createNewMeshOp(moduleOp.getLoc(), mesh, builder));
-        return replaceMesh(sharding, newMeshName);
-      }
-      return sharding;
+    // Only shardings with an inlined or deduped mesh are replaced.
+    parallelForEach(context, rootOps, [&](Operation* rootOp) {
+      transformShardings(rootOp, [&](TensorShardingAttr sharding) {
+        return meshLifter.getLiftedSharding(sharding);
+      });
     });
   }
 };
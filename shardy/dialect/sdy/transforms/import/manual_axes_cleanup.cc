@@ -33,6 +33,7 @@ limitations under the License.
 #include "mlir/Support/LLVM.h"
 #include "shardy/dialect/sdy/ir/dialect.h"
 #include "shardy/dialect/sdy/ir/utils.h"
+#include "shardy/dialect/sdy/transforms/import/import_utils.h"
 
 namespace mlir {
 namespace sdy {
@@ -123,6 +124,26 @@ void sortManualAxes(ManualComputationOp op, MeshAttr mesh) {
   op.setManualAxes(sortedManualAxes);
 }
 
+}  // namespace
+
+void cleanupManualAxes(ManualComputationOp op, const SymbolTable& symbolTable) {
+  ArrayRef<TensorShardingAttr> inShardings = op.getInShardings().getShardings();
+  ArrayRef<TensorShardingAttr> outShardings =
+      op.getOutShardings().getShardings();
+  if (inShardings.empty() && outShardings.empty()) {
+    // Nothing to do.
+    return;
+  }
+  Attribute meshOrRef =
+      getCommonMeshOrRef(inShardings, outShardings, symbolTable);
+  MeshAttr mesh = meshOrRef ? getMeshOrLookup(symbolTable, meshOrRef) : nullptr;
+  assert(mesh && "expected inputs and outputs to have a common mesh");
+  sortManualAxes(op, mesh);
+  addUnusedManualAxesToReplicatedAxes(op, mesh, meshOrRef, symbolTable);
+}
+
+namespace {
+
 struct ManualAxesCleanupPass
     : public impl::ManualAxesCleanupPassBase<ManualAxesCleanupPass> {
   using ManualAxesCleanupPassBase::ManualAxesCleanupPassBase;
@@ -131,21 +152,7 @@ struct ManualAxesCleanupPass
     ModuleOp moduleOp = getOperation();
     SymbolTable symbolTable(moduleOp);
     moduleOp->walk([&](ManualComputationOp op) {
-      ArrayRef<TensorShardingAttr> inShardings =
-          op.getInShardings().getShardings();
-      ArrayRef<TensorShardingAttr> outShardings =
-          op.getOutShardings().getShardings();
-      if (inShardings.empty() && outShardings.empty()) {
-        // Nothing to do.
-        return;
-      }
-      Attribute meshOrRef =
-          getCommonMeshOrRef(inShardings, outShardings, symbolTable);
-      MeshAttr mesh =
-          meshOrRef ? getMeshOrLookup(symbolTable, meshOrRef) : nullptr;
-      assert(mesh && "expected inputs and outputs to have a common mesh");
-      sortManualAxes(op, mesh);
-      addUnusedManualAxesToReplicatedAxes(op, mesh, meshOrRef, symbolTable);
+      cleanupManualAxes(op, symbolTable);
     });
   }
 
@@ -24,6 +24,7 @@ limitations under the License.
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Support/LLVM.h"
+#include "shardy/common/save_module_op.h"
 #include "shardy/dialect/sdy/ir/dialect.h"
 
 // IWYU pragma: end_keep
@@ -35,9 +36,32 @@ namespace sdy {
 #define GEN_PASS_REGISTRATION
 #include "shardy/dialect/sdy/transforms/import/passes.h.inc"
 
+// Options for the import pipeline.
+struct ImportOptions {
+  // The directory to save the module to before and after import, if not empty.
+  StringRef dumpDirectory = "";
+  // How to save the module to `dumpDirectory`.
+  SaveModuleOpOptions saveModuleOpOptions;
+  // If true, all shardings are canonicalized before any other pass runs (see
+  // `CanonicalizeShardingsPass`). This is only useful for modules that were
+  // built without being verified, as the verifier rejects non-canonical
+  // shardings.
+  bool canonicalizeShardings = false;
+  // If true, constant sub-computations aren't cloned for each of their users,
+  // and `createSplitDeferredConstantsPass` should run after propagation (see
+  // `ConstantSplitterPass`).
+  bool deferConstantSplitting = false;
+  // If true, the passes that can be fused are replaced with a single
+  // `FusedImportPass`, which imports functions in parallel on its own.
+  bool fuseImportPasses = false;
+  // If true, no `DataFlowEdgeOp`s are added, and propagation uses the sharding
+  // of each edge owner as the sharding of its edge.
+  bool implicitDataFlowEdges = false;
+};
+
 // Adds a sequence of import passes needed as a pre-processing step for SDY
 // propagation.
-void addImportPipeline(OpPassManager& pm, StringRef dumpDirectory = "");
+void addImportPipeline(OpPassManager& pm, const ImportOptions& options = {});
 
 // Register the sdy-import-pipeline.
 void registerImportPipeline();
@@ -15,10 +15,9 @@ limitations under the License.
 
 #include <cstdint>
 #include <memory>  // IWYU pragma: keep
+#include <utility>
 
-#include "llvm/ADT/DenseMap.h"
-#include "llvm/ADT/MapVector.h"
-#include "llvm/ADT/EquivalenceClasses.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/Value.h"
@@ -27,6 +26,7 @@ limitations under the License.
 #include "mlir/Support/LLVM.h"
 #include "shardy/dialect/sdy/ir/dialect.h"
 #include "shardy/dialect/sdy/ir/utils.h"
+#include "shardy/dialect/sdy/transforms/import/import_utils.h"
 
 namespace mlir {
 namespace sdy {
@@ -34,139 +34,136 @@ namespace sdy {
 #define GEN_PASS_DEF_SHARDINGGROUPIMPORTPASS
 #include "shardy/dialect/sdy/transforms/import/passes.h.inc"
 
-namespace {
+int64_t ShardingGroupImporter::findRoot(int64_t node) {
+  int64_t root = node;
+  while (nodes[root].parent != root) {
+    root = nodes[root].parent;
+  }
+  while (nodes[node].parent != root) {
+    node = std::exchange(nodes[node].parent, root);
+  }
+  return root;
+}
 
-using llvm::DenseMap;
-using llvm::EquivalenceClasses;
-using llvm::SmallDenseMap;
-
-using ValueToShardingGroup =
-    llvm::MapVector<Value, llvm::SmallVector<ShardingGroupOp>>;
-using GroupIdToShardingGroups = SmallVector<SmallVector<ShardingGroupOp>>;
-
-LogicalResult buildShardingGroupMappingAndValidateGroups(
-    ModuleOp module, ValueToShardingGroup& tensorToGroups) {
-  // Map to hold validation info for shard groups within manual computations.
-  DenseMap<int64_t, ManualComputationOp> groupToManualComp;
-  DenseMap<int64_t, ArrayRef<int64_t>> groupToTensorShape;
-
-  // While walking the graph we simultaneously build up the tensorToGroups
-  // mapping (which will be used for unification) while also validating the
-  // structure of shard groups meets expectations
-  WalkResult result = module.walk([&](ShardingGroupOp op) {
-    tensorToGroups[op.getInput()].push_back(op);
-
-    // All values in a sharding group should have either:
-    // 1) No manual computation op parent
-    // 2) The same manual computation op parent.
-    // If a group has no manual computation op parent, 'groupToManualComp'
-    // will map it to nullptr and ensure all other values in that group are
-    // also mapped to nullptr.
-    auto parent = op->getParentOfType<ManualComputationOp>();
-    int64_t groupId = op.getGroupId();
-
-    auto [it, inserted] = groupToManualComp.try_emplace(groupId, parent);
-    if (!inserted && it->second != parent) {
-      op.emitError(
-          "ShardingGroupOps values cannot cross ManualComputationOp "
-          "boundaries for groupId: ")
-          << groupId;
-      return WalkResult::interrupt();
-    }
+void ShardingGroupImporter::unionGroups(int64_t lhs, int64_t rhs) {
+  lhs = findRoot(lhs);
+  rhs = findRoot(rhs);
+  if (lhs == rhs) {
+    return;
+  }
+  // The root with the minimum group id determines the order of the reindexed
+  // group ids.
+  if (nodes[rhs].groupId < nodes[lhs].groupId) {
+    std::swap(lhs, rhs);
+  }
+  nodes[rhs].parent = lhs;
+}
 
-    // All values in a sharding group should have the same shape.
-    ArrayRef<int64_t> tensorShape = getTensorShape(op.getInput());
-    auto [itTensorShape, tensorShapeInserted] =
-        groupToTensorShape.try_emplace(groupId, tensorShape);
-    if (!tensorShapeInserted && itTensorShape->getSecond() != tensorShape) {
-      op.emitError(
-          "ShardingGroupOps values must have the same shape for groupId: ")
-          << groupId;
-      return WalkResult::interrupt();
-    }
+LogicalResult ShardingGroupImporter::addShardingGroup(ShardingGroupOp op) {
+  // All values in a sharding group should have either:
+  // 1) No manual computation op parent
+  // 2) The same manual computation op parent.
+  // If a group has no manual computation op parent, its node will hold a
+  // nullptr and ensure all other values in that group also have none.
+  //
+  // All values in a sharding group should also have the same shape.
+  auto parent = op->getParentOfType<ManualComputationOp>();
+  ArrayRef<int64_t> tensorShape = getTensorShape(op.getInput());
+  int64_t groupId = op.getGroupId();
+
+  auto [groupIt, groupInserted] =
+      groupIdToNode.try_emplace(groupId, nodes.size());
+  int64_t node = groupIt->second;
+  if (groupInserted) {
+    nodes.push_back(GroupNode{groupId, node, parent, tensorShape});
+  } else if (nodes[node].manualComp != parent) {
+    op.emitError(
+        "ShardingGroupOps values cannot cross ManualComputationOp "
+        "boundaries for groupId: ")
+        << groupId;
+    return failure();
+  } else if (nodes[node].tensorShape != tensorShape) {
+    op.emitError(
+        "ShardingGroupOps values must have the same shape for groupId: ")
+        << groupId;
+    return failure();
+  }
 
-    return WalkResult::advance();
-  });
-  return failure(result.wasInterrupted());
+  // Any time a value is in two groups, all members of both groups should be
+  // sharded in the same way, so we merge them.
+  opsAndNodes.emplace_back(op, node);
+  auto [valueIt, valueInserted] = valueToNode.try_emplace(op.getInput(), node);
+  if (!valueInserted) {
+    unionGroups(valueIt->second, node);
+  }
+  return success();
 }
 
-GroupIdToShardingGroups unifyShardingGroups(
-    ValueToShardingGroup& tensorToGroups) {
-  // Merge the equivalence classes of group ids which had the same tensors
-  // within them. (unionSets uses the default comparator and will consider the
-  // minimum group_id as the representative element of the equivalence class).
-  EquivalenceClasses<int64_t> shardingGroupEquivalences;
-  for (auto& [_, groupsForTensor] : tensorToGroups) {
-    int64_t canonicalId = groupsForTensor.front().getGroupId();
-    for (ShardingGroupOp group : groupsForTensor) {
-      shardingGroupEquivalences.unionSets(canonicalId, group.getGroupId());
-    }
+LogicalResult ShardingGroupImporter::unifyAndApplyShardings() {
+  // If there are no sharding groups, the rest of the preprocessing steps
+  // are not necessary.
+  if (opsAndNodes.empty()) {
+    return success();
   }
 
-  // After merging groups we reindex the group IDs so that they take values
-  // from the set {0,1,...,N-1} (N is the number of equivalence classes).
-  // The leader element of each equivalent class corresponds to the minimum
-  // group_id, so by looping over the group leaders in order their reindexed
-  // ids can be set to maintain the same relative ordering.
-  int64_t reindexId = 0;
-  SmallDenseMap<int64_t, int64_t> reindexMap;
-  for (const auto& group : shardingGroupEquivalences) {
-    if (group.isLeader()) {
-      reindexMap[group.getData()] = reindexId++;
+  // We reindex the group IDs so that they take values from the set
+  // {0,1,...,N-1} (N is the number of unified groups). The root of each
+  // unified group has its minimum group id, so by sorting the roots their
+  // reindexed ids maintain the same relative ordering.
+  SmallVector<int64_t> roots;
+  for (int64_t node = 0; node < static_cast<int64_t>(nodes.size()); ++node) {
+    if (findRoot(node) == node) {
+      roots.push_back(node);
     }
   }
-
-  GroupIdToShardingGroups reindexGroups(reindexId);
-  // Update the graph to replace group_ids with their canonical id.
-  for (auto& [_, groupsForTensor] : tensorToGroups) {
-    for (ShardingGroupOp op : groupsForTensor) {
-      op.setGroupId(reindexMap[shardingGroupEquivalences.getLeaderValue(
-          op.getGroupId())]);
-      reindexGroups[op.getGroupId()].push_back(op);
-    }
+  llvm::sort(roots, [&](int64_t lhs, int64_t rhs) {
+    return nodes[lhs].groupId < nodes[rhs].groupId;
+  });
+  SmallVector<int64_t> rootToReindexedId(nodes.size());
+  for (auto [reindexedId, root] : llvm::enumerate(roots)) {
+    rootToReindexedId[root] = reindexedId;
   }
-  return reindexGroups;
-}
+  auto getReindexedId = [&](int64_t node) {
+    return rootToReindexedId[findRoot(node)];
+  };
 
-// This function verifies that sharding groups with pre-existing shardings are
-// compatible.  Compatibility means all values in the group must have either no
-// sharding or the same sharding.
-LogicalResult validateCompatibilityAndApplyInitialShardingConstraints(
-    ModuleOp module, GroupIdToShardingGroups& groupIdToShardingGroups) {
-  SmallDenseMap<int64_t, TensorShardingAttr> groupIdToSharding;
   // Tensors can have initial shardings defined in several ways (e.g., sharding
   // constraints, function arguments, manual computations). These initial
   // shardings only conflict with Sharding Groups if their value belongs to a
-  // group. Therefore, we only need to validate the consistency of shardings
-  // within ShardingGroupOps to ensure no conflicts.
-  for (const auto& shardingGroups : groupIdToShardingGroups) {
-    for (ShardingGroupOp shardingGroupOp : shardingGroups) {
-      TensorShardingAttr sharding = getSharding(shardingGroupOp.getInput());
-      int64_t groupId = shardingGroupOp.getGroupId();
-      if (!sharding) {
-        continue;
-      }
-      auto [it, inserted] = groupIdToSharding.try_emplace(groupId, sharding);
-      if (!inserted && it->second != sharding) {
-        shardingGroupOp.emitError(
-            "Inconsistent shardings prior to propagation for ShardingGroupOps "
-            "with canonicalized groupId: ")
-            << groupId;
-        return failure();
-      }
+  // group. Compatibility means all values in the group must have either no
+  // sharding or the same sharding.
+  SmallVector<TensorShardingAttr> groupShardings(roots.size());
+  for (auto [op, node] : opsAndNodes) {
+    int64_t groupId = getReindexedId(node);
+    op.setGroupId(groupId);
+    TensorShardingAttr sharding = getSharding(op.getInput());
+    if (!sharding) {
+      continue;
+    }
+    TensorShardingAttr& groupSharding = groupShardings[groupId];
+    if (!groupSharding) {
+      groupSharding = sharding;
+    } else if (groupSharding != sharding) {
+      op.emitError(
+          "Inconsistent shardings prior to propagation for ShardingGroupOps "
+          "with canonicalized groupId: ")
+          << groupId;
+      return failure();
     }
   }
 
   // Apply initial shardings to all values in the group.
-  for (auto& [groupId, sharding] : groupIdToSharding) {
-    for (ShardingGroupOp shardingGroupOp : groupIdToShardingGroups[groupId]) {
-      setSharding(shardingGroupOp.getInput(), sharding);
+  for (auto [value, node] : valueToNode) {
+    if (TensorShardingAttr sharding = groupShardings[getReindexedId(node)]) {
+      setSharding(value, sharding);
     }
   }
 
   return success();
 }
 
+namespace {
+
 struct ShardingGroupImportPass
     : public impl::ShardingGroupImportPassBase<ShardingGroupImportPass> {
   using ShardingGroupImportPassBase::ShardingGroupImportPassBase;
@@ -174,25 +171,19 @@ struct ShardingGroupImportPass
   void runOnOperation() final {
     // Extract the sharding group ids and tensor -> {group_id} mapping from the
     // high level module and validate any sharding group constrainst are met.
-    ValueToShardingGroup tensorToGroups;
-    ModuleOp module = getOperation();
-    if (failed(buildShardingGroupMappingAndValidateGroups(module,
-                                                          tensorToGroups))) {
+    ShardingGroupImporter importer;
+    if (getOperation()
+            .walk([&](ShardingGroupOp op) {
+              return failed(importer.addShardingGroup(op))
+                         ? WalkResult::interrupt()
+                         : WalkResult::advance();
+            })
+            .wasInterrupted()) {
       signalPassFailure();
-    }
-    // If there are no sharding groups, the rest of the preprocessing steps
-    // are not necessary.
-    if (tensorToGroups.empty()) {
       return;
     }
-
-    GroupIdToShardingGroups groupIdToReindexedTensors =
-        unifyShardingGroups(tensorToGroups);
     // This pass assumes sharding constraints are already applied to values.
-    // Compatibility constraints are applied after group unification to detect
-    // conflicts within the unified groups.
-    if (failed(validateCompatibilityAndApplyInitialShardingConstraints(
-            module, groupIdToReindexedTensors))) {
+    if (failed(importer.unifyAndApplyShardings())) {
       signalPassFailure();
     }
   }
@@ -0,0 +1,47 @@
+// RUN: sdy_opt %s -mlir-very-unsafe-disable-verifier-on-parsing -sdy-canonicalize-shardings | FileCheck %s
+
+sdy.mesh @mesh = <["x"=4, "y"=2]>
+
+// CHECK-LABEL: func @merge_consecutive_sub_axes_in_dim_sharding(
+// CHECK-SAME:    %arg0: tensor<8x8xf32> {sdy.sharding = #sdy.sharding<@mesh, [{"x"}, {}]>}
+func.func @merge_consecutive_sub_axes_in_dim_sharding(
+    %arg0: tensor<8x8xf32> {sdy.sharding = #sdy.sharding<@mesh, [{"x":(1)2, "x":(2)2}, {}]>})
+    -> tensor<8x8xf32> {
+  // CHECK-NEXT: stablehlo.negate %arg0 {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"y", "x"}, {?}]>]>}
+  %0 = stablehlo.negate %arg0 {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"y", "x":(1)2, "x":(2)2}, {?}]>]>} : tensor<8x8xf32>
+  return %0 : tensor<8x8xf32>
+}
+
+// CHECK-LABEL: func @sub_axis_spanning_full_axis(
+// CHECK-SAME:    %arg0: tensor<8x8xf32> {sdy.sharding = #sdy.sharding<@mesh, [{"x"}, {"y"}]>}
+func.func @sub_axis_spanning_full_axis(
+    %arg0: tensor<8x8xf32> {sdy.sharding = #sdy.sharding<@mesh, [{"x":(1)4}, {"y"}]>})
+    -> tensor<8x8xf32> {
+  return %arg0 : tensor<8x8xf32>
+}
+
+// CHECK-LABEL: func @sort_and_merge_replicated_axes(
+// CHECK-SAME:    %arg0: tensor<8x8xf32> {sdy.sharding = #sdy.sharding<@mesh, [{}, {}], replicated={"x", "y"}>}
+func.func @sort_and_merge_replicated_axes(
+    %arg0: tensor<8x8xf32> {sdy.sharding = #sdy.sharding<@mesh, [{}, {}], replicated={"y", "x":(2)2, "x":(1)2}>})
+    -> tensor<8x8xf32> {
+  return %arg0 : tensor<8x8xf32>
+}
+
+// CHECK-LABEL: func @dedup_replicated_axes(
+// CHECK-SAME:    %arg0: tensor<8x8xf32> {sdy.sharding = #sdy.sharding<@mesh, [{"x"}, {}], replicated={"y"}>}
+func.func @dedup_replicated_axes(
+    %arg0: tensor<8x8xf32> {sdy.sharding = #sdy.sharding<@mesh, [{"x"}, {}], replicated={"y", "y"}>})
+    -> tensor<8x8xf32> {
+  return %arg0 : tensor<8x8xf32>
+}
+
+// CHECK-LABEL: func @canonical_shardings_unchanged(
+// CHECK-SAME:    %arg0: tensor<8x8xf32> {sdy.sharding = #sdy.sharding<@mesh, [{"x":(1)2, ?}, {"y"}p1], replicated={"x":(2)2}>}
+func.func @canonical_shardings_unchanged(
+    %arg0: tensor<8x8xf32> {sdy.sharding = #sdy.sharding<@mesh, [{"x":(1)2, ?}, {"y"}p1], replicated={"x":(2)2}>})
+    -> tensor<8x8xf32> {
+  // CHECK-NEXT: stablehlo.abs %arg0 {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{?}, {"x":(2)2}]>]>}
+  %0 = stablehlo.abs %arg0 {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{?}, {"x":(2)2}]>]>} : tensor<8x8xf32>
+  return %0 : tensor<8x8xf32>
+}
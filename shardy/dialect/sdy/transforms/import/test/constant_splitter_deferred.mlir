@@ -0,0 +1,76 @@
+// RUN: sdy_opt %s -sdy-constant-splitter=defer-splitting=true 2>&1 | FileCheck %s
+
+sdy.mesh @mesh = <["a"=2, "b"=2]>
+
+// CHECK-LABEL: func @constant_multiple_users
+func.func @constant_multiple_users(%arg0: tensor<16x16xf32>) -> (tensor<8x16xf32>, tensor<8x16xf32>) {
+  // CHECK-NEXT: %[[CONST:.*]] = sdy.constant dense<1.000000e+00>
+  // CHECK-NEXT: %[[MARKER_0:.*]] = sdy.propagation_barrier %[[CONST]] allowed_direction=NONE {sdy.deferred_constant_split}
+  // CHECK-NEXT: %[[DOT_GENERAL:.*]] = stablehlo.dot_general %[[MARKER_0]], %arg0
+  // CHECK-NEXT: %[[MARKER_1:.*]] = sdy.propagation_barrier %[[CONST]] allowed_direction=NONE {sdy.deferred_constant_split}
+  // CHECK-NEXT: %[[ADD:.*]] = stablehlo.add %[[MARKER_1]], %[[DOT_GENERAL]]
+  // CHECK-NEXT: %[[MARKER_2:.*]] = sdy.propagation_barrier %[[CONST]] allowed_direction=NONE {sdy.deferred_constant_split}
+  // CHECK-NEXT: return %[[MARKER_2]], %[[ADD]]
+  %0 = stablehlo.constant dense<1.000000e+00> : tensor<8x16xf32>
+  %1 = stablehlo.dot_general %0, %arg0, contracting_dims = [1] x [0] : (tensor<8x16xf32>, tensor<16x16xf32>) -> tensor<8x16xf32>
+  %2 = stablehlo.add %0, %1 : tensor<8x16xf32>
+  return %0, %2 : tensor<8x16xf32>, tensor<8x16xf32>
+}
+
+// CHECK-LABEL: func @constant_sub_computation_multiple_users
+func.func @constant_sub_computation_multiple_users(%arg0: tensor<5x8xi32>) -> (tensor<4x5xi32>, tensor<4x8xi32>) {
+  // CHECK-NEXT: %[[IOTA:.*]] = stablehlo.iota dim = 0
+  // CHECK-NEXT: %[[CONST:.*]] = sdy.constant dense<2>
+  // CHECK-NEXT: %[[ADD:.*]] = stablehlo.add %[[IOTA]], %[[IOTA]]
+  // CHECK-NEXT: %[[MAX:.*]] = stablehlo.maximum %[[ADD]], %[[CONST]]
+  // CHECK-NEXT: %[[MARKER_0:.*]] = sdy.propagation_barrier %[[MAX]] allowed_direction=NONE {sdy.deferred_constant_split}
+  // CHECK-NEXT: %[[DOT_GENERAL:.*]] = stablehlo.dot_general %[[MARKER_0]], %arg0
+  // CHECK-NEXT: %[[MARKER_1:.*]] = sdy.propagation_barrier %[[MAX]] allowed_direction=NONE {sdy.deferred_constant_split}
+  // CHECK-NEXT: return %[[MARKER_1]], %[[DOT_GENERAL]]
+  %0 = stablehlo.iota dim = 0 : tensor<4x5xi32>
+  %1 = stablehlo.constant dense<2> : tensor<4x5xi32>
+  %2 = stablehlo.add %0, %0 : tensor<4x5xi32>
+  %3 = stablehlo.maximum %2, %1 : tensor<4x5xi32>
+  %4 = stablehlo.dot_general %3, %arg0, contracting_dims = [1] x [0] : (tensor<4x5xi32>, tensor<5x8xi32>) -> tensor<4x8xi32>
+  return %3, %4 : tensor<4x5xi32>, tensor<4x8xi32>
+}
+
+// CHECK-LABEL: func @single_use_has_no_marker
+func.func @single_use_has_no_marker(%arg0: tensor<8x16xf32>) -> tensor<8x16xf32> {
+  // CHECK-NEXT: %[[CONST:.*]] = sdy.constant dense<1.000000e+00>
+  // CHECK-NEXT: %[[ADD:.*]] = stablehlo.add %[[CONST]], %arg0
+  // CHECK-NEXT: return %[[ADD]]
+  %0 = stablehlo.constant dense<1.000000e+00> : tensor<8x16xf32>
+  %1 = stablehlo.add %0, %arg0 : tensor<8x16xf32>
+  return %1 : tensor<8x16xf32>
+}
+
+// CHECK-LABEL: func @marker_has_constant_sharding
+func.func @marker_has_constant_sharding(%arg0: tensor<8x16xf32>) -> (tensor<8x16xf32>, tensor<8x16xf32>) {
+  // CHECK-NEXT: %[[CONST:.*]] = sdy.constant {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a"}, {?}]>]>} dense<1.000000e+00>
+  // CHECK-NEXT: %[[MARKER_0:.*]] = sdy.propagation_barrier %[[CONST]] allowed_direction=NONE {sdy.deferred_constant_split, sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a"}, {?}]>]>}
+  // CHECK-NEXT: %[[ADD:.*]] = stablehlo.add %[[MARKER_0]], %arg0
+  // CHECK-NEXT: %[[MARKER_1:.*]] = sdy.propagation_barrier %[[CONST]] allowed_direction=NONE {sdy.deferred_constant_split, sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a"}, {?}]>]>}
+  // CHECK-NEXT: %[[MUL:.*]] = stablehlo.multiply %[[MARKER_1]], %arg0
+  // CHECK-NEXT: return %[[ADD]], %[[MUL]]
+  %0 = stablehlo.constant {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a"}, {?}]>]>} dense<1.000000e+00> : tensor<8x16xf32>
+  %1 = stablehlo.add %0, %arg0 : tensor<8x16xf32>
+  %2 = stablehlo.multiply %0, %arg0 : tensor<8x16xf32>
+  return %1, %2 : tensor<8x16xf32>, tensor<8x16xf32>
+}
+
+// CHECK-LABEL: func @sharding_group_is_split_eagerly
+func.func @sharding_group_is_split_eagerly(%arg0: tensor<16x16xf32>) -> (tensor<8x16xf32>, tensor<8x16xf32>) {
+  // CHECK-NEXT: %[[CONST_0:.*]] = sdy.constant dense<1.000000e+00>
+  // CHECK-NEXT: sdy.sharding_group %[[CONST_0]] group_id=0
+  // CHECK-NEXT: %[[CONST_1:.*]] = sdy.constant dense<1.000000e+00>
+  // CHECK-NEXT: sdy.sharding_group %[[CONST_1]] group_id=0
+  // CHECK-NEXT: %[[DOT_GENERAL:.*]] = stablehlo.dot_general %[[CONST_0]], %arg0
+  // CHECK-NEXT: %[[ADD:.*]] = stablehlo.add %[[CONST_1]], %[[DOT_GENERAL]]
+  // CHECK-NEXT: return %[[ADD]], %[[DOT_GENERAL]]
+  %0 = stablehlo.constant dense<1.000000e+00> : tensor<8x16xf32>
+  sdy.sharding_group %0 group_id=0 : tensor<8x16xf32>
+  %1 = stablehlo.dot_general %0, %arg0, contracting_dims = [1] x [0] : (tensor<8x16xf32>, tensor<16x16xf32>) -> tensor<8x16xf32>
+  %2 = stablehlo.add %0, %1 : tensor<8x16xf32>
+  return %2, %1 : tensor<8x16xf32>, tensor<8x16xf32>
+}
@@ -1,4 +1,5 @@
 // RUN: sdy_opt %s -split-input-file -sdy-import-pipeline 2>&1 | FileCheck %s
+// RUN: sdy_opt %s -split-input-file -sdy-import-pipeline='fuse-import-passes=true' 2>&1 | FileCheck %s
 
 // Verifies that function `-inliner` pass is applied
 // CHECK-LABEL: func @main
@@ -141,3 +142,16 @@ func.func @add_manual_axes_to_replicated_applied_constraint(%arg0: tensor<8xf32>
   } : (tensor<8xf32>) -> tensor<8xf32>
   return %0 : tensor<8xf32>
 }
+
+// -----
+
+// Verifies that inlined meshes are lifted before the sharding of a data flow
+// edge owner is copied to its `DataFlowEdgeOp`.
+// CHECK: sdy.mesh @mesh = <["a"=2]>
+// CHECK-LABEL: func @main
+func.func @main(%arg0: tensor<32x96xf32>) -> tensor<32x96xf32> {
+  // CHECK-NEXT: %[[OPT_BARRIER:.*]] = stablehlo.optimization_barrier {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a"}, {}]>]>} %arg0
+  // CHECK-NEXT: sdy.data_flow_edge %[[OPT_BARRIER]] sharding=<@mesh, [{"a"}, {}]> : tensor<32x96xf32>
+  %0 = stablehlo.optimization_barrier {sdy.sharding = #sdy.sharding_per_value<[<mesh<["a"=2]>, [{"a"}, {}]>]>} %arg0 : tensor<32x96xf32>
+  return %0 : tensor<32x96xf32>
+}
@@ -0,0 +1,17 @@
+// RUN: sdy_opt %s -mlir-very-unsafe-disable-verifier-on-parsing -sdy-import-pipeline='canonicalize-shardings=true' 2>&1 | FileCheck %s
+// RUN: sdy_opt %s -mlir-very-unsafe-disable-verifier-on-parsing -sdy-import-pipeline='canonicalize-shardings=true fuse-import-passes=true' 2>&1 | FileCheck %s
+
+sdy.mesh @mesh = <["x"=4, "y"=2]>
+
+// The shardings are canonicalized before the pass manager first verifies the
+// module, so non-canonical shardings don't fail verification.
+// CHECK-LABEL: func @non_canonical_shardings(
+// CHECK-SAME:    %arg0: tensor<8x8xf32> {sdy.sharding = #sdy.sharding<@mesh, [{"x"}, {}], replicated={"y"}>}
+func.func @non_canonical_shardings(
+    %arg0: tensor<8x8xf32> {sdy.sharding = #sdy.sharding<@mesh, [{"x":(1)2, "x":(2)2}, {}], replicated={"y", "y"}>})
+    -> tensor<8x8xf32> {
+  // CHECK-NEXT: %[[NEGATE:.*]] = stablehlo.negate %arg0 {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"y", "x"}, {?}]>]>}
+  // CHECK-NEXT: return %[[NEGATE]]
+  %0 = stablehlo.negate %arg0 {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"y", "x":(1)2, "x":(2)2}, {?}]>]>} : tensor<8x8xf32>
+  return %0 : tensor<8x8xf32>
+}
@@ -0,0 +1,33 @@
+// RUN: sdy_opt %s -emit-bytecode | sdy_opt --sdy-lazy-load-function-bodies -sdy-lift-inlined-meshes | FileCheck %s
+// RUN: not sdy_opt %s --sdy-lazy-load-function-bodies -split-input-file 2>&1 | FileCheck %s --check-prefix=UNSUPPORTED
+// RUN: not sdy_opt %s --sdy-lazy-load-function-bodies -verify-diagnostics 2>&1 | FileCheck %s --check-prefix=UNSUPPORTED
+// RUN: not sdy_opt %s --sdy-lazy-load-function-bodies -emit-bytecode -emit-bytecode-version=1 2>&1 | FileCheck %s --check-prefix=UNSUPPORTED
+
+// UNSUPPORTED: --sdy-lazy-load-function-bodies can't be combined with
+
+// The body of @unreachable is never read, so its inlined mesh isn't lifted.
+
+// CHECK-NOT: sdy.mesh @mesh_0
+// CHECK:     sdy.mesh @mesh = <["x"=2, "y"=4]>
+// CHECK-NOT: sdy.mesh
+
+// CHECK-LABEL: func @main(
+func.func @main(%arg0: tensor<8x8xf32>) -> tensor<8x8xf32> {
+  // CHECK-NEXT: call @reachable(%arg0)
+  %0 = call @reachable(%arg0) : (tensor<8x8xf32>) -> tensor<8x8xf32>
+  return %0 : tensor<8x8xf32>
+}
+
+// CHECK-LABEL: func private @reachable(
+// CHECK-SAME:    %arg0: tensor<8x8xf32> {sdy.sharding = #sdy.sharding<@mesh, [{"x"}, {}]>})
+func.func private @reachable(%arg0: tensor<8x8xf32> {sdy.sharding = #sdy.sharding<mesh<["x"=2, "y"=4]>, [{"x"}, {}]>}) -> tensor<8x8xf32> {
+  // CHECK-NEXT: stablehlo.add %arg0, %arg0
+  %0 = stablehlo.add %arg0, %arg0 : tensor<8x8xf32>
+  return %0 : tensor<8x8xf32>
+}
+
+// CHECK-NOT: func private @unreachable
+func.func private @unreachable(%arg0: tensor<8x8xf32> {sdy.sharding = #sdy.sharding<mesh<["x"=4]>, [{"x"}, {}]>}) -> tensor<8x8xf32> {
+  %0 = stablehlo.add %arg0, %arg0 : tensor<8x8xf32>
+  return %0 : tensor<8x8xf32>
+}
@@ -197,3 +197,30 @@ func.func @named_computation(%arg0: tensor<16x32xf32>, %arg1: tensor<16x32xf32>)
   } : (tensor<16x32xf32>, tensor<16x32xf32>) -> tensor<16x32xf32>
   func.return %0: tensor<16x32xf32>
 }
+
+// -----
+
+// CHECK: sdy.mesh @mesh = <["y"=2]>
+// CHECK-NEXT: sdy.mesh @mesh_0 = <["x"=4]>
+// CHECK-NEXT: sdy.mesh @mesh_1 = <["z"=8]>
+
+// CHECK-LABEL: func @inlined_meshes_in_multiple_funcs_first
+// CHECK-SAME:    %arg0: tensor<8x8xf32> {sdy.sharding = #sdy.sharding<@mesh, [{"y"}, {}]>}
+// CHECK-SAME:    -> (tensor<8x8xf32> {sdy.sharding = #sdy.sharding<@mesh_0, [{}, {"x"}]>})
+func.func @inlined_meshes_in_multiple_funcs_first(
+    %arg0: tensor<8x8xf32> {sdy.sharding = #sdy.sharding<mesh<["y"=2]>, [{"y"}, {}]>})
+    -> (tensor<8x8xf32> {sdy.sharding = #sdy.sharding<mesh<["x"=4]>, [{}, {"x"}]>}) {
+  // CHECK-NEXT: stablehlo.negate %arg0 {sdy.sharding = #sdy.sharding_per_value<[<@mesh_0, [{"x"}, {}]>]>}
+  %0 = stablehlo.negate %arg0 {sdy.sharding = #sdy.sharding_per_value<[<mesh<["x"=4]>, [{"x"}, {}]>]>} : tensor<8x8xf32>
+  return %0 : tensor<8x8xf32>
+}
+
+// CHECK-LABEL: func @inlined_meshes_in_multiple_funcs_second
+// CHECK-SAME:    %arg0: tensor<8x8xf32> {sdy.sharding = #sdy.sharding<@mesh_1, [{"z"}, {}]>}
+func.func @inlined_meshes_in_multiple_funcs_second(
+    %arg0: tensor<8x8xf32> {sdy.sharding = #sdy.sharding<mesh<["z"=8]>, [{"z"}, {}]>})
+    -> tensor<8x8xf32> {
+  // CHECK-NEXT: stablehlo.abs %arg0 {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{}, {"y"}]>]>}
+  %0 = stablehlo.abs %arg0 {sdy.sharding = #sdy.sharding_per_value<[<mesh<["y"=2]>, [{}, {"y"}]>]>} : tensor<8x8xf32>
+  return %0 : tensor<8x8xf32>
+}
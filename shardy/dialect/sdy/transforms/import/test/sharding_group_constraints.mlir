@@ -1,4 +1,5 @@
 // RUN: sdy_opt %s -split-input-file -sdy-sharding-group-import -verify-diagnostics
+// RUN: sdy_opt %s -split-input-file -sdy-fused-import -verify-diagnostics
 
 sdy.mesh @mesh = <["a"=2, "b"=2]>
 
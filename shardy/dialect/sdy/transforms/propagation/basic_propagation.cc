@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "shardy/dialect/sdy/transforms/propagation/basic_propagation.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <functional>
@@ -22,9 +23,15 @@ limitations under the License.
 #include <optional>
 #include <utility>
 
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/Sequence.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Threading.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/Block.h"
 #include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/BuiltinTypes.h"
@@ -34,16 +41,21 @@ limitations under the License.
 #include "mlir/IR/OpDefinition.h"
 #include "mlir/IR/Operation.h"
 #include "mlir/IR/PatternMatch.h"
+#include "mlir/IR/Region.h"
 #include "mlir/IR/SymbolTable.h"
+#include "mlir/IR/Threading.h"
 #include "mlir/IR/Value.h"
 #include "mlir/IR/ValueRange.h"
 #include "mlir/IR/Visitors.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassRegistry.h"
+#include "mlir/Rewrite/FrozenRewritePatternSet.h"
+#include "mlir/Rewrite/PatternApplicator.h"
 #include "mlir/Support/LLVM.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 #include "shardy/common/file_utils.h"
+#include "shardy/common/tracing.h"
 #include "shardy/dialect/sdy/ir/data_flow_utils.h"
 #include "shardy/dialect/sdy/ir/dialect.h"
 #include "shardy/dialect/sdy/ir/utils.h"
@@ -51,6 +63,7 @@ limitations under the License.
 #include "shardy/dialect/sdy/transforms/propagation/factor_propagation.h"
 #include "shardy/dialect/sdy/transforms/propagation/op_sharding_rule_builder.h"
 #include "shardy/dialect/sdy/transforms/propagation/op_sharding_rule_registry.h"
+#include "shardy/dialect/sdy/transforms/propagation/propagation_statistics.h"
 #include "shardy/dialect/sdy/transforms/propagation/sharding_group_map.h"
 #include "shardy/dialect/sdy/transforms/propagation/sharding_projection.h"
 
@@ -102,7 +115,14 @@ void notifyUsersModified(Value value,
 void notifyShardingModified(Value value,
                             NotifyOpModifiedCallback notifyOpModified) {
   if (auto dataFlowEdge = value.getDefiningOp<DataFlowEdgeOp>()) {
-    for (Value nonEdgeOwnerTarget : getNonEdgeOwnerTargets(dataFlowEdge)) {
+    for (Value nonEdgeOwnerTarget :
+         getNonEdgeOwnerTargets(dataFlowEdge.getInput())) {
+      notifyUsersModified(nonEdgeOwnerTarget, notifyOpModified);
+    }
+  } else if (getDataFlowEdgeOwner(value) == value) {
+    // `value` is the owner of a data-flow edge that doesn't have an
+    // `sdy.data_flow_edge`, so it holds the sharding of all targets.
+    for (Value nonEdgeOwnerTarget : getNonEdgeOwnerTargets(value)) {
       notifyUsersModified(nonEdgeOwnerTarget, notifyOpModified);
     }
   }
@@ -133,12 +153,14 @@ bool updateTensorSharding(
     TensorMappingAttr tensorMapping, ArrayRef<int64_t> factorSizes,
     StringRef meshName, MeshAttr mesh, Value modifiedValue,
     const ShardingGroupMap& shardingGroupMap,
-    std::optional<NotifyOpModifiedCallback> notifyOpModified) {
+    std::optional<NotifyOpModifiedCallback> notifyOpModified,
+    PropagationStatistics& statistics) {
   // We can assume `modifiedValue` exists since we are updating its sharding.
   assert(modifiedValue && "modified value should exist");
   TensorShardingAttr newSharding =
       tensorFactorShardings.createTensorShardingAttr(
           mesh.getContext(), tensorMapping, factorSizes, meshName, mesh);
+  ++statistics.numShardingAttrsCreated;
   // `oldTensorSharding` may be null if there is no sharding, in which case we
   // check if `newSharding` is empty.
   // TODO(tomnatan): remove this checking if the new sharding equals the old
@@ -167,6 +189,7 @@ bool updateTensorSharding(
       continue;
     }
     setSharding(groupValue, newSharding);
+    ++statistics.numShardingGroupUpdates;
     if (notifyOpModified) {
       notifyShardingModified(groupValue, *notifyOpModified);
     }
@@ -189,14 +212,15 @@ void updateTensorShardings(
     ArrayRef<TensorMappingAttr> tensorMappings, ArrayRef<int64_t> factorSizes,
     BitVector& updateTensor, StringRef meshName, MeshAttr mesh,
     const ShardingGroupMap& shardingGroupMap,
-    std::optional<NotifyOpModifiedCallback> notifyOpModified) {
+    std::optional<NotifyOpModifiedCallback> notifyOpModified,
+    PropagationStatistics& statistics) {
   for (int64_t index : updateTensor.set_bits()) {
     if (!updateTensorSharding(
             tensorShardings[index],
             std::bind(setTensorShardingCallback, std::placeholders::_1, index),
             tensorFactorShardings[index], tensorMappings[index], factorSizes,
             meshName, mesh, getShardableValue(tensors[index]), shardingGroupMap,
-            notifyOpModified)) {
+            notifyOpModified, statistics)) {
       updateTensor.reset(index);
     }
   }
@@ -213,17 +237,18 @@ void updateTensorShardings(
     const ShardingProjection& shardingProjection, BitVector& updateOperand,
     BitVector& updateResult, StringRef meshName, MeshAttr mesh,
     const ShardingGroupMap& shardingGroupMap,
-    std::optional<NotifyOpModifiedCallback> notifyOpModified) {
+    std::optional<NotifyOpModifiedCallback> notifyOpModified,
+    PropagationStatistics& statistics) {
   updateTensorShardings(operands, operandShardings, setOperandShardingCallback,
                         shardingProjection.getOperands(),
                         shardingRule.getOperandMappings(),
                         shardingRule.getFactorSizes(), updateOperand, meshName,
-                        mesh, shardingGroupMap, notifyOpModified);
+                        mesh, shardingGroupMap, notifyOpModified, statistics);
   updateTensorShardings(results, resultShardings, setResultShardingCallback,
                         shardingProjection.getResults(),
                         shardingRule.getResultMappings(),
                         shardingRule.getFactorSizes(), updateResult, meshName,
-                        mesh, shardingGroupMap, notifyOpModified);
+                        mesh, shardingGroupMap, notifyOpModified, statistics);
 }
 
 // Propagates tensor shardings of the given `operands` and `results` according
@@ -241,7 +266,8 @@ LogicalResult propagateTensorShardings(
     OpShardingRuleAttr shardingRule, PropagationDirection direction,
     const FactorPropagation& factorPropagation,
     const ShardingGroupMap& shardingGroupMap, bool conservativePropagation,
-    Operation* op, const SymbolTable& symbolTable, PatternRewriter* rewriter) {
+    Operation* op, const SymbolTable& symbolTable, PatternRewriter* rewriter,
+    PropagationStatistics& statistics) {
   std::optional<StringRef> meshName =
       getCommonMeshName(operandShardings, resultShardings, symbolTable);
   if (!meshName.has_value()) {
@@ -258,6 +284,7 @@ LogicalResult propagateTensorShardings(
 
   ShardingProjection shardingProjection = ShardingProjection::build(
       operandShardings, resultShardings, shardingRule, mesh);
+  ++statistics.numProjectionsBuilt;
 
   auto [updateOperand, updateResult] =
       factorPropagation.propagateFactorShardings(
@@ -279,15 +306,24 @@ LogicalResult propagateTensorShardings(
     };
   }
 
-  op->getContext()->executeAction<SourceShardingAction>(
-      [&, &updateOperand = updateOperand, &updateResult = updateResult]() {
-        updateTensorShardings(
-            operands, results, operandShardings, resultShardings,
-            setOperandShardingCallback, setResultShardingCallback, shardingRule,
-            shardingProjection, updateOperand, updateResult, meshName.value(),
-            mesh, shardingGroupMap, notifyOpModified);
-      },
-      /*IRUnits=*/{op}, operands, results, operandShardings, resultShardings);
+  auto updateShardings = [&, &updateOperand = updateOperand,
+                          &updateResult = updateResult]() {
+    updateTensorShardings(operands, results, operandShardings, resultShardings,
+                          setOperandShardingCallback, setResultShardingCallback,
+                          shardingRule, shardingProjection, updateOperand,
+                          updateResult, meshName.value(), mesh,
+                          shardingGroupMap, notifyOpModified, statistics);
+  };
+  // Only wrap the update in a `SourceShardingAction` if a handler is
+  // registered (i.e., sharding origins are being debugged), to avoid the
+  // overhead of creating and dispatching the action otherwise.
+  if (op->getContext()->hasActionHandler()) {
+    op->getContext()->executeAction<SourceShardingAction>(
+        updateShardings,
+        /*IRUnits=*/{op}, operands, results, operandShardings, resultShardings);
+  } else {
+    updateShardings();
+  }
 
   bool anyUpdated = updateOperand.any() || updateResult.any();
   if (rewriter && !anyUpdated) {
@@ -307,7 +343,7 @@ LogicalResult propagateTensorShardings(
     OpShardingRuleAttr shardingRule, Operation* op,
     const SymbolTable& symbolTable, PatternRewriter* rewriter,
     const FactorPropagation& factorPropagation,
-    const ShardingGroupMap& shardingGroupMap,
+    const ShardingGroupMap& shardingGroupMap, PropagationStatistics& statistics,
     PropagationDirection direction = PropagationDirection::BOTH,
     bool conservativePropagation = false) {
   return propagateTensorShardings(
@@ -319,7 +355,7 @@ LogicalResult propagateTensorShardings(
         setResultShardingCallback(sharding);
       },
       shardingRule, direction, factorPropagation, shardingGroupMap,
-      conservativePropagation, op, symbolTable, rewriter);
+      conservativePropagation, op, symbolTable, rewriter, statistics);
 }
 
 // Same as the overload above, except the operand and result shardings are
@@ -328,7 +364,7 @@ LogicalResult propagateTensorShardings(
     ValueRange operands, ValueRange results, OpShardingRuleAttr shardingRule,
     Operation* op, const SymbolTable& symbolTable, PatternRewriter& rewriter,
     const FactorPropagation& factorPropagation,
-    const ShardingGroupMap& shardingGroupMap,
+    const ShardingGroupMap& shardingGroupMap, PropagationStatistics& statistics,
     PropagationDirection direction = PropagationDirection::BOTH,
     bool conservativePropagation = false) {
   return propagateTensorShardings(
@@ -340,7 +376,7 @@ LogicalResult propagateTensorShardings(
         setSharding(results[index], sharding);
       },
       shardingRule, direction, factorPropagation, shardingGroupMap,
-      conservativePropagation, op, symbolTable, &rewriter);
+      conservativePropagation, op, symbolTable, &rewriter, statistics);
 }
 
 // Propagates the shardings between the operands of the `funcOp`'s terminator
@@ -348,7 +384,8 @@ LogicalResult propagateTensorShardings(
 LogicalResult propagateFuncResults(FuncOp funcOp,
                                    const SymbolTable& symbolTable,
                                    const FactorPropagation& factorPropagation,
-                                   const ShardingGroupMap& shardingGroupMap) {
+                                   const ShardingGroupMap& shardingGroupMap,
+                                   PropagationStatistics& statistics) {
   for (OpOperand& returnOperand : getBodyTerminatorOpOperands(funcOp)) {
     Value returnValue = returnOperand.get();
     auto tensorType = dynCastStaticShapedType(returnValue.getType());
@@ -381,7 +418,7 @@ LogicalResult propagateFuncResults(FuncOp funcOp,
         // result attrs as an identity op. Create an equivalent sharding
         // rule.
         createIdentityShardingRule(tensorType), funcOp, symbolTable,
-        /*rewriter=*/nullptr, factorPropagation, shardingGroupMap);
+        /*rewriter=*/nullptr, factorPropagation, shardingGroupMap, statistics);
   }
   return success();
 }
@@ -391,10 +428,11 @@ LogicalResult propagateFuncResults(FuncOp funcOp,
 LogicalResult propagateFuncResults(ModuleOp moduleOp,
                                    const SymbolTable& symbolTable,
                                    const FactorPropagation& factorPropagation,
-                                   const ShardingGroupMap& shardingGroupMap) {
+                                   const ShardingGroupMap& shardingGroupMap,
+                                   PropagationStatistics& statistics) {
   for (auto funcOp : moduleOp.getOps<FuncOp>()) {
     if (failed(propagateFuncResults(funcOp, symbolTable, factorPropagation,
-                                    shardingGroupMap))) {
+                                    shardingGroupMap, statistics))) {
       return failure();
     }
   }
@@ -409,13 +447,15 @@ class PropagateRegisteredOp : public RewritePattern {
       MLIRContext* context, const SymbolTable& symbolTable,
       GetDirectionToPropagateFn getDirectionToPropagate,
       bool conservativePropagation, const FactorPropagation& factorPropagation,
-      const ShardingGroupMap& shardingGroupMap)
+      const ShardingGroupMap& shardingGroupMap,
+      PropagationStatistics& statistics)
       : RewritePattern(MatchAnyOpTypeTag(), /*benefit=*/1, context),
         symbolTable(symbolTable),
         getDirectionToPropagate(getDirectionToPropagate),
         conservativePropagation(conservativePropagation),
         factorPropagation(factorPropagation),
-        shardingGroupMap(shardingGroupMap) {}
+        shardingGroupMap(shardingGroupMap),
+        statistics(statistics) {}
 
   LogicalResult matchAndRewrite(Operation* op,
                                 PatternRewriter& rewriter) const override {
@@ -436,10 +476,12 @@ class PropagateRegisteredOp : public RewritePattern {
       });
     }
 
-    return propagateTensorShardings(op->getOperands(), op->getResults(),
-                                    shardingRule, op, symbolTable, rewriter,
-                                    factorPropagation, shardingGroupMap,
-                                    direction, conservativePropagation);
+    return statistics.recordVisit(op, [&]() {
+      return propagateTensorShardings(
+          op->getOperands(), op->getResults(), shardingRule, op, symbolTable,
+          rewriter, factorPropagation, shardingGroupMap, statistics, direction,
+          conservativePropagation);
+    });
   }
 
  private:
@@ -448,8 +490,44 @@ class PropagateRegisteredOp : public RewritePattern {
   bool conservativePropagation;
   const FactorPropagation& factorPropagation;
   const ShardingGroupMap& shardingGroupMap;
+  PropagationStatistics& statistics;
 };
 
+// Propagates shardings between the sources and targets of the data-flow edge
+// of `edgeOwner`.
+//
+// The sharding of all targets is held by `shardableValue`, which is either the
+// result of the `sdy.data_flow_edge` of `edgeOwner`, or `edgeOwner` itself if
+// the edge doesn't have an `sdy.data_flow_edge`.
+LogicalResult propagateDataFlowEdge(Value edgeOwner, Value shardableValue,
+                                    Operation* op,
+                                    const SymbolTable& symbolTable,
+                                    const FactorPropagation& factorPropagation,
+                                    const ShardingGroupMap& shardingGroupMap,
+                                    PatternRewriter& rewriter,
+                                    PropagationStatistics& statistics) {
+  SmallVector<Value> sources = getDataFlowSources(edgeOwner);
+  return propagateTensorShardings(
+      sources, shardableValue, getShardings(sources),
+      transformTargetSharding(
+          edgeOwner, getSharding(shardableValue),
+          DataFlowShardingTransformType::kBeforeEdgePropagation),
+      [&](TensorShardingAttr sharding, int64_t index) {
+        setSharding(sources[index], sharding);
+      },
+      [&](TensorShardingAttr sharding, int64_t _) {
+        setSharding(shardableValue,
+                    transformTargetSharding(
+                        edgeOwner, sharding,
+                        DataFlowShardingTransformType::kAfterEdgePropagation));
+      },
+      createIdentityShardingRule(cast<ShapedType>(edgeOwner.getType()),
+                                 sources.size()),
+      PropagationDirection::BOTH, factorPropagation, shardingGroupMap,
+      /*conservativePropagation=*/false, op, symbolTable, &rewriter,
+      statistics);
+}
+
 // Propagates shardings between the sources and targets of an
 // `sdy.data_flow_edge`.
 //
@@ -459,41 +537,144 @@ class PropagateDataFlowEdgeOp : public OpRewritePattern<DataFlowEdgeOp> {
   explicit PropagateDataFlowEdgeOp(MLIRContext* context,
                                    const SymbolTable& symbolTable,
                                    const FactorPropagation& factorPropagation,
-                                   const ShardingGroupMap& shardingGroupMap)
+                                   const ShardingGroupMap& shardingGroupMap,
+                                   PropagationStatistics& statistics)
       : OpRewritePattern<DataFlowEdgeOp>(context),
         symbolTable(symbolTable),
         factorPropagation(factorPropagation),
-        shardingGroupMap(shardingGroupMap) {}
+        shardingGroupMap(shardingGroupMap),
+        statistics(statistics) {}
 
   LogicalResult matchAndRewrite(DataFlowEdgeOp dataFlowEdgeOp,
                                 PatternRewriter& rewriter) const override {
-    SmallVector<Value> sources = getDataFlowSources(dataFlowEdgeOp);
-    // The sharding of `dataFlowEdgeOp.getResult()` is the sharding of all
-    // targets.
-    return propagateTensorShardings(
-        sources, dataFlowEdgeOp.getResult(), getShardings(sources),
-        transformTargetSharding(
-            dataFlowEdgeOp, dataFlowEdgeOp.getShardingAttr(),
-            DataFlowShardingTransformType::kBeforeEdgePropagation),
-        [&](TensorShardingAttr sharding, int64_t index) {
-          setSharding(sources[index], sharding);
-        },
-        [&](TensorShardingAttr sharding, int64_t _) {
-          dataFlowEdgeOp.setShardingAttr(transformTargetSharding(
-              dataFlowEdgeOp, sharding,
-              DataFlowShardingTransformType::kAfterEdgePropagation));
-        },
-        createIdentityShardingRule(cast<ShapedType>(dataFlowEdgeOp.getType()),
-                                   sources.size()),
-        PropagationDirection::BOTH, factorPropagation, shardingGroupMap,
-        /*conservativePropagation=*/false, dataFlowEdgeOp, symbolTable,
-        &rewriter);
+    return statistics.recordVisit(dataFlowEdgeOp, [&]() {
+      return propagateDataFlowEdge(
+          dataFlowEdgeOp.getInput(), dataFlowEdgeOp.getResult(),
+          dataFlowEdgeOp, symbolTable, factorPropagation, shardingGroupMap,
+          rewriter, statistics);
+    });
+  }
+
+ private:
+  const SymbolTable& symbolTable;
+  const FactorPropagation& factorPropagation;
+  const ShardingGroupMap& shardingGroupMap;
+  PropagationStatistics& statistics;
+};
+
+// Propagates shardings through the data-flow edges of a data-flow op (e.g.
+// `stablehlo::WhileOp`) that don't have an `sdy.data_flow_edge`, in which case
+// the edge owners hold the sharding of all targets.
+//
+// All edges of the op are propagated in a single visit. Propagating an edge
+// doesn't add the op itself back to the worklist, so if it updates the owner or
+// a source of another edge of the op (e.g., a while body that returns one block
+// argument in place of another), the latter is propagated again in the same
+// visit. Only the edges whose owner or sources changed are propagated again.
+class PropagateImplicitDataFlowEdges : public RewritePattern {
+ public:
+  explicit PropagateImplicitDataFlowEdges(
+      MLIRContext* context, const SymbolTable& symbolTable,
+      const FactorPropagation& factorPropagation,
+      const ShardingGroupMap& shardingGroupMap,
+      PropagationStatistics& statistics)
+      : RewritePattern(MatchAnyOpTypeTag(), /*benefit=*/1, context),
+        symbolTable(symbolTable),
+        factorPropagation(factorPropagation),
+        shardingGroupMap(shardingGroupMap),
+        statistics(statistics) {}
+
+  LogicalResult matchAndRewrite(Operation* op,
+                                PatternRewriter& rewriter) const override {
+    if (!isDataFlowOp(op)) {
+      return rewriter.notifyMatchFailure(op, [](Diagnostic& diag) {
+        diag << "op isn't a data-flow op";
+      });
+    }
+    SmallVector<Value> edgeOwners;
+    auto addIfImplicit = [&](Value edgeOwner) {
+      // Same as `sdy-add-data-flow-edges`, we skip edges of non-static-shaped
+      // types, e.g., tokens.
+      if (isStaticShapedType(edgeOwner.getType()) &&
+          !DataFlowEdgeOp::getDataFlowEdgeUser(edgeOwner)) {
+        edgeOwners.push_back(edgeOwner);
+      }
+    };
+    llvm::for_each(getDataFlowEdgeBlockArgumentOwners(op), addIfImplicit);
+    llvm::for_each(getDataFlowEdgeResultOwners(op), addIfImplicit);
+    if (edgeOwners.empty()) {
+      return rewriter.notifyMatchFailure(op, [](Diagnostic& diag) {
+        diag << "all data-flow edges have an sdy.data_flow_edge";
+      });
+    }
+
+    return statistics.recordVisit(op, [&]() {
+      // The values whose sharding each edge reads and updates: its owner,
+      // which holds the sharding of all targets, and the shardable values of
+      // its sources. Each of these values, and the other values in its
+      // sharding group, are mapped to the edges that depend on them.
+      SmallVector<SmallVector<Value>> valuesPerEdge;
+      valuesPerEdge.reserve(edgeOwners.size());
+      llvm::DenseMap<Value, SmallVector<int64_t>> edgesPerValue;
+      for (auto [edgeIndex, edgeOwner] : llvm::enumerate(edgeOwners)) {
+        SmallVector<Value>& values = valuesPerEdge.emplace_back();
+        values.push_back(edgeOwner);
+        for (Value source : getDataFlowSources(edgeOwner)) {
+          if (Value shardableValue = getShardableValue(source)) {
+            values.push_back(shardableValue);
+          }
+        }
+        for (Value value : values) {
+          edgesPerValue[value].push_back(edgeIndex);
+          for (Value groupMember : shardingGroupMap.getGroupMembers(value)) {
+            edgesPerValue[groupMember].push_back(edgeIndex);
+          }
+        }
+      }
+
+      // We pop edges from the back, so we push them in reverse order to
+      // propagate them in order the first time.
+      SmallVector<int64_t> worklist(
+          llvm::reverse(llvm::seq<int64_t>(edgeOwners.size())));
+      BitVector inWorklist(edgeOwners.size(), true);
+      bool anyUpdated = false;
+      while (!worklist.empty()) {
+        int64_t edgeIndex = worklist.pop_back_val();
+        inWorklist.reset(edgeIndex);
+        Value edgeOwner = edgeOwners[edgeIndex];
+        ArrayRef<Value> values = valuesPerEdge[edgeIndex];
+        SmallVector<TensorShardingAttr> oldShardings = getShardings(values);
+        if (failed(propagateDataFlowEdge(edgeOwner, edgeOwner, op, symbolTable,
+                                         factorPropagation, shardingGroupMap,
+                                         rewriter, statistics))) {
+          continue;
+        }
+        anyUpdated = true;
+        for (auto [value, oldSharding] :
+             llvm::zip_equal(values, oldShardings)) {
+          if (getSharding(value) == oldSharding) {
+            continue;
+          }
+          for (int64_t dependentEdgeIndex : edgesPerValue[value]) {
+            // Propagating an edge once is enough for it to converge, so it
+            // only needs to be propagated again if another edge changes it.
+            if (dependentEdgeIndex != edgeIndex &&
+                !inWorklist.test(dependentEdgeIndex)) {
+              inWorklist.set(dependentEdgeIndex);
+              worklist.push_back(dependentEdgeIndex);
+            }
+          }
+        }
+      }
+      return success(anyUpdated);
+    });
   }
 
  private:
   const SymbolTable& symbolTable;
   const FactorPropagation& factorPropagation;
   const ShardingGroupMap& shardingGroupMap;
+  PropagationStatistics& statistics;
 };
 
 // Propagates through a `PropagationBarrierOp` accounting for the direction in
@@ -504,28 +685,358 @@ class PropagatePropagationBarrier
   explicit PropagatePropagationBarrier(
       MLIRContext* context, const SymbolTable& symbolTable,
       const FactorPropagation& factorPropagation,
-      const ShardingGroupMap& shardingGroupMap)
+      const ShardingGroupMap& shardingGroupMap,
+      PropagationStatistics& statistics)
       : OpRewritePattern<PropagationBarrierOp>(context),
         symbolTable(symbolTable),
         factorPropagation(factorPropagation),
-        shardingGroupMap(shardingGroupMap) {}
+        shardingGroupMap(shardingGroupMap),
+        statistics(statistics) {}
 
   LogicalResult matchAndRewrite(PropagationBarrierOp propagationBarrierOp,
                                 PatternRewriter& rewriter) const override {
-    return propagateTensorShardings(
-        propagationBarrierOp.getInput(), propagationBarrierOp.getResult(),
-        createIdentityShardingRule(
-            cast<RankedTensorType>(propagationBarrierOp.getType())),
-        propagationBarrierOp, symbolTable, rewriter, factorPropagation,
-        shardingGroupMap, propagationBarrierOp.getAllowedDirection());
+    return statistics.recordVisit(propagationBarrierOp, [&]() {
+      return propagateTensorShardings(
+          propagationBarrierOp.getInput(), propagationBarrierOp.getResult(),
+          createIdentityShardingRule(
+              cast<RankedTensorType>(propagationBarrierOp.getType())),
+          propagationBarrierOp, symbolTable, rewriter, factorPropagation,
+          shardingGroupMap, statistics,
+          propagationBarrierOp.getAllowedDirection());
+    });
   }
 
  private:
   const SymbolTable& symbolTable;
   const FactorPropagation& factorPropagation;
   const ShardingGroupMap& shardingGroupMap;
+  PropagationStatistics& statistics;
 };
 
+// Adds the propagation patterns to `patterns`, which record their visits in
+// `statistics`.
+void populatePropagationPatterns(
+    RewritePatternSet& patterns, const SymbolTable& symbolTable,
+    GetDirectionToPropagateFn getDirectionToPropagate,
+    bool conservativePropagation, const FactorPropagation& factorPropagation,
+    const ShardingGroupMap& shardingGroupMap,
+    PropagationStatistics& statistics) {
+  MLIRContext* context = patterns.getContext();
+  patterns.add<PropagateDataFlowEdgeOp, PropagateImplicitDataFlowEdges,
+               PropagatePropagationBarrier>(context, symbolTable,
+                                            factorPropagation, shardingGroupMap,
+                                            statistics);
+  patterns.add<PropagateRegisteredOp>(
+      context, symbolTable, getDirectionToPropagate, conservativePropagation,
+      factorPropagation, shardingGroupMap, statistics);
+}
+
+// Returns the greedy rewrite config used by propagation.
+//
+// Note that we only need a single iteration (and another to confirm
+// convergence), since we make sure ops whose sharding changes are added back to
+// the worklist.
+GreedyRewriteConfig getPropagationRewriteConfig() {
+  GreedyRewriteConfig config;
+  config.useTopDownTraversal = true;
+  config.enableRegionSimplification = mlir::GreedySimplifyRegionLevel::Disabled;
+  return config;
+}
+
+// Applies `patterns` greedily on `ops` only, i.e., ops that aren't in `ops`
+// aren't added to the worklist when they are modified.
+//
+// The ops are visited in the given order, which should be a pre-order walk,
+// to match `applyPatternsAndFoldGreedily` with a top-down traversal.
+LogicalResult applyPropagationPatternsOnOps(
+    SmallVector<Operation*> ops, const FrozenRewritePatternSet& patterns) {
+  GreedyRewriteConfig config = getPropagationRewriteConfig();
+  config.strictMode = GreedyRewriteStrictness::ExistingOps;
+  // The driver pops ops from the back of its initial worklist.
+  std::reverse(ops.begin(), ops.end());
+  return applyOpPatternsAndFold(ops, patterns, config);
+}
+
+// Adds every op that a pattern modifies to a worklist.
+class WorklistListener : public RewriterBase::Listener {
+ public:
+  explicit WorklistListener(function_ref<void(Operation*)> addToWorklist)
+      : addToWorklist(addToWorklist) {}
+
+  void notifyOperationModified(Operation* op) override { addToWorklist(op); }
+
+ private:
+  function_ref<void(Operation*)> addToWorklist;
+};
+
+// Applies `patterns` on `seedOps`, and then on any op in `allowedOps` that is
+// modified by a pattern, until no pattern applies.
+//
+// Unlike `applyPropagationPatternsOnOps`, an op in `allowedOps` is only
+// visited if it is in `seedOps` or was modified, and ops aren't folded. This
+// relies on propagation patterns only updating shardings in place, without
+// creating or erasing ops.
+void applyPropagationPatternsFromOps(
+    ArrayRef<Operation*> seedOps, const llvm::DenseSet<Operation*>& allowedOps,
+    const FrozenRewritePatternSet& patterns) {
+  if (seedOps.empty()) {
+    return;
+  }
+  SmallVector<Operation*> worklist;
+  llvm::DenseSet<Operation*> inWorklist;
+  auto addToWorklist = [&](Operation* op) {
+    if (allowedOps.contains(op) && inWorklist.insert(op).second) {
+      worklist.push_back(op);
+    }
+  };
+  // Ops are popped from the back of the worklist.
+  for (Operation* op : llvm::reverse(seedOps)) {
+    addToWorklist(op);
+  }
+
+  PatternApplicator applicator(patterns);
+  applicator.applyDefaultCostModel();
+  WorklistListener listener(addToWorklist);
+  PatternRewriter rewriter(seedOps.front()->getContext());
+  rewriter.setListener(&listener);
+  while (!worklist.empty()) {
+    Operation* op = worklist.pop_back_val();
+    inWorklist.erase(op);
+    rewriter.setInsertionPoint(op);
+    (void)applicator.matchAndRewrite(op, rewriter);
+  }
+}
+
+// Returns the `sdy.data_flow_edge` ops of the block arguments of
+// `manualComputation`, whose sources are outside of its body.
+SmallVector<Operation*> getBodyArgumentEdges(
+    ManualComputationOp manualComputation) {
+  SmallVector<Operation*> edges;
+  for (BlockArgument blockArg : manualComputation.getBody().getArguments()) {
+    if (DataFlowEdgeOp dataFlowEdge = getDataFlowEdge(blockArg)) {
+      edges.push_back(dataFlowEdge);
+    }
+  }
+  return edges;
+}
+
+// Returns the ops outside of the body of `manualComputation` that propagate
+// the shardings on its boundary, i.e., `manualComputation` itself and the
+// `sdy.data_flow_edge` ops of its block arguments and results.
+SmallVector<Operation*> getBodyBoundaryOps(
+    ManualComputationOp manualComputation) {
+  SmallVector<Operation*> ops = getBodyArgumentEdges(manualComputation);
+  ops.push_back(manualComputation);
+  for (Value result : manualComputation.getResults()) {
+    if (DataFlowEdgeOp dataFlowEdge = getDataFlowEdge(result)) {
+      ops.push_back(dataFlowEdge);
+    }
+  }
+  return ops;
+}
+
+// Returns the shardings on the boundary of the body of `manualComputation`,
+// i.e., of its block arguments and the operands of its terminator.
+SmallVector<TensorShardingAttr> getBodyBoundaryShardings(
+    ManualComputationOp manualComputation) {
+  SmallVector<TensorShardingAttr> shardings;
+  for (BlockArgument blockArg : manualComputation.getBody().getArguments()) {
+    DataFlowEdgeOp dataFlowEdge = getDataFlowEdge(blockArg);
+    shardings.push_back(dataFlowEdge ? dataFlowEdge.getShardingAttr()
+                                     : getSharding(blockArg));
+  }
+  llvm::append_range(
+      shardings,
+      getShardings(
+          manualComputation.getBody().front().getTerminator()->getOperands()));
+  return shardings;
+}
+
+// Returns true if the body of `manualComputation` can be propagated without
+// updating any value outside of it, other than through its boundary, i.e., if
+// no value in the body is in a sharding group.
+bool hasIndependentBody(ManualComputationOp manualComputation,
+                        const ShardingGroupMap& shardingGroupMap) {
+  auto inShardingGroup = [&](Value value) {
+    return !shardingGroupMap.getGroupMembers(value).empty();
+  };
+  if (llvm::any_of(manualComputation.getBody().getArguments(),
+                   inShardingGroup)) {
+    return false;
+  }
+  return !manualComputation.getBody()
+              .walk([&](Operation* op) {
+                if (llvm::any_of(op->getResults(), inShardingGroup) ||
+                    llvm::any_of(op->getRegions(), [&](Region& region) {
+                      return llvm::any_of(region.getArguments(),
+                                          inShardingGroup);
+                    })) {
+                  return WalkResult::interrupt();
+                }
+                return WalkResult::advance();
+              })
+              .wasInterrupted();
+}
+
+// Returns the outermost manual computations in `moduleOp` whose body is
+// independent (see `hasIndependentBody`).
+SmallVector<ManualComputationOp> getIndependentManualComputations(
+    ModuleOp moduleOp, const ShardingGroupMap& shardingGroupMap) {
+  SmallVector<ManualComputationOp> manualComputations;
+  moduleOp.walk<WalkOrder::PreOrder>(
+      [&](ManualComputationOp manualComputation) {
+        if (!hasIndependentBody(manualComputation, shardingGroupMap)) {
+          // A nested manual computation can still be independent.
+          return WalkResult::advance();
+        }
+        manualComputations.push_back(manualComputation);
+        return WalkResult::skip();
+      });
+  return manualComputations;
+}
+
+// Propagates `moduleOp` in rounds, where the bodies of
+// `independentManualComputations` are propagated on multiple threads.
+//
+// Each round has two phases:
+// 1. The ops that aren't in an independent body are propagated, while the
+//    bodies are fixed. This includes the `sdy.data_flow_edge` ops of the block
+//    arguments of each body, as their sources are outside the body. The first
+//    round visits all of these ops, later rounds start from the boundary ops
+//    (see `getBodyBoundaryOps`) of the bodies whose boundary changed in the
+//    previous phase 2, and only visit other ops once they are modified.
+// 2. Each body whose boundary shardings (see `getBodyBoundaryShardings`)
+//    changed since it was last propagated is propagated on its own, in
+//    parallel, while the rest of the module is fixed.
+//
+// The rounds stop once phase 2 leaves the boundary of every body unchanged, or
+// has no body to propagate, as phase 1 can't update any sharding after that.
+LogicalResult propagateWithParallelManualComputations(
+    ModuleOp moduleOp,
+    ArrayRef<ManualComputationOp> independentManualComputations,
+    const FrozenRewritePatternSet& patterns,
+    function_ref<void(RewritePatternSet&, PropagationStatistics&)>
+        populateBodyPatterns,
+    PropagationStatistics& statistics) {
+  MLIRContext* context = moduleOp.getContext();
+  llvm::SmallDenseSet<Operation*> independentOps;
+  for (ManualComputationOp manualComputation : independentManualComputations) {
+    independentOps.insert(manualComputation);
+  }
+  // The boundary shardings of each body after it was last propagated.
+  llvm::DenseMap<Operation*, SmallVector<TensorShardingAttr>>
+      boundaryShardings;
+  // The ops that phase 1 starts from after the first round.
+  SmallVector<Operation*> changedBoundaryOps;
+
+  for (bool firstRound = true;; firstRound = false) {
+    // The ops are collected in every round, as propagation may fold ops.
+    SmallVector<Operation*> outerOps;
+    moduleOp.getBody()->walk<WalkOrder::PreOrder>([&](Operation* op) {
+      outerOps.push_back(op);
+      if (!independentOps.contains(op)) {
+        return WalkResult::advance();
+      }
+      llvm::append_range(
+          outerOps, getBodyArgumentEdges(cast<ManualComputationOp>(op)));
+      return WalkResult::skip();
+    });
+    {
+      TraceScope traceScope("greedy_propagation", "propagation");
+      if (firstRound) {
+        if (failed(applyPropagationPatternsOnOps(std::move(outerOps),
+                                                 patterns))) {
+          return failure();
+        }
+      } else {
+        applyPropagationPatternsFromOps(
+            changedBoundaryOps,
+            llvm::DenseSet<Operation*>(outerOps.begin(), outerOps.end()),
+            patterns);
+      }
+    }
+
+    // Each body records its visits in its own statistics, which are merged
+    // afterwards, as the statistics aren't thread safe.
+    struct BodyPropagation {
+      ManualComputationOp manualComputation;
+      // The boundary shardings of the body right before it is propagated.
+      SmallVector<TensorShardingAttr> boundaryShardings;
+      PropagationStatistics statistics;
+    };
+    SmallVector<BodyPropagation> bodies;
+    for (ManualComputationOp manualComputation :
+         independentManualComputations) {
+      SmallVector<TensorShardingAttr> bodyBoundaryShardings =
+          getBodyBoundaryShardings(manualComputation);
+      auto it = boundaryShardings.find(manualComputation);
+      if (it == boundaryShardings.end() ||
+          it->second != bodyBoundaryShardings) {
+        PropagationStatistics bodyStatistics;
+        bodyStatistics.recordPerOpStatistics =
+            statistics.recordPerOpStatistics;
+        bodies.push_back({manualComputation, std::move(bodyBoundaryShardings),
+                          std::move(bodyStatistics)});
+      }
+    }
+    if (bodies.empty()) {
+      return success();
+    }
+
+    LogicalResult bodiesResult = success();
+    {
+      TraceScope traceScope("manual_computation_bodies", "propagation");
+      bodiesResult = failableParallelForEach(
+          context, bodies, [&](BodyPropagation& body) {
+            Region& bodyRegion = body.manualComputation.getBody();
+            // The `sdy.data_flow_edge` ops of the block arguments are
+            // propagated in phase 1.
+            auto isArgumentEdge = [&](Operation* op) {
+              auto dataFlowEdge = dyn_cast<DataFlowEdgeOp>(op);
+              if (!dataFlowEdge) {
+                return false;
+              }
+              auto blockArg = dyn_cast<BlockArgument>(dataFlowEdge.getInput());
+              return blockArg && blockArg.getParentRegion() == &bodyRegion;
+            };
+            SmallVector<Operation*> bodyOps;
+            bodyRegion.walk<WalkOrder::PreOrder>([&](Operation* op) {
+              if (!isArgumentEdge(op)) {
+                bodyOps.push_back(op);
+              }
+            });
+            RewritePatternSet bodyPatterns(context);
+            populateBodyPatterns(bodyPatterns, body.statistics);
+            return applyPropagationPatternsOnOps(
+                std::move(bodyOps),
+                FrozenRewritePatternSet(std::move(bodyPatterns)));
+          });
+    }
+    for (const BodyPropagation& body : bodies) {
+      statistics.merge(body.statistics);
+    }
+    if (failed(bodiesResult)) {
+      return failure();
+    }
+
+    changedBoundaryOps.clear();
+    for (BodyPropagation& body : bodies) {
+      SmallVector<TensorShardingAttr> newBoundaryShardings =
+          getBodyBoundaryShardings(body.manualComputation);
+      if (newBoundaryShardings != body.boundaryShardings) {
+        llvm::append_range(changedBoundaryOps,
+                           getBodyBoundaryOps(body.manualComputation));
+      }
+      boundaryShardings[body.manualComputation] =
+          std::move(newBoundaryShardings);
+    }
+    if (changedBoundaryOps.empty()) {
+      // The bodies didn't update anything the rest of the module depends on.
+      return success();
+    }
+  }
+}
+
 // The basic propagation pass that uses the default implementation of
 // `BasicPropagationPassImpl`.
 struct BasicPropagationPass
@@ -568,6 +1079,25 @@ PropagationDirection propagateAny(Operation*) {
   return PropagationDirection::BOTH;
 }
 
+void propagateShardingsOnOps(ArrayRef<Operation*> ops,
+                             const SymbolTable& symbolTable,
+                             const ShardingGroupMap& shardingGroupMap,
+                             const FactorPropagation& factorPropagation,
+                             GetDirectionToPropagateFn getDirectionToPropagate,
+                             bool conservativePropagation) {
+  if (ops.empty()) {
+    return;
+  }
+  PropagationStatistics statistics;
+  RewritePatternSet patterns(ops.front()->getContext());
+  populatePropagationPatterns(patterns, symbolTable, getDirectionToPropagate,
+                              conservativePropagation, factorPropagation,
+                              shardingGroupMap, statistics);
+  applyPropagationPatternsFromOps(
+      ops, llvm::DenseSet<Operation*>(ops.begin(), ops.end()),
+      FrozenRewritePatternSet(std::move(patterns)));
+}
+
 LogicalResult BasicPropagationPassImpl::propagate(
     ModuleOp moduleOp, const SymbolTable& symbolTable,
     const ShardingGroupMap& shardingGroupMap,
@@ -576,31 +1106,46 @@ LogicalResult BasicPropagationPassImpl::propagate(
   // Pushes any shardings that exist on the `funcOp` result type attrs to the
   // corresponding values returned in the terminator of the body of `funcOp`.
   if (failed(propagateFuncResults(moduleOp, symbolTable, factorPropagation,
-                                  shardingGroupMap))) {
+                                  shardingGroupMap, propagationStatistics))) {
     return failure();
   }
   MLIRContext* context = moduleOp.getContext();
+  auto populatePatterns = [&](RewritePatternSet& patterns,
+                              PropagationStatistics& statistics) {
+    populatePropagationPatterns(patterns, symbolTable, getDirectionToPropagate,
+                                conservativePropagation, factorPropagation,
+                                shardingGroupMap, statistics);
+  };
   RewritePatternSet patterns(context);
-  patterns.add<PropagateDataFlowEdgeOp, PropagatePropagationBarrier>(
-      context, symbolTable, factorPropagation, shardingGroupMap);
-  patterns.add<PropagateRegisteredOp>(
-      context, symbolTable, getDirectionToPropagate, conservativePropagation,
-      factorPropagation, shardingGroupMap);
-  // Note that we only need a single iteration (and another to confirm
-  // convergence), since we make sure ops whose sharding changes are
-  // added back to the worklist.
-  GreedyRewriteConfig config;
-  config.useTopDownTraversal = true;
-  config.enableRegionSimplification = mlir::GreedySimplifyRegionLevel::Disabled;
-  if (failed(applyPatternsAndFoldGreedily(moduleOp, std::move(patterns),
-                                          config))) {
-    return failure();
+  populatePatterns(patterns, propagationStatistics);
+
+  // The sharding debugging handlers aren't thread safe, so manual computations
+  // are propagated with the rest of the module when they are enabled.
+  SmallVector<ManualComputationOp> independentManualComputations;
+  if (parallelManualComputations && context->isMultithreadingEnabled() &&
+      !debugShardingOrigins && !debugEdgeSourceSharding) {
+    independentManualComputations =
+        getIndependentManualComputations(moduleOp, shardingGroupMap);
+  }
+  if (!independentManualComputations.empty()) {
+    if (failed(propagateWithParallelManualComputations(
+            moduleOp, independentManualComputations,
+            FrozenRewritePatternSet(std::move(patterns)), populatePatterns,
+            propagationStatistics))) {
+      return failure();
+    }
+  } else {
+    TraceScope traceScope("greedy_propagation", "propagation");
+    if (failed(applyPatternsAndFoldGreedily(moduleOp, std::move(patterns),
+                                            getPropagationRewriteConfig()))) {
+      return failure();
+    }
   }
 
   // Pushes any shardings from the values returned in the terminator of the body
   // of `funcOp` to the corresponding `funcOp` result type attrs.
   if (failed(propagateFuncResults(moduleOp, symbolTable, factorPropagation,
-                                  shardingGroupMap))) {
+                                  shardingGroupMap, propagationStatistics))) {
     return failure();
   }
   return success();
@@ -617,6 +1162,12 @@ LogicalResult BasicPropagationPassImpl::propagate(
 void BasicPropagationPassImpl::runOnOperation() {
   ModuleOp moduleOp = getOperation();
   MLIRContext& context = getContext();
+  propagationStatistics.clear();
+  // The per-op statistics are only saved in the dump directory.
+  propagationStatistics.recordPerOpStatistics = !dumpDirectory.empty();
+  if (!traceFile.empty()) {
+    enableTracing(traceFile);
+  }
 
   // Prepare debugging handler for sharding origins and edge sources.
   ShardingDebugMappings mappings(debugShardingOrigins, debugEdgeSourceSharding);
@@ -644,16 +1195,42 @@ void BasicPropagationPassImpl::runOnOperation() {
   context.registerActionHandler(nullptr);
   handler.saveOnModule(moduleOp);
 
-  saveModuleOp(moduleOp, dumpDirectory, "sdy_module_after_propagation");
+  saveModuleOp(moduleOp, dumpDirectory, "sdy_module_after_propagation",
+               getSaveModuleOpOptions());
+
+  numOpsVisited += propagationStatistics.numOpsVisited;
+  numVisitsWithUpdates += propagationStatistics.numVisitsWithUpdates;
+  numProjectionsBuilt += propagationStatistics.numProjectionsBuilt;
+  numShardingAttrsCreated += propagationStatistics.numShardingAttrsCreated;
+  numShardingGroupUpdates += propagationStatistics.numShardingGroupUpdates;
+  saveJson(propagationStatistics.toJson(), dumpDirectory,
+           "sdy_propagation_statistics");
 }
 
 void BasicPropagationPassImpl::setPropagationOptions(
     const PropagationOptions& options) {
   keepShardingRules = options.keepShardingRules;
   dumpDirectory = options.dumpDirectory.str();
+  dumpBytecode = options.saveModuleOpOptions.bytecode;
+  dumpCompress = options.saveModuleOpOptions.compress;
+  dumpElideElementsAttrsLargerThan =
+      options.saveModuleOpOptions.elideElementsAttrsLargerThan;
+  dumpAsync = options.saveModuleOpOptions.async;
   conservativePropagation = options.conservativePropagation;
   debugShardingOrigins = options.debugShardingOrigins;
   debugEdgeSourceSharding = options.debugEdgeSourceSharding;
+  dumpShardingDeltas = options.dumpShardingDeltas;
+  traceFile = options.traceFile.str();
+  parallelManualComputations = options.parallelManualComputations;
+}
+
+SaveModuleOpOptions BasicPropagationPassImpl::getSaveModuleOpOptions() const {
+  SaveModuleOpOptions options;
+  options.bytecode = dumpBytecode;
+  options.compress = dumpCompress;
+  options.elideElementsAttrsLargerThan = dumpElideElementsAttrsLargerThan;
+  options.async = dumpAsync;
+  return options;
 }
 
 std::unique_ptr<Pass> createBasicPropagationPass(
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef SHARDY_DIALECT_SDY_TRANSFORMS_PROPAGATION_BASIC_PROPAGATION_H_
 #define SHARDY_DIALECT_SDY_TRANSFORMS_PROPAGATION_BASIC_PROPAGATION_H_
 
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
@@ -27,9 +28,11 @@ limitations under the License.
 #include "mlir/Pass/Pass.h"
 #include "mlir/Support/LLVM.h"
 #include "mlir/Support/LogicalResult.h"
+#include "shardy/common/save_module_op.h"
 #include "shardy/dialect/sdy/ir/dialect.h"
 #include "shardy/dialect/sdy/transforms/propagation/basic_factor_propagation.h"
 #include "shardy/dialect/sdy/transforms/propagation/factor_propagation.h"
+#include "shardy/dialect/sdy/transforms/propagation/propagation_statistics.h"
 #include "shardy/dialect/sdy/transforms/propagation/sharding_group_map.h"
 
 namespace mlir {
@@ -43,12 +46,32 @@ using GetDirectionToPropagateFn =
 // A function that returns `PropagationDirection::BOTH` for all operations.
 PropagationDirection propagateAny(Operation* op);
 
+// Propagates shardings on `ops` with the same patterns as the propagation
+// passes, where ops that aren't in `ops` are never visited.
+//
+// The ops are visited in the given order, and then each op whose sharding is
+// modified is visited again, until no sharding changes.
+void propagateShardingsOnOps(ArrayRef<Operation*> ops,
+                             const SymbolTable& symbolTable,
+                             const ShardingGroupMap& shardingGroupMap,
+                             const FactorPropagation& factorPropagation,
+                             GetDirectionToPropagateFn getDirectionToPropagate,
+                             bool conservativePropagation);
+
 struct PropagationOptions {
   bool keepShardingRules = false;
   StringRef dumpDirectory = "";
+  SaveModuleOpOptions saveModuleOpOptions;
   bool conservativePropagation = false;
   bool debugShardingOrigins = false;
   bool debugEdgeSourceSharding = false;
+  bool dumpShardingDeltas = false;
+  StringRef traceFile = "";
+  bool deferConstantSplitting = false;
+  bool fuseImportPasses = false;
+  bool fuseExportPasses = false;
+  bool implicitDataFlowEdges = false;
+  bool parallelManualComputations = false;
 };
 
 // The implementation class for the basic propagation pass.
@@ -102,6 +125,9 @@ class BasicPropagationPassImpl : public OperationPass<ModuleOp> {
   // Sets the propagation options declared below.
   void setPropagationOptions(const PropagationOptions& options);
 
+  // Returns the options for saving modules to `dumpDirectory`.
+  SaveModuleOpOptions getSaveModuleOpOptions() const;
+
   Option<bool> keepShardingRules{
       *this, "keep-sharding-rules",
       llvm::cl::desc("whether to keep existing and created op sharding rules"),
@@ -112,6 +138,29 @@ class BasicPropagationPassImpl : public OperationPass<ModuleOp> {
       llvm::cl::desc("where to dump any rewritten modules for debugging"),
       llvm::cl::init("")};
 
+  Option<bool> dumpBytecode{
+      *this, "dump-bytecode",
+      llvm::cl::desc("whether to dump modules as MLIR bytecode instead of "
+                     "text"),
+      llvm::cl::init(false)};
+
+  Option<bool> dumpCompress{
+      *this, "dump-compress",
+      llvm::cl::desc("whether to compress dumped modules with zstd"),
+      llvm::cl::init(false)};
+
+  Option<int64_t> dumpElideElementsAttrsLargerThan{
+      *this, "dump-elide-elements-attrs-larger-than",
+      llvm::cl::desc("elide elements attrs with more elements than this in "
+                     "dumped modules, a negative value disables elision"),
+      llvm::cl::init(-1)};
+
+  Option<bool> dumpAsync{
+      *this, "dump-async",
+      llvm::cl::desc("whether to write dumped modules on a background "
+                     "thread"),
+      llvm::cl::init(false)};
+
   // TODO(b/347180954): remove conservative propagation once the cost model
   // supports split axes and padding.
   Option<bool> conservativePropagation{
@@ -137,6 +186,52 @@ class BasicPropagationPassImpl : public OperationPass<ModuleOp> {
           "was propagated."),
       llvm::cl::init(false)};
 
+  Option<bool> dumpShardingDeltas{
+      *this, "dump-sharding-deltas",
+      llvm::cl::desc(
+          "whether to dump only the sharding changes at each checkpoint (e.g. "
+          "after each user priority) to `module-dump-directory`, instead of "
+          "the entire module. The module before the first checkpoint is still "
+          "dumped in full, and any checkpoint can be reconstructed from it "
+          "with `sdy_reconstruct_module`."),
+      llvm::cl::init(false)};
+
+  Option<std::string> traceFile{
+      *this, "trace-file",
+      llvm::cl::desc(
+          "where to save a Chrome trace event JSON (viewable in Perfetto) "
+          "with spans for each propagation step. Can also be enabled with the "
+          "`SDY_TRACE_FILE` environment variable."),
+      llvm::cl::init("")};
+
+  Option<bool> parallelManualComputations{
+      *this, "parallel-manual-computations",
+      llvm::cl::desc(
+          "whether to propagate the bodies of manual computations on multiple "
+          "threads, in rounds where the shardings on their boundary are "
+          "fixed. Manual computations with a value in a sharding group are "
+          "propagated with the rest of the module."),
+      llvm::cl::init(false)};
+
+  Statistic numOpsVisited{this, "num-ops-visited",
+                          "Number of ops visited by propagation"};
+  Statistic numVisitsWithUpdates{
+      this, "num-visits-with-updates",
+      "Number of op visits that changed at least one sharding"};
+  Statistic numProjectionsBuilt{this, "num-projections-built",
+                                "Number of sharding projections built"};
+  Statistic numShardingAttrsCreated{
+      this, "num-sharding-attrs-created",
+      "Number of sharding attributes created from a sharding projection"};
+  Statistic numShardingGroupUpdates{
+      this, "num-sharding-group-updates",
+      "Number of sharding updates of other members of a sharding group"};
+
+  // Counters collected during the current run of the pass, which are added to
+  // the statistics above at the end of the run, and saved as a JSON file (with
+  // a per-op breakdown) in `dumpDirectory`.
+  PropagationStatistics propagationStatistics;
+
  private:
   // This class owns the basic factor propagation strategy.
   BasicFactorPropagation basicFactorPropagation;
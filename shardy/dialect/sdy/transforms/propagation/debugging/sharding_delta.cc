@@ -0,0 +1,214 @@
+/* Copyright 2024 The Shardy Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "shardy/dialect/sdy/transforms/propagation/debugging/sharding_delta.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <variant>
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+#include "mlir/AsmParser/AsmParser.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Region.h"
+#include "mlir/IR/Value.h"
+#include "mlir/IR/Visitors.h"
+#include "mlir/Support/LLVM.h"
+#include "mlir/Support/LogicalResult.h"
+#include "shardy/dialect/sdy/ir/dialect.h"
+#include "shardy/dialect/sdy/ir/utils.h"
+#include "shardy/dialect/sdy/transforms/common/sharding_walker.h"
+
+namespace mlir {
+namespace sdy {
+
+namespace {
+
+using func::FuncOp;
+
+using ValueToShardingMap = llvm::DenseMap<Value, TensorShardingAttr>;
+using FuncResultToShardingMap =
+    llvm::DenseMap<std::pair<Operation*, int64_t>, TensorShardingAttr>;
+
+// Collects the current shardings of all values and function results in
+// `moduleOp` that have a sharding.
+void collectShardings(ModuleOp moduleOp, ValueToShardingMap& valueShardings,
+                      FuncResultToShardingMap& funcResultShardings) {
+  walkShardings(moduleOp, [&](TensorShardingAttr sharding,
+                              const ValueOrFuncResult& valueOrFuncResult) {
+    if (auto* value = std::get_if<Value>(&valueOrFuncResult)) {
+      // Use `getSharding` rather than the walked sharding, so that
+      // `applyShardingDelta` can use its counterpart `setSharding`.
+      valueShardings[*value] = getSharding(*value);
+    } else {
+      auto [funcOp, resNum] = std::get<FuncResult>(valueOrFuncResult);
+      funcResultShardings[{funcOp, resNum}] = sharding;
+    }
+  });
+}
+
+std::string shardingToString(TensorShardingAttr sharding) {
+  std::string shardingStr;
+  llvm::raw_string_ostream os(shardingStr);
+  sharding.print(os);
+  return shardingStr;
+}
+
+TensorShardingAttr parseSharding(StringRef shardingStr, MLIRContext* context) {
+  return dyn_cast_or_null<TensorShardingAttr>(
+      parseAttribute(shardingStr, context));
+}
+
+}  // namespace
+
+SmallVector<Value> getAllValues(ModuleOp moduleOp) {
+  SmallVector<Value> values;
+  moduleOp.walk<WalkOrder::PreOrder>([&](Operation* op) {
+    for (Region& region : op->getRegions()) {
+      for (Block& block : region) {
+        values.append(block.args_begin(), block.args_end());
+      }
+    }
+    values.append(op->result_begin(), op->result_end());
+  });
+  return values;
+}
+
+ShardingDeltaRecorder::ShardingDeltaRecorder(ModuleOp moduleOp)
+    : moduleOp(moduleOp) {
+  for (auto [index, value] : llvm::enumerate(getAllValues(moduleOp))) {
+    valueToIndex[value] = index;
+  }
+  collectShardings(moduleOp, valueShardings, funcResultShardings);
+}
+
+llvm::json::Value ShardingDeltaRecorder::takeDelta() {
+  ValueToShardingMap newValueShardings;
+  FuncResultToShardingMap newFuncResultShardings;
+  collectShardings(moduleOp, newValueShardings, newFuncResultShardings);
+
+  // Sort the changes by value index and function result, so that the delta is
+  // deterministic.
+  SmallVector<std::pair<int64_t, TensorShardingAttr>> valueChanges;
+  for (auto [value, sharding] : newValueShardings) {
+    if (valueShardings.lookup(value) != sharding) {
+      valueChanges.emplace_back(valueToIndex.at(value), sharding);
+    }
+  }
+  llvm::sort(valueChanges, llvm::less_first());
+
+  SmallVector<std::pair<std::pair<StringRef, int64_t>, TensorShardingAttr>>
+      funcResultChanges;
+  for (auto [funcResult, sharding] : newFuncResultShardings) {
+    if (funcResultShardings.lookup(funcResult) != sharding) {
+      auto [funcOp, resNum] = funcResult;
+      funcResultChanges.push_back(
+          {{cast<FuncOp>(funcOp).getSymName(), resNum}, sharding});
+    }
+  }
+  llvm::sort(funcResultChanges, llvm::less_first());
+
+  llvm::json::Array values;
+  for (auto [index, sharding] : valueChanges) {
+    values.push_back(llvm::json::Array{index, shardingToString(sharding)});
+  }
+  llvm::json::Array funcResults;
+  for (auto [funcResult, sharding] : funcResultChanges) {
+    auto [funcName, resNum] = funcResult;
+    funcResults.push_back(
+        llvm::json::Array{funcName.str(), resNum, shardingToString(sharding)});
+  }
+
+  valueShardings = std::move(newValueShardings);
+  funcResultShardings = std::move(newFuncResultShardings);
+  return llvm::json::Object{
+      {"values", std::move(values)},
+      {"func_results", std::move(funcResults)},
+  };
+}
+
+LogicalResult applyShardingDelta(ModuleOp moduleOp,
+                                 const llvm::json::Value& delta) {
+  MLIRContext* context = moduleOp.getContext();
+  const llvm::json::Object* deltaObject = delta.getAsObject();
+  if (!deltaObject) {
+    return moduleOp.emitError("sharding delta must be a JSON object");
+  }
+
+  if (const llvm::json::Array* values = deltaObject->getArray("values")) {
+    SmallVector<Value> allValues = getAllValues(moduleOp);
+    for (const llvm::json::Value& change : *values) {
+      const llvm::json::Array* entry = change.getAsArray();
+      if (!entry || entry->size() != 2) {
+        return moduleOp.emitError("malformed value entry in sharding delta");
+      }
+      std::optional<int64_t> index = (*entry)[0].getAsInteger();
+      std::optional<StringRef> shardingStr = (*entry)[1].getAsString();
+      if (!index || !shardingStr || *index < 0 ||
+          *index >= static_cast<int64_t>(allValues.size())) {
+        return moduleOp.emitError("invalid value entry in sharding delta");
+      }
+      TensorShardingAttr sharding = parseSharding(*shardingStr, context);
+      if (!sharding) {
+        return moduleOp.emitError("invalid sharding in sharding delta: ")
+               << *shardingStr;
+      }
+      setSharding(allValues[*index], sharding);
+    }
+  }
+
+  if (const llvm::json::Array* funcResults =
+          deltaObject->getArray("func_results")) {
+    for (const llvm::json::Value& change : *funcResults) {
+      const llvm::json::Array* entry = change.getAsArray();
+      if (!entry || entry->size() != 3) {
+        return moduleOp.emitError(
+            "malformed function result entry in sharding delta");
+      }
+      std::optional<StringRef> funcName = (*entry)[0].getAsString();
+      std::optional<int64_t> resNum = (*entry)[1].getAsInteger();
+      std::optional<StringRef> shardingStr = (*entry)[2].getAsString();
+      if (!funcName || !resNum || !shardingStr) {
+        return moduleOp.emitError(
+            "invalid function result entry in sharding delta");
+      }
+      auto funcOp = moduleOp.lookupSymbol<FuncOp>(*funcName);
+      if (!funcOp || *resNum < 0 || *resNum >= funcOp.getNumResults()) {
+        return moduleOp.emitError("unknown function result in sharding delta: ")
+               << *funcName << "#" << *resNum;
+      }
+      TensorShardingAttr sharding = parseSharding(*shardingStr, context);
+      if (!sharding) {
+        return moduleOp.emitError("invalid sharding in sharding delta: ")
+               << *shardingStr;
+      }
+      setFuncResultSharding(funcOp, *resNum, sharding);
+    }
+  }
+
+  return success();
+}
+
+}  // namespace sdy
+}  // namespace mlir
@@ -0,0 +1,91 @@
+/* Copyright 2024 The Shardy Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef SHARDY_DIALECT_SDY_TRANSFORMS_PROPAGATION_DEBUGGING_SHARDING_DELTA_H_
+#define SHARDY_DIALECT_SDY_TRANSFORMS_PROPAGATION_DEBUGGING_SHARDING_DELTA_H_
+
+#include <cstdint>
+#include <utility>
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/JSON.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Value.h"
+#include "mlir/Support/LLVM.h"
+#include "mlir/Support/LogicalResult.h"
+#include "shardy/dialect/sdy/ir/dialect.h"
+
+namespace mlir {
+namespace sdy {
+
+// Records the sharding changes of a module between checkpoints, so that only
+// the changes need to be dumped instead of the entire module.
+//
+// Each delta is a JSON object of the form:
+//
+//   {
+//     "values": [[<value index>, <sharding>], ...],
+//     "func_results": [[<func name>, <result number>, <sharding>], ...]
+//   }
+//
+// where the value index is the position of the value in a pre-order walk of
+// the module (see `getAllValues`), and the sharding is the textual form of the
+// new `TensorShardingAttr`. Propagation never removes a sharding, so only added
+// and updated shardings are recorded.
+//
+// The structure of the module (i.e., its ops and values) must not change during
+// the lifetime of the recorder, only the shardings.
+class ShardingDeltaRecorder {
+ public:
+  // Takes a snapshot of the shardings in `moduleOp`.
+  explicit ShardingDeltaRecorder(ModuleOp moduleOp);
+
+  // Returns the shardings that changed since the previous checkpoint (or the
+  // creation of this recorder), and makes the current shardings the new
+  // checkpoint.
+  llvm::json::Value takeDelta();
+
+ private:
+  using FuncResultKey = std::pair<Operation*, int64_t>;
+
+  ModuleOp moduleOp;
+  llvm::DenseMap<Value, int64_t> valueToIndex;
+  llvm::DenseMap<Value, TensorShardingAttr> valueShardings;
+  llvm::DenseMap<FuncResultKey, TensorShardingAttr> funcResultShardings;
+};
+
+// Returns all values in `moduleOp` in pre-order, where the block arguments of
+// each region of an op come before the results of the op.
+//
+// The index of a value in the returned vector identifies it across different
+// copies of the same module, as long as the structure of the module didn't
+// change.
+SmallVector<Value> getAllValues(ModuleOp moduleOp);
+
+// Applies `delta`, created by `ShardingDeltaRecorder::takeDelta`, to
+// `moduleOp`, which should have the same structure as the module the delta was
+// recorded on.
+//
+// Emits an error and returns failure if `delta` is malformed or refers to a
+// value or function result that doesn't exist in `moduleOp`.
+LogicalResult applyShardingDelta(ModuleOp moduleOp,
+                                 const llvm::json::Value& delta);
+
+}  // namespace sdy
+}  // namespace mlir
+
+#endif  // SHARDY_DIALECT_SDY_TRANSFORMS_PROPAGATION_DEBUGGING_SHARDING_DELTA_H_
@@ -0,0 +1,120 @@
+/* Copyright 2024 The Shardy Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "shardy/dialect/sdy/transforms/propagation/debugging/sharding_delta.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/ScopedPrinter.h"
+#include "mlir/AsmParser/AsmParser.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Diagnostics.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Support/LLVM.h"
+#include "shardy/dialect/sdy/ir/dialect.h"
+#include "shardy/dialect/sdy/ir/register.h"
+#include "shardy/dialect/sdy/ir/utils.h"
+#include <gtest/gtest.h>
+
+namespace mlir {
+namespace sdy {
+namespace {
+
+constexpr StringRef kModule = R"mlir(
+  sdy.mesh @mesh = <["a"=2, "b"=2]>
+
+  func.func @main(%arg0: tensor<8x8xf32> {sdy.sharding = #sdy.sharding<@mesh, [{"a", ?}, {?}]>},
+                  %arg1: tensor<8x8xf32>) -> tensor<8x8xf32> {
+    %0 = stablehlo.add %arg0, %arg1 : tensor<8x8xf32>
+    %1 = stablehlo.multiply %0, %0 : tensor<8x8xf32>
+    return %1 : tensor<8x8xf32>
+  }
+)mlir";
+
+class ShardingDeltaTest : public ::testing::Test {
+ protected:
+  void SetUp() override { loadAllRequiredDialects(&context); }
+
+  TensorShardingAttr parseSharding(StringRef shardingStr) {
+    return cast<TensorShardingAttr>(parseAttribute(shardingStr, &context));
+  }
+
+  MLIRContext context;
+};
+
+TEST_F(ShardingDeltaTest, ApplyDeltasReconstructsCheckpoints) {
+  OwningOpRef<ModuleOp> module = parseSourceString<ModuleOp>(kModule, &context);
+  OwningOpRef<ModuleOp> reconstructed =
+      parseSourceString<ModuleOp>(kModule, &context);
+  ASSERT_TRUE(module && reconstructed);
+
+  auto mainFn = cast<func::FuncOp>(module->lookupSymbol("main"));
+  Operation* addOp = &mainFn.getBody().front().front();
+  ShardingDeltaRecorder recorder(module.get());
+
+  // First checkpoint: a new sharding on an op result and a func argument.
+  setSharding(addOp->getResult(0),
+              parseSharding(R"(#sdy.sharding<@mesh, [{"a", ?}, {?}]>)"));
+  setSharding(mainFn.getArgument(1),
+              parseSharding(R"(#sdy.sharding<@mesh, [{"a", ?}, {?}]>)"));
+  llvm::json::Value firstDelta = recorder.takeDelta();
+  ASSERT_TRUE(succeeded(applyShardingDelta(reconstructed.get(), firstDelta)));
+  EXPECT_EQ(llvm::to_string(*module), llvm::to_string(*reconstructed));
+
+  // Second checkpoint: an updated sharding and a func result sharding.
+  setSharding(addOp->getResult(0),
+              parseSharding(R"(#sdy.sharding<@mesh, [{"a", ?}, {"b", ?}]>)"));
+  setFuncResultSharding(
+      mainFn, 0, parseSharding(R"(#sdy.sharding<@mesh, [{"a"}, {"b"}]>)"));
+  llvm::json::Value secondDelta = recorder.takeDelta();
+  ASSERT_TRUE(succeeded(applyShardingDelta(reconstructed.get(), secondDelta)));
+  EXPECT_EQ(llvm::to_string(*module), llvm::to_string(*reconstructed));
+
+  // Only the changed sharding is in the second delta.
+  const llvm::json::Array* values =
+      secondDelta.getAsObject()->getArray("values");
+  ASSERT_NE(values, nullptr);
+  EXPECT_EQ(values->size(), 1u);
+}
+
+TEST_F(ShardingDeltaTest, EmptyDeltaIfNothingChanged) {
+  OwningOpRef<ModuleOp> module = parseSourceString<ModuleOp>(kModule, &context);
+  ASSERT_TRUE(module);
+  ShardingDeltaRecorder recorder(module.get());
+
+  llvm::json::Value delta = recorder.takeDelta();
+  EXPECT_TRUE(delta.getAsObject()->getArray("values")->empty());
+  EXPECT_TRUE(delta.getAsObject()->getArray("func_results")->empty());
+}
+
+TEST_F(ShardingDeltaTest, MalformedDeltaFails) {
+  OwningOpRef<ModuleOp> module = parseSourceString<ModuleOp>(kModule, &context);
+  ASSERT_TRUE(module);
+  // Suppress the emitted errors.
+  ScopedDiagnosticHandler diagnosticHandler(
+      &context, [](Diagnostic&) { return success(); });
+
+  llvm::json::Value unknownValue = llvm::json::Object{
+      {"values", llvm::json::Array{llvm::json::Array{1000, "x"}}}};
+  EXPECT_TRUE(failed(applyShardingDelta(module.get(), unknownValue)));
+  EXPECT_TRUE(failed(applyShardingDelta(module.get(), llvm::json::Array{})));
+}
+
+}  // namespace
+}  // namespace sdy
+}  // namespace mlir
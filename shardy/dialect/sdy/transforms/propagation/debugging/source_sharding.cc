@@ -16,7 +16,6 @@ limitations under the License.
 #include "shardy/dialect/sdy/transforms/propagation/debugging/source_sharding.h"
 
 #include <algorithm>
-#include <cassert>
 #include <cstdint>
 #include <string>
 
@@ -138,7 +137,7 @@ void saveShardingOriginsOnModule(ModuleOp moduleOp,
     }
 
     SmallVector<NamedAttribute> entries =
-        createOriginShardingEntries(axisToOriginSharding, context);
+        createOriginShardingEntries(*axisToOriginSharding, context);
     if (terminatorOperand) {
       int64_t operandNumber = terminatorOperand->getOperandNumber();
       funcOp.setResultAttr(operandNumber, kOriginShardingAttr,
@@ -280,23 +279,20 @@ void prepareShardingOriginsHandler(ModuleOp moduleOp,
   moduleOp.walk([&](ManualComputationOp manualComputationOp) {
     for (auto [i, sharding] :
          llvm::enumerate(manualComputationOp.getInShardings().getShardings())) {
-      // Assuming that the edges live as the only use of the block arguments.
-      DataFlowEdgeOp edge = DataFlowEdgeOp::getDataFlowEdgeUser(
-          manualComputationOp.getBody().getArgument(i));
-      assert(edge);
-      saveShardingOrigins(mappings->valueToOriginShardingMap, sharding,
-                          OriginShardingType::MC_INPUT, edge.getResult(), i,
-                          sourceId);
+      // The value holding the sharding is either the `DataFlowEdgeOp` of the
+      // block argument, or the block argument itself if there isn't one.
+      saveShardingOrigins(
+          mappings->valueToOriginShardingMap, sharding,
+          OriginShardingType::MC_INPUT,
+          getShardableValue(manualComputationOp.getBody().getArgument(i)), i,
+          sourceId);
     }
     for (auto [i, sharding] : llvm::enumerate(
              manualComputationOp.getOutShardings().getShardings())) {
-      // Assuming that the edges live as the only use of the op results.
-      DataFlowEdgeOp edge =
-          DataFlowEdgeOp::getDataFlowEdgeUser(manualComputationOp.getResult(i));
-      assert(edge);
-      saveShardingOrigins(mappings->valueToOriginShardingMap, sharding,
-                          OriginShardingType::MC_OUTPUT, edge.getResult(), i,
-                          sourceId);
+      saveShardingOrigins(
+          mappings->valueToOriginShardingMap, sharding,
+          OriginShardingType::MC_OUTPUT,
+          getShardableValue(manualComputationOp.getResult(i)), i, sourceId);
     }
     manualComputationOp->setAttr(
         kOriginShardingNameAttr,
@@ -349,11 +345,11 @@ void SourceShardingHandler::operator()(function_ref<void()> transform,
     // Axis may not be in the map for region ops like `ManualComputationOp`
     // where the `out_sharding` refers to a manual axis, but the body's
     // `ReturnOp` doesn't have the manual axis.
-    auto it = axisToEdgeSourceMap.find(newAxisRef);
-    if (it == axisToEdgeSourceMap.end()) {
+    const EdgeSource* sourcePtr = axisToEdgeSourceMap.lookup(newAxisRef);
+    if (!sourcePtr) {
       return;
     }
-    EdgeSource source = it->getSecond();
+    EdgeSource source = *sourcePtr;
     if (mappings->debugEdgeSourceSharding) {
       mappings->valueToEdgeSourceMap[value][newAxisRef] = source;
     }
@@ -428,7 +424,7 @@ void SourceShardingHandler::prepareHandler(ModuleOp moduleOp) {
   if (mappings->debugEdgeSourceSharding) {
     llvm_unreachable("edge sharding not implemented yet");
   }
-  if (mappings->debugShardingOrigins || mappings->debugEdgeSourceSharding) {
+  if (mappings->enabled()) {
     moduleOp->getContext()->registerActionHandler(*this);
   }
 }
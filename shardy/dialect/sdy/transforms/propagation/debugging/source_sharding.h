@@ -16,9 +16,14 @@ limitations under the License.
 #ifndef SHARDY_DIALECT_SDY_TRANSFORMS_PROPAGATION_DEBUGGING_SOURCE_SHARDING_H_
 #define SHARDY_DIALECT_SDY_TRANSFORMS_PROPAGATION_DEBUGGING_SOURCE_SHARDING_H_
 
+#include <cassert>
 #include <cstdint>
+#include <utility>
 
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Allocator.h"
 #include "mlir/IR/Action.h"
 #include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/BuiltinOps.h"
@@ -61,10 +66,119 @@ struct EdgeSource {
   int64_t index;
 };
 
-using AxisToEdgeSourceMap = llvm::DenseMap<AxisRefAttr, EdgeSource>;
-using AxisToOriginShardingMap = llvm::DenseMap<AxisRefAttr, OriginSharding>;
-using ValueToEdgeSourceMap = llvm::DenseMap<Value, AxisToEdgeSourceMap>;
-using ValueToOriginShardingMap = llvm::DenseMap<Value, AxisToOriginShardingMap>;
+// A flat map from axis refs to their source of type `SourceT`.
+//
+// A value is sharded along a handful of axes at most, so a linear scan over
+// inline storage is cheaper (in both time and memory) than a hash map.
+template <typename SourceT>
+class AxisToSourceMap {
+ public:
+  using Entry = std::pair<AxisRefAttr, SourceT>;
+
+  // Inserts `source` for `axisRef` if `axisRef` isn't in the map yet. Returns
+  // true if the source was inserted.
+  bool try_emplace(AxisRefAttr axisRef, SourceT source) {
+    if (find(axisRef) != entries.end()) {
+      return false;
+    }
+    entries.emplace_back(axisRef, source);
+    return true;
+  }
+
+  // Returns the source of `axisRef`, inserting a default constructed one if
+  // `axisRef` isn't in the map yet.
+  SourceT& operator[](AxisRefAttr axisRef) {
+    if (auto it = find(axisRef); it != entries.end()) {
+      return it->second;
+    }
+    return entries.emplace_back(axisRef, SourceT()).second;
+  }
+
+  // Returns the source of `axisRef`, or nullptr if it isn't in the map.
+  const SourceT* lookup(AxisRefAttr axisRef) const {
+    auto it = find(axisRef);
+    return it == entries.end() ? nullptr : &it->second;
+  }
+
+  // Returns the source of `axisRef`, which must be in the map.
+  const SourceT& at(AxisRefAttr axisRef) const {
+    auto it = find(axisRef);
+    assert(it != entries.end() && "axis not in map");
+    return it->second;
+  }
+
+  // Erases `axisRef` from the map. Returns true if it was in the map.
+  bool erase(AxisRefAttr axisRef) {
+    auto it = find(axisRef);
+    if (it == entries.end()) {
+      return false;
+    }
+    entries.erase(it);
+    return true;
+  }
+
+  auto begin() const { return entries.begin(); }
+  auto end() const { return entries.end(); }
+  int64_t size() const { return entries.size(); }
+  bool empty() const { return entries.empty(); }
+
+ private:
+  auto find(AxisRefAttr axisRef) const {
+    return llvm::find_if(
+        entries, [&](const Entry& entry) { return entry.first == axisRef; });
+  }
+  auto find(AxisRefAttr axisRef) {
+    return llvm::find_if(
+        entries, [&](const Entry& entry) { return entry.first == axisRef; });
+  }
+
+  SmallVector<Entry, 4> entries;
+};
+
+// A map from values to their `AxisToSourceMap<SourceT>`.
+//
+// The per-value maps are allocated in an arena owned by this map, and are
+// stable for the lifetime of this map (i.e. rehashing doesn't move them).
+template <typename SourceT>
+class ValueToSourceMap {
+ public:
+  using AxisMap = AxisToSourceMap<SourceT>;
+
+  ValueToSourceMap() = default;
+  ValueToSourceMap(const ValueToSourceMap&) = delete;
+  ValueToSourceMap& operator=(const ValueToSourceMap&) = delete;
+
+  // Returns the axis map of `value`, creating an empty one if `value` isn't in
+  // the map yet.
+  AxisMap& operator[](Value value) {
+    auto [it, inserted] = valueToAxisMap.try_emplace(value, nullptr);
+    if (inserted) {
+      it->second = new (allocator.Allocate()) AxisMap();
+    }
+    return *it->second;
+  }
+
+  // Returns the axis map of `value`, which must be in the map.
+  const AxisMap& at(Value value) const {
+    auto it = valueToAxisMap.find(value);
+    assert(it != valueToAxisMap.end() && "value not in map");
+    return *it->second;
+  }
+
+  // Iterates over (`Value`, `AxisMap*`) pairs.
+  auto begin() const { return valueToAxisMap.begin(); }
+  auto end() const { return valueToAxisMap.end(); }
+  int64_t size() const { return valueToAxisMap.size(); }
+
+ private:
+  llvm::DenseMap<Value, AxisMap*> valueToAxisMap;
+  llvm::SpecificBumpPtrAllocator<AxisMap> allocator;
+};
+
+using AxisToEdgeSourceMap = AxisToSourceMap<EdgeSource>;
+using AxisToOriginShardingMap = AxisToSourceMap<OriginSharding>;
+using ValueToEdgeSourceMap = ValueToSourceMap<EdgeSource>;
+using ValueToOriginShardingMap = ValueToSourceMap<OriginSharding>;
 
 // The mappings used for debugging sharding origins and edge sources.
 struct ShardingDebugMappings {
@@ -77,6 +191,11 @@ struct ShardingDebugMappings {
   ShardingDebugMappings(const ShardingDebugMappings&) = delete;
   ShardingDebugMappings& operator=(const ShardingDebugMappings&) = delete;
 
+  // Returns true if any debugging information is collected.
+  bool enabled() const {
+    return debugShardingOrigins || debugEdgeSourceSharding;
+  }
+
   bool debugShardingOrigins, debugEdgeSourceSharding;
   ValueToEdgeSourceMap valueToEdgeSourceMap;
   ValueToOriginShardingMap valueToOriginShardingMap;
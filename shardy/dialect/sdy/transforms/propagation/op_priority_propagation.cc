@@ -21,6 +21,7 @@ limitations under the License.
 #include <memory>
 #include <numeric>
 
+#include "llvm/Support/FormatVariadic.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/Operation.h"
 #include "mlir/IR/SymbolTable.h"
@@ -28,6 +29,7 @@ limitations under the License.
 #include "mlir/Pass/PassRegistry.h"
 #include "mlir/Support/LLVM.h"
 #include "mlir/Support/LogicalResult.h"
+#include "shardy/common/tracing.h"
 #include "shardy/dialect/sdy/ir/dialect.h"
 #include "shardy/dialect/sdy/transforms/common/op_properties.h"
 #include "shardy/dialect/sdy/transforms/propagation/aggressive_propagation.h"
@@ -132,6 +134,11 @@ LogicalResult OpPriorityPropagationPassImpl::propagate(
   // could have been run earlier already (e.g. with a different user priority).
   for (int64_t currentOpPriority = 0;
        currentOpPriority < opPropagationSchedule.size(); currentOpPriority++) {
+    TraceScope traceScope(
+        [&]() {
+          return llvm::formatv("op_priority_step_{0}", currentOpPriority).str();
+        },
+        "propagation");
     if (AggressivePropagationPassImpl::propagate(
             moduleOp, symbolTable, shardingGroupMap,
             getOpBasedDirectionToPropagate(currentOpPriority,
@@ -13,9 +13,11 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include "llvm/Support/CommandLine.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Pass/PassRegistry.h"
 #include "mlir/Support/LLVM.h"
+#include "shardy/common/tracing.h"
 #include "shardy/dialect/sdy/transforms/export/passes.h"
 #include "shardy/dialect/sdy/transforms/import/passes.h"
 #include "shardy/dialect/sdy/transforms/propagation/basic_propagation.h"
@@ -28,18 +30,72 @@ namespace sdy {
 void addPropagationPipeline(OpPassManager& pm,
                             const PropagationOptions& options,
                             bool skipConvertToReshard) {
-  addImportPipeline(pm, options.dumpDirectory);
+  // Enable tracing at the start of the pipeline, so the import passes, which
+  // run before the propagation pass enables tracing, are traced as well. Note
+  // that the pass manager needs `createTracingInstrumentation` to trace passes.
+  if (!options.traceFile.empty()) {
+    pm.addPass(createEnableTracingPass(options.traceFile));
+  }
+  ImportOptions importOptions;
+  importOptions.dumpDirectory = options.dumpDirectory;
+  importOptions.saveModuleOpOptions = options.saveModuleOpOptions;
+  importOptions.deferConstantSplitting = options.deferConstantSplitting;
+  importOptions.fuseImportPasses = options.fuseImportPasses;
+  importOptions.implicitDataFlowEdges = options.implicitDataFlowEdges;
+  addImportPipeline(pm, importOptions);
   pm.addPass(createUserPriorityPropagationPass(options));
-  addExportPipeline(pm, options.dumpDirectory, skipConvertToReshard);
+  if (options.deferConstantSplitting) {
+    // The user-priority propagation pass uses the default propagation
+    // strategy, which is also the default of this pass.
+    SplitDeferredConstantsPassOptions splitOptions;
+    splitOptions.conservativePropagation = options.conservativePropagation;
+    pm.addPass(createSplitDeferredConstantsPass(splitOptions));
+  }
+  addExportPipeline(pm, options.dumpDirectory, skipConvertToReshard,
+                    options.fuseExportPasses, options.saveModuleOpOptions);
 }
 
+namespace {
+
+struct PropagationPipelineOptions
+    : public PassPipelineOptions<PropagationPipelineOptions> {
+  Option<bool> implicitDataFlowEdges{
+      *this, "implicit-data-flow-edges",
+      llvm::cl::desc("Whether to skip adding `sdy.data_flow_edge` ops, and use "
+                     "the sharding of each edge owner instead."),
+      llvm::cl::init(false)};
+  Option<bool> fuseImportPasses{
+      *this, "fuse-import-passes",
+      llvm::cl::desc("Whether to replace the import passes that can be fused "
+                     "with a single `sdy-fused-import` pass."),
+      llvm::cl::init(false)};
+  Option<bool> fuseExportPasses{
+      *this, "fuse-export-passes",
+      llvm::cl::desc("Whether to replace the export passes that can be fused "
+                     "with a single `sdy-fused-export` pass."),
+      llvm::cl::init(false)};
+  Option<bool> deferConstantSplitting{
+      *this, "defer-constant-splitting",
+      llvm::cl::desc("Whether to defer splitting constant sub-computations "
+                     "until after propagation."),
+      llvm::cl::init(false)};
+};
+
+}  // namespace
+
 void registerPropagationPipeline() {
-  PassPipelineRegistration<>(
+  PassPipelineRegistration<PropagationPipelineOptions>(
       "sdy-propagation-pipeline",
       "Runs the SDY propagation pass, preceded by a sequence of import passes "
       "needed as a pre-processing step for propagation",
-      [](OpPassManager& pm) {
-        return addPropagationPipeline(pm);
+      [](OpPassManager& pm, const PropagationPipelineOptions& pipelineOptions) {
+        PropagationOptions options;
+        options.implicitDataFlowEdges = pipelineOptions.implicitDataFlowEdges;
+        options.deferConstantSplitting =
+            pipelineOptions.deferConstantSplitting;
+        options.fuseImportPasses = pipelineOptions.fuseImportPasses;
+        options.fuseExportPasses = pipelineOptions.fuseExportPasses;
+        return addPropagationPipeline(pm, options);
       });
 }
 
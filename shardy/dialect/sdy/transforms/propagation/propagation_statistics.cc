@@ -0,0 +1,116 @@
+/* Copyright 2024 The Shardy Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "shardy/dialect/sdy/transforms/propagation/propagation_statistics.h"
+
+#include <chrono>
+#include <cstdint>
+#include <utility>
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/STLFunctionalExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/JSON.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/OperationSupport.h"
+#include "mlir/Support/LLVM.h"
+#include "mlir/Support/LogicalResult.h"
+#include "shardy/common/tracing.h"
+
+namespace mlir {
+namespace sdy {
+
+namespace {
+
+// The number of visits between samples of the visit counters in the trace.
+constexpr int64_t kTraceCounterInterval = 1024;
+
+}  // namespace
+
+LogicalResult PropagationStatistics::recordVisit(
+    Operation* op, llvm::function_ref<LogicalResult()> visitFn) {
+  LogicalResult result = success();
+  if (recordPerOpStatistics) {
+    auto start = std::chrono::steady_clock::now();
+    result = visitFn();
+    PerOpStatistics& opStatistics = perOpStatistics[op->getName()];
+    opStatistics.time += std::chrono::steady_clock::now() - start;
+    ++opStatistics.numVisits;
+    if (succeeded(result)) {
+      ++opStatistics.numVisitsWithUpdates;
+    }
+  } else {
+    result = visitFn();
+  }
+  ++numOpsVisited;
+  if (succeeded(result)) {
+    ++numVisitsWithUpdates;
+  }
+  // The greedy driver doesn't expose its worklist, so the number of visits is
+  // sampled instead, to see how propagation progresses over time.
+  if (numOpsVisited % kTraceCounterInterval == 0 && isTracingEnabled()) {
+    addTraceCounter("ops_visited", numOpsVisited);
+    addTraceCounter("visits_with_updates", numVisitsWithUpdates);
+  }
+  return result;
+}
+
+void PropagationStatistics::merge(const PropagationStatistics& other) {
+  numOpsVisited += other.numOpsVisited;
+  numVisitsWithUpdates += other.numVisitsWithUpdates;
+  numProjectionsBuilt += other.numProjectionsBuilt;
+  numShardingAttrsCreated += other.numShardingAttrsCreated;
+  numShardingGroupUpdates += other.numShardingGroupUpdates;
+  for (const auto& [opName, otherOpStatistics] : other.perOpStatistics) {
+    PerOpStatistics& opStatistics = perOpStatistics[opName];
+    opStatistics.numVisits += otherOpStatistics.numVisits;
+    opStatistics.numVisitsWithUpdates +=
+        otherOpStatistics.numVisitsWithUpdates;
+    opStatistics.time += otherOpStatistics.time;
+  }
+}
+
+llvm::json::Value PropagationStatistics::toJson() const {
+  SmallVector<std::pair<OperationName, PerOpStatistics>> sortedPerOp(
+      perOpStatistics.begin(), perOpStatistics.end());
+  llvm::sort(sortedPerOp, [](const auto& lhs, const auto& rhs) {
+    return lhs.second.time > rhs.second.time;
+  });
+
+  llvm::json::Array perOp;
+  for (const auto& [opName, opStatistics] : sortedPerOp) {
+    perOp.push_back(llvm::json::Object{
+        {"op", opName.getStringRef()},
+        {"visits", opStatistics.numVisits},
+        {"visits_with_updates", opStatistics.numVisitsWithUpdates},
+        {"time_us",
+         std::chrono::duration_cast<std::chrono::microseconds>(
+             opStatistics.time)
+             .count()},
+    });
+  }
+
+  return llvm::json::Object{
+      {"ops_visited", numOpsVisited},
+      {"visits_with_updates", numVisitsWithUpdates},
+      {"projections_built", numProjectionsBuilt},
+      {"sharding_attrs_created", numShardingAttrsCreated},
+      {"sharding_group_updates", numShardingGroupUpdates},
+      {"per_op", std::move(perOp)},
+  };
+}
+
+}  // namespace sdy
+}  // namespace mlir
@@ -0,0 +1,86 @@
+/* Copyright 2024 The Shardy Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef SHARDY_DIALECT_SDY_TRANSFORMS_PROPAGATION_PROPAGATION_STATISTICS_H_
+#define SHARDY_DIALECT_SDY_TRANSFORMS_PROPAGATION_PROPAGATION_STATISTICS_H_
+
+#include <chrono>
+#include <cstdint>
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLFunctionalExtras.h"
+#include "llvm/Support/JSON.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/OperationSupport.h"
+#include "mlir/Support/LLVM.h"
+#include "mlir/Support/LogicalResult.h"
+
+namespace mlir {
+namespace sdy {
+
+// Counters collected during propagation, to see where propagation time goes.
+//
+// Not thread safe, propagation that runs on multiple threads should collect
+// statistics per thread, and `merge` them afterwards.
+struct PropagationStatistics {
+  // Visit counts and accumulated time of all ops with the same name.
+  struct PerOpStatistics {
+    int64_t numVisits = 0;
+    int64_t numVisitsWithUpdates = 0;
+    std::chrono::nanoseconds time{0};
+  };
+
+  // Number of times an op was visited by a propagation pattern.
+  int64_t numOpsVisited = 0;
+  // Number of visits that changed the sharding of at least one value.
+  int64_t numVisitsWithUpdates = 0;
+  // Number of `ShardingProjection`s built.
+  int64_t numProjectionsBuilt = 0;
+  // Number of `TensorShardingAttr`s created from a `ShardingProjection`.
+  int64_t numShardingAttrsCreated = 0;
+  // Number of sharding updates of other members of a sharding group.
+  int64_t numShardingGroupUpdates = 0;
+
+  // Whether `recordVisit` also records `perOpStatistics`, which needs a map
+  // lookup and two clock reads per visit. The per-op statistics are only
+  // reported by `toJson`, so this should be set only if they are saved.
+  bool recordPerOpStatistics = false;
+  llvm::DenseMap<OperationName, PerOpStatistics> perOpStatistics;
+
+  // Invokes `visitFn` on `op`, and records the visit, whether it updated any
+  // sharding (i.e., `visitFn` succeeded), and the time it took (if
+  // `recordPerOpStatistics` is set).
+  LogicalResult recordVisit(Operation* op,
+                            llvm::function_ref<LogicalResult()> visitFn);
+
+  // Adds all counters of `other` to this one.
+  void merge(const PropagationStatistics& other);
+
+  // Resets all counters, but keeps `recordPerOpStatistics`.
+  void clear() {
+    bool recordPerOp = recordPerOpStatistics;
+    *this = PropagationStatistics();
+    recordPerOpStatistics = recordPerOp;
+  }
+
+  // Returns a JSON object with all counters, where the per-op statistics are
+  // sorted by time in descending order.
+  llvm::json::Value toJson() const;
+};
+
+}  // namespace sdy
+}  // namespace mlir
+
+#endif  // SHARDY_DIALECT_SDY_TRANSFORMS_PROPAGATION_PROPAGATION_STATISTICS_H_
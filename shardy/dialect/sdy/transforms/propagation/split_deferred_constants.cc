@@ -0,0 +1,198 @@
+/* Copyright 2024 The Shardy Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>  // IWYU pragma: keep
+#include <utility>
+
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/IR/Value.h"
+#include "mlir/IR/Visitors.h"
+#include "mlir/Pass/Pass.h"  // IWYU pragma: keep
+#include "mlir/Support/LLVM.h"
+#include "shardy/dialect/sdy/ir/constants.h"
+#include "shardy/dialect/sdy/ir/dialect.h"
+#include "shardy/dialect/sdy/ir/utils.h"
+#include "shardy/dialect/sdy/transforms/propagation/aggressive_factor_propagation.h"
+#include "shardy/dialect/sdy/transforms/propagation/aggressive_propagation.h"
+#include "shardy/dialect/sdy/transforms/propagation/basic_factor_propagation.h"
+#include "shardy/dialect/sdy/transforms/propagation/basic_propagation.h"
+#include "shardy/dialect/sdy/transforms/propagation/factor_propagation.h"
+#include "shardy/dialect/sdy/transforms/propagation/passes.h"  // IWYU pragma: keep
+#include "shardy/dialect/sdy/transforms/propagation/sharding_group_map.h"
+
+namespace mlir {
+namespace sdy {
+
+#define GEN_PASS_DEF_SPLITDEFERREDCONSTANTSPASS
+#include "shardy/dialect/sdy/transforms/propagation/passes.h.inc"
+
+namespace {
+
+// Returns true if `op` is a marker for a deferred use of a constant
+// sub-computation (see `ConstantSplitterPass`).
+bool isDeferredSplitMarker(Operation* op) {
+  auto barrierOp = dyn_cast<PropagationBarrierOp>(op);
+  return barrierOp && barrierOp->hasAttr(kDeferredConstantSplitAttr);
+}
+
+// Recursively clones all operands of the given op, that are not already mapped
+// in `mapping`, and finally clones the op itself, right before the original op.
+//
+// A deferred sub-computation has no value in a sharding group, so unlike the
+// constant splitter, there are no sharding group users to clone.
+void cloneSubComputation(OpResult opResult, IRMapping& mapping) {
+  if (mapping.lookupOrNull(opResult)) {
+    return;
+  }
+
+  Operation* op = opResult.getOwner();
+  for (Value operand : op->getOperands()) {
+    if (auto defOpResult = dyn_cast<OpResult>(operand)) {
+      cloneSubComputation(defOpResult, mapping);
+    }
+  }
+
+  OpBuilder builder(op);
+  builder.clone(*op, mapping);
+}
+
+// Propagates the sharding of the root of a cloned constant sub-computation to
+// the rest of the clone, with each strategy in `strategies` in order.
+//
+// Propagation is only backward, i.e., from the result of each op to its
+// operands, so no sharding outside of the clone changes. Any sharding rule
+// created on a cloned op is removed afterwards.
+void propagateShardingInClone(
+    ArrayRef<Operation*> clonedOps, const SymbolTable& symbolTable,
+    const ShardingGroupMap& shardingGroupMap,
+    ArrayRef<const FactorPropagation*> strategies,
+    bool conservativePropagation) {
+  SmallVector<Operation*> opsWithoutRule;
+  for (Operation* op : clonedOps) {
+    if (!op->hasAttr(kShardingRuleAttr)) {
+      opsWithoutRule.push_back(op);
+    }
+  }
+  // Visiting users before the ops that define their operands lets the root
+  // sharding reach the entire clone in a single visit of each op.
+  SmallVector<Operation*> reversedOps =
+      llvm::to_vector(llvm::reverse(clonedOps));
+  for (const FactorPropagation* strategy : strategies) {
+    propagateShardingsOnOps(
+        reversedOps, symbolTable, shardingGroupMap, *strategy,
+        [](Operation*) { return PropagationDirection::BACKWARD; },
+        conservativePropagation);
+  }
+  for (Operation* op : opsWithoutRule) {
+    removeShardingRule(op);
+  }
+}
+
+struct SplitDeferredConstantsPass
+    : public impl::SplitDeferredConstantsPassBase<SplitDeferredConstantsPass> {
+  using SplitDeferredConstantsPassBase::SplitDeferredConstantsPassBase;
+
+  void runOnOperation() final {
+    ModuleOp moduleOp = getOperation();
+
+    // Group the markers by the root of the sub-computation they use and their
+    // sharding, so that all uses with the same sharding share a single clone.
+    llvm::MapVector<std::pair<Value, TensorShardingAttr>,
+                    SmallVector<PropagationBarrierOp>>
+        markerGroups;
+    moduleOp.walk([&](PropagationBarrierOp barrierOp) {
+      if (isDeferredSplitMarker(barrierOp)) {
+        Value root = barrierOp.getInput();
+        TensorShardingAttr sharding = getSharding(barrierOp.getResult());
+        markerGroups[{root, sharding}].push_back(barrierOp);
+      }
+    });
+    if (markerGroups.empty()) {
+      markAllAnalysesPreserved();
+      return;
+    }
+
+    SymbolTable symbolTable(moduleOp);
+    ShardingGroupMap shardingGroupMap(moduleOp);
+    SmallVector<const FactorPropagation*, 2> strategies;
+    if (propagationStrategy != PropagationStrategy::Aggressive) {
+      strategies.push_back(&basicFactorPropagation);
+    }
+    if (propagationStrategy != PropagationStrategy::Basic) {
+      strategies.push_back(&aggressiveFactorPropagation);
+    }
+
+    llvm::SmallPtrSet<Operation*, 16> deferredOps;
+    SmallVector<Operation*> worklist;
+    for (auto& [key, markers] : markerGroups) {
+      auto [root, sharding] = key;
+      IRMapping mapping;
+      cloneSubComputation(cast<OpResult>(root), mapping);
+      Value clone = mapping.lookup(root);
+      if (sharding) {
+        setSharding(clone, sharding);
+        SmallVector<Operation*> clonedOps =
+            llvm::to_vector(llvm::make_second_range(mapping.getOperationMap()));
+        llvm::sort(clonedOps, [](Operation* a, Operation* b) {
+          return a->isBeforeInBlock(b);
+        });
+        propagateShardingInClone(clonedOps, symbolTable, shardingGroupMap,
+                                 strategies, conservativePropagation);
+      }
+      for (PropagationBarrierOp markerOp : markers) {
+        markerOp.getResult().replaceAllUsesWith(clone);
+        markerOp.erase();
+      }
+      worklist.push_back(root.getDefiningOp());
+    }
+    while (!worklist.empty()) {
+      Operation* op = worklist.pop_back_val();
+      if (!deferredOps.insert(op).second) {
+        continue;
+      }
+      for (Value operand : op->getOperands()) {
+        if (Operation* defOp = operand.getDefiningOp()) {
+          worklist.push_back(defOp);
+        }
+      }
+    }
+
+    // The original sub-computations are no longer used outside of themselves,
+    // so we erase them, visiting users before the ops that define their
+    // operands.
+    moduleOp.walk<WalkOrder::PostOrder, ReverseIterator>([&](Operation* op) {
+      if (deferredOps.contains(op) && op->use_empty()) {
+        op->erase();
+      }
+    });
+  }
+
+ private:
+  BasicFactorPropagation basicFactorPropagation;
+  AggressiveFactorPropagation aggressiveFactorPropagation;
+};
+
+}  // namespace
+
+}  // namespace sdy
+}  // namespace mlir
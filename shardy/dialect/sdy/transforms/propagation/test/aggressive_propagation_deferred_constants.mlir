@@ -0,0 +1,26 @@
+// RUN: sdy_opt %s -sdy-constant-splitter -sdy-aggressive-propagate 2>&1 | FileCheck %s
+// RUN: sdy_opt %s -sdy-constant-splitter='defer-splitting=true' -sdy-aggressive-propagate -sdy-split-deferred-constants 2>&1 | FileCheck %s
+
+sdy.mesh @mesh = <["a"=2, "b"=2]>
+
+// Eager and deferred constant splitting should give the same result with
+// aggressive propagation, as long as each use ends up with a different
+// sharding.
+// CHECK-LABEL: func @broadcast_in_constant
+func.func @broadcast_in_constant(
+    %arg0: tensor<8x16xf32> {sdy.sharding = #sdy.sharding<@mesh, [{"a"}, {"b"}]>},
+    %arg1: tensor<8x16xf32> {sdy.sharding = #sdy.sharding<@mesh, [{}, {"a"}]>})
+    -> (tensor<8x16xf32>, tensor<8x16xf32>) {
+  // CHECK-NEXT: %[[CONST_0:.*]] = sdy.constant {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"b", ?}]>]>} dense<1.000000e+00> : tensor<16xf32>
+  // CHECK-NEXT: %[[CONST_1:.*]] = sdy.constant {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a", ?}]>]>} dense<1.000000e+00> : tensor<16xf32>
+  // CHECK-NEXT: %[[BROADCAST_0:.*]] = stablehlo.broadcast_in_dim %[[CONST_0]], dims = [1] {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a", ?}, {"b", ?}]>]>}
+  // CHECK-NEXT: %[[BROADCAST_1:.*]] = stablehlo.broadcast_in_dim %[[CONST_1]], dims = [1] {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{?}, {"a", ?}]>]>}
+  // CHECK-NEXT: %[[MUL:.*]] = stablehlo.multiply %[[BROADCAST_0]], %arg0 {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a", ?}, {"b", ?}]>]>}
+  // CHECK-NEXT: %[[SUB:.*]] = stablehlo.subtract %[[BROADCAST_1]], %arg1 {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{?}, {"a", ?}]>]>}
+  // CHECK-NEXT: return %[[MUL]], %[[SUB]]
+  %0 = stablehlo.constant dense<1.000000e+00> : tensor<16xf32>
+  %1 = stablehlo.broadcast_in_dim %0, dims = [1] : (tensor<16xf32>) -> tensor<8x16xf32>
+  %2 = stablehlo.multiply %1, %arg0 : tensor<8x16xf32>
+  %3 = stablehlo.subtract %1, %arg1 : tensor<8x16xf32>
+  return %2, %3 : tensor<8x16xf32>, tensor<8x16xf32>
+}
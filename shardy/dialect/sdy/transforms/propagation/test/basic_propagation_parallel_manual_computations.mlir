@@ -0,0 +1,81 @@
+// RUN: sdy_opt %s -sdy-add-data-flow-edges -sdy-basic-propagate -sdy-sink-data-flow-edges 2>&1 | FileCheck %s
+// RUN: sdy_opt %s -sdy-add-data-flow-edges -sdy-basic-propagate='parallel-manual-computations=true' -sdy-sink-data-flow-edges 2>&1 | FileCheck %s
+
+sdy.mesh @mesh = <["a"=2, "b"=2, "c"=2, "d"=2]>
+
+// The sharding of the first body is only propagated to the second body, and the
+// sharding of the second body only to the first body, after a round of
+// propagating the rest of the module in between.
+// CHECK-LABEL: func @multiple_rounds(
+// CHECK-SAME:      %arg0: tensor<32x32xf32> {sdy.sharding = #sdy.sharding<@mesh, [{"a", ?}, {"b", ?}]>})
+// CHECK-SAME:      -> (tensor<32x32xf32> {sdy.sharding = #sdy.sharding<@mesh, [{"a", ?}, {"b", ?}]>}) {
+func.func @multiple_rounds(%arg0: tensor<32x32xf32>) -> tensor<32x32xf32> {
+  // CHECK:      %[[MC_0:.*]] = sdy.manual_computation(%arg0)
+  // CHECK-SAME{LITERAL}:   in_shardings=[<@mesh, [{"a", ?}, {"b", ?}]>]
+  // CHECK-SAME{LITERAL}:   out_shardings=[<@mesh, [{"a", ?}, {"b", ?}]>]
+  // CHECK-NEXT:   stablehlo.add %arg1, %arg1 {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a", ?}, {"b", ?}]>]>}
+  %0 = sdy.manual_computation(%arg0) in_shardings=[<@mesh, [{?}, {?}]>] out_shardings=[<@mesh, [{?}, {?}]>] manual_axes={} (%arg1: tensor<32x32xf32>) {
+    %3 = stablehlo.add %arg1, %arg1 {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a", ?}, {?}]>]>} : tensor<32x32xf32>
+    sdy.return %3 : tensor<32x32xf32>
+  } : (tensor<32x32xf32>) -> tensor<32x32xf32>
+  // CHECK:      %[[NEGATE:.*]] = stablehlo.negate %[[MC_0]] {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a", ?}, {"b", ?}]>]>}
+  %1 = stablehlo.negate %0 : tensor<32x32xf32>
+  // CHECK-NEXT: sdy.manual_computation(%[[NEGATE]])
+  // CHECK-SAME{LITERAL}:   in_shardings=[<@mesh, [{"a", ?}, {"b", ?}]>]
+  // CHECK-SAME{LITERAL}:   out_shardings=[<@mesh, [{"a", ?}, {"b", ?}]>]
+  // CHECK-NEXT:   stablehlo.multiply %arg1, %arg1 {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a", ?}, {"b", ?}]>]>}
+  %2 = sdy.manual_computation(%1) in_shardings=[<@mesh, [{?}, {?}]>] out_shardings=[<@mesh, [{?}, {?}]>] manual_axes={} (%arg1: tensor<32x32xf32>) {
+    %3 = stablehlo.multiply %arg1, %arg1 {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{?}, {"b", ?}]>]>} : tensor<32x32xf32>
+    sdy.return %3 : tensor<32x32xf32>
+  } : (tensor<32x32xf32>) -> tensor<32x32xf32>
+  return %2 : tensor<32x32xf32>
+}
+
+// The body has values in a sharding group, so it's propagated with the rest
+// of the module instead of on its own.
+// CHECK-LABEL: func @sharding_group_in_body(
+// CHECK-SAME:      -> (tensor<32x32xf32> {sdy.sharding = #sdy.sharding<@mesh, [{"a", ?}, {?}]>}) {
+func.func @sharding_group_in_body(
+    %arg0: tensor<32x32xf32> {sdy.sharding = #sdy.sharding<@mesh, [{"a", ?}, {?}]>})
+    -> tensor<32x32xf32> {
+  // CHECK:      sdy.manual_computation(%arg0)
+  // CHECK-SAME{LITERAL}:   in_shardings=[<@mesh, [{"a", ?}, {?}]>]
+  // CHECK-SAME{LITERAL}:   out_shardings=[<@mesh, [{"a", ?}, {?}]>]
+  // CHECK-NEXT:   %[[ADD:.*]] = stablehlo.add %arg1, %arg1 {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a", ?}, {?}]>]>}
+  // CHECK-NEXT:   %[[CC:.*]] = stablehlo.custom_call @sdy_testonly(%[[ADD]])
+  // CHECK-NEXT:   stablehlo.negate %[[CC]] {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a", ?}, {?}]>]>}
+  %0 = sdy.manual_computation(%arg0) in_shardings=[<@mesh, [{?}, {?}]>] out_shardings=[<@mesh, [{?}, {?}]>] manual_axes={} (%arg1: tensor<32x32xf32>) {
+    %1 = stablehlo.add %arg1, %arg1 : tensor<32x32xf32>
+    %2 = stablehlo.custom_call @sdy_testonly(%1) : (tensor<32x32xf32>) -> tensor<32x32xf32>
+    %3 = stablehlo.negate %2 : tensor<32x32xf32>
+    sdy.sharding_group %1 group_id=0 : tensor<32x32xf32>
+    sdy.sharding_group %3 group_id=0 : tensor<32x32xf32>
+    sdy.return %3 : tensor<32x32xf32>
+  } : (tensor<32x32xf32>) -> tensor<32x32xf32>
+  return %0 : tensor<32x32xf32>
+}
+
+// The nested manual computation is propagated together with the body of the
+// outer one.
+// CHECK-LABEL: func @nested_manual_computations(
+// CHECK-SAME:      %arg0: tensor<32x32xf32> {sdy.sharding = #sdy.sharding<@mesh, [{"a", "c", ?}, {"b", ?}]>})
+// CHECK-SAME:      -> (tensor<32x32xf32> {sdy.sharding = #sdy.sharding<@mesh, [{"a", ?}, {"b", "d", ?}]>}) {
+func.func @nested_manual_computations(
+    %arg0: tensor<32x32xf32> {sdy.sharding = #sdy.sharding<@mesh, [{"a", "c", ?}, {?}]>})
+    -> tensor<32x32xf32> {
+  // CHECK:      sdy.manual_computation(%arg0)
+  // CHECK:        sdy.manual_computation(%arg1)
+  // CHECK-NEXT:     %[[ADD:.*]] = stablehlo.add %arg2, %arg2 {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"c", ?}, {?}]>]>}
+  // CHECK-NEXT:     %[[CC:.*]] = stablehlo.custom_call @sdy_testonly(%[[ADD]])
+  // CHECK-NEXT:     stablehlo.multiply %[[CC]], %[[CC]] {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{?}, {"d", ?}]>]>}
+  %0 = sdy.manual_computation(%arg0) in_shardings=[<@mesh, [{"a", ?}, {?}]>] out_shardings=[<@mesh, [{"a", ?}, {?}]>] manual_axes={"a"} (%arg1: tensor<16x32xf32>) {
+    %1 = sdy.manual_computation(%arg1) in_shardings=[<@mesh, [{?}, {"b", ?}]>] out_shardings=[<@mesh, [{?}, {"b", ?}]>] manual_axes={"b"} (%arg2: tensor<16x16xf32>) {
+      %2 = stablehlo.add %arg2, %arg2 : tensor<16x16xf32>
+      %3 = stablehlo.custom_call @sdy_testonly(%2) : (tensor<16x16xf32>) -> tensor<16x16xf32>
+      %4 = stablehlo.multiply %3, %3 {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{?}, {"d", ?}]>]>} : tensor<16x16xf32>
+      sdy.return %4 : tensor<16x16xf32>
+    } : (tensor<16x32xf32>) -> tensor<16x32xf32>
+    sdy.return %1 : tensor<16x32xf32>
+  } : (tensor<32x32xf32>) -> tensor<32x32xf32>
+  return %0 : tensor<32x32xf32>
+}
@@ -0,0 +1,18 @@
+// RUN: sdy_opt %s -sdy-basic-propagate -mlir-pass-statistics 2>&1 | FileCheck %s
+
+sdy.mesh @mesh = <["a"=2, "b"=2]>
+
+// CHECK-LABEL: func @statistics
+func.func @statistics(%arg0: tensor<8x8xf32> {sdy.sharding = #sdy.sharding<@mesh, [{"a"}, {"b"}]>},
+                      %arg1: tensor<8x8xf32>) -> tensor<8x8xf32> {
+  %0 = stablehlo.add %arg0, %arg1 : tensor<8x8xf32>
+  %1 = stablehlo.add %0, %0 : tensor<8x8xf32>
+  return %1 : tensor<8x8xf32>
+}
+
+// CHECK:     Pass statistics report
+// CHECK-DAG: (S) {{[1-9][0-9]*}} num-ops-visited
+// CHECK-DAG: (S) {{[1-9][0-9]*}} num-projections-built
+// CHECK-DAG: (S) {{[1-9][0-9]*}} num-sharding-attrs-created
+// CHECK-DAG: (S) 0 num-sharding-group-updates
+// CHECK-DAG: (S) {{[1-9][0-9]*}} num-visits-with-updates
@@ -1,4 +1,5 @@
 // RUN: sdy_opt %s -sdy-propagation-pipeline 2>&1 | FileCheck %s
+// RUN: sdy_opt %s -sdy-propagation-pipeline='implicit-data-flow-edges=true' 2>&1 | FileCheck %s
 
 // Propagation tests for ops with data-flow edges like CaseOp and WhileOp
 
@@ -369,6 +370,33 @@ func.func @while_result_use(%arg0: tensor<32x96xf32>) -> tensor<32x96xf32> {
   return %4 : tensor<32x96xf32>
 }
 
+// Check propagation through a WhileOp whose body returns each block argument
+// in place of the other, so each edge updates a source of the other edge.
+// CHECK-LABEL: func @while_swapped_block_args(
+// CHECK-SAME:      %arg0: tensor<32x96xf32> {sdy.sharding = #sdy.sharding<@mesh_a_2_b_2, [{"a"}, {"b"}]>},
+// CHECK-SAME:      %arg1: tensor<32x96xf32> {sdy.sharding = #sdy.sharding<@mesh_a_2_b_2, [{"a", ?}, {"b", ?}]>})
+// CHECK-SAME:      -> (tensor<32x96xf32> {sdy.sharding = #sdy.sharding<@mesh_a_2_b_2, [{"a", ?}, {"b", ?}]>},
+// CHECK-SAME:          tensor<32x96xf32> {sdy.sharding = #sdy.sharding<@mesh_a_2_b_2, [{"a", ?}, {"b", ?}]>})
+func.func @while_swapped_block_args(
+    %arg0: tensor<32x96xf32> {sdy.sharding = #sdy.sharding<@mesh_a_2_b_2, [{"a"}, {"b"}]>},
+    %arg1: tensor<32x96xf32>) -> (tensor<32x96xf32>, tensor<32x96xf32>) {
+  // CHECK: %[[C0:.*]] = sdy.constant dense<0>
+  %0 = sdy.constant dense<0> : tensor<i32>
+  %1 = sdy.constant dense<1> : tensor<i32>
+  %2 = sdy.constant dense<32> : tensor<i32>
+  // CHECK: stablehlo.while(%iterArg = %arg0, %iterArg_0 = %arg1, %iterArg_1 = %[[C0]]) : tensor<32x96xf32>, tensor<32x96xf32>, tensor<i32>
+  // CHECK-SAME: {sdy.sharding = #sdy.sharding_per_value<[<@mesh_a_2_b_2, [{"a", ?}, {"b", ?}]>, <@mesh_a_2_b_2, [{"a", ?}, {"b", ?}]>, {{.*}}]>}
+  %3:3 = stablehlo.while(%iterArg = %arg0, %iterArg_0 = %arg1, %iterArg_1 = %0) : tensor<32x96xf32>, tensor<32x96xf32>, tensor<i32>
+    cond {
+    %4 = stablehlo.compare  LT, %iterArg_1, %2 : (tensor<i32>, tensor<i32>) -> tensor<i1>
+    stablehlo.return %4 : tensor<i1>
+  } do {
+    %4 = stablehlo.add %iterArg_1, %1 : tensor<i32>
+    stablehlo.return %iterArg_0, %iterArg, %4 : tensor<32x96xf32>, tensor<32x96xf32>, tensor<i32>
+  }
+  return %3#0, %3#1 : tensor<32x96xf32>, tensor<32x96xf32>
+}
+
 // Check propagation starting inside the body of the while can go out of the
 // body through the block argument of the body. We prevent forwards propagation
 // in the body by making the use of the sharded op be not partitionable.
@@ -0,0 +1,25 @@
+// RUN: sdy_opt %s -sdy-propagation-pipeline 2>&1 | FileCheck %s
+// RUN: sdy_opt %s -sdy-propagation-pipeline='defer-constant-splitting=true' 2>&1 | FileCheck %s
+
+sdy.mesh @mesh = <["a"=2, "b"=2]>
+
+// Eager and deferred constant splitting should give the same result. With
+// eager splitting, the clones that end up with the same sharding are merged
+// during export.
+// CHECK-LABEL: func @sharded_constant
+func.func @sharded_constant(
+    %arg0: tensor<8x16xf32> {sdy.sharding = #sdy.sharding<@mesh, [{}, {"b"}]>},
+    %arg1: tensor<8x16xf32>, %arg2: tensor<8x16xf32>)
+    -> (tensor<8x16xf32>, tensor<8x16xf32>, tensor<8x16xf32>) {
+  // CHECK-NEXT: %[[CONST_0:.*]] = sdy.constant {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a"}, {"b", ?}]>]>} dense<1.000000e+00>
+  // CHECK-NEXT: %[[CONST_1:.*]] = sdy.constant {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a"}, {?}]>]>} dense<1.000000e+00>
+  // CHECK-NEXT: %[[ADD:.*]] = stablehlo.add %[[CONST_0]], %arg0 {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a", ?}, {"b", ?}]>]>}
+  // CHECK-NEXT: %[[MUL:.*]] = stablehlo.multiply %[[CONST_1]], %arg1 {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a", ?}, {?}]>]>}
+  // CHECK-NEXT: %[[SUB:.*]] = stablehlo.subtract %[[CONST_1]], %arg2 {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a", ?}, {?}]>]>}
+  // CHECK-NEXT: return %[[ADD]], %[[MUL]], %[[SUB]]
+  %0 = stablehlo.constant {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a"}, {?}]>]>} dense<1.000000e+00> : tensor<8x16xf32>
+  %1 = stablehlo.add %0, %arg0 : tensor<8x16xf32>
+  %2 = stablehlo.multiply %0, %arg1 : tensor<8x16xf32>
+  %3 = stablehlo.subtract %0, %arg2 : tensor<8x16xf32>
+  return %1, %2, %3 : tensor<8x16xf32>, tensor<8x16xf32>, tensor<8x16xf32>
+}
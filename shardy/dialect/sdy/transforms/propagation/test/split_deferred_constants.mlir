@@ -0,0 +1,61 @@
+// RUN: sdy_opt %s -sdy-split-deferred-constants 2>&1 | FileCheck %s
+// RUN: sdy_opt %s -sdy-split-deferred-constants='propagation-strategy=basic' 2>&1 | FileCheck %s
+
+sdy.mesh @mesh = <["a"=2, "b"=2]>
+
+// CHECK-LABEL: func @one_clone_per_sharding
+func.func @one_clone_per_sharding(%arg0: tensor<8x16xf32>) -> (tensor<8x16xf32>, tensor<8x16xf32>, tensor<8x16xf32>) {
+  // CHECK-NEXT: %[[IOTA_0:.*]] = stablehlo.iota dim = 0 {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a", ?}, {?}]>]>} : tensor<8x16xf32>
+  // CHECK-NEXT: %[[IOTA_1:.*]] = stablehlo.iota dim = 0 {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{?}, {"b", ?}]>]>} : tensor<8x16xf32>
+  // CHECK-NEXT: %[[ADD_0:.*]] = stablehlo.add %[[IOTA_0]], %[[IOTA_0]] {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a", ?}, {?}]>]>}
+  // CHECK-NEXT: %[[ADD_1:.*]] = stablehlo.add %[[IOTA_1]], %[[IOTA_1]] {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{?}, {"b", ?}]>]>}
+  // CHECK-NEXT: %[[MUL_0:.*]] = stablehlo.multiply %[[ADD_0]], %arg0
+  // CHECK-NEXT: %[[MUL_1:.*]] = stablehlo.multiply %[[ADD_1]], %arg0
+  // CHECK-NEXT: %[[MUL_2:.*]] = stablehlo.multiply %[[ADD_0]], %arg0
+  // CHECK-NEXT: return %[[MUL_0]], %[[MUL_1]], %[[MUL_2]]
+  %0 = stablehlo.iota dim = 0 : tensor<8x16xf32>
+  %1 = stablehlo.add %0, %0 : tensor<8x16xf32>
+  %2 = sdy.propagation_barrier %1 allowed_direction=NONE {sdy.deferred_constant_split, sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a", ?}, {?}]>]>} : tensor<8x16xf32>
+  %3 = stablehlo.multiply %2, %arg0 : tensor<8x16xf32>
+  %4 = sdy.propagation_barrier %1 allowed_direction=NONE {sdy.deferred_constant_split, sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{?}, {"b", ?}]>]>} : tensor<8x16xf32>
+  %5 = stablehlo.multiply %4, %arg0 : tensor<8x16xf32>
+  %6 = sdy.propagation_barrier %1 allowed_direction=NONE {sdy.deferred_constant_split, sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a", ?}, {?}]>]>} : tensor<8x16xf32>
+  %7 = stablehlo.multiply %6, %arg0 : tensor<8x16xf32>
+  return %3, %5, %7 : tensor<8x16xf32>, tensor<8x16xf32>, tensor<8x16xf32>
+}
+
+// CHECK-LABEL: func @broadcast_in_clone
+func.func @broadcast_in_clone(%arg0: tensor<8x16xf32>) -> (tensor<8x16xf32>, tensor<8x16xf32>) {
+  // CHECK-NEXT: %[[CONST:.*]] = sdy.constant {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"b", ?}]>]>} dense<1.000000e+00> : tensor<16xf32>
+  // CHECK-NEXT: %[[BROADCAST:.*]] = stablehlo.broadcast_in_dim %[[CONST]], dims = [1] {sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a"}, {"b"}]>]>}
+  // CHECK-NEXT: %[[ADD:.*]] = stablehlo.add %[[BROADCAST]], %arg0
+  // CHECK-NEXT: %[[SUB:.*]] = stablehlo.subtract %[[BROADCAST]], %arg0
+  // CHECK-NEXT: return %[[ADD]], %[[SUB]]
+  %0 = sdy.constant dense<1.000000e+00> : tensor<16xf32>
+  %1 = stablehlo.broadcast_in_dim %0, dims = [1] : (tensor<16xf32>) -> tensor<8x16xf32>
+  %2 = sdy.propagation_barrier %1 allowed_direction=NONE {sdy.deferred_constant_split, sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a"}, {"b"}]>]>} : tensor<8x16xf32>
+  %3 = stablehlo.add %2, %arg0 : tensor<8x16xf32>
+  %4 = sdy.propagation_barrier %1 allowed_direction=NONE {sdy.deferred_constant_split, sdy.sharding = #sdy.sharding_per_value<[<@mesh, [{"a"}, {"b"}]>]>} : tensor<8x16xf32>
+  %5 = stablehlo.subtract %4, %arg0 : tensor<8x16xf32>
+  return %3, %5 : tensor<8x16xf32>, tensor<8x16xf32>
+}
+
+// CHECK-LABEL: func @unsharded_uses
+func.func @unsharded_uses(%arg0: tensor<8x16xf32>) -> (tensor<8x16xf32>, tensor<8x16xf32>) {
+  // CHECK-NEXT: %[[CONST:.*]] = sdy.constant dense<1.000000e+00>
+  // CHECK-NEXT: %[[ADD:.*]] = stablehlo.add %[[CONST]], %arg0
+  // CHECK-NEXT: return %[[CONST]], %[[ADD]]
+  %0 = sdy.constant dense<1.000000e+00> : tensor<8x16xf32>
+  %1 = sdy.propagation_barrier %0 allowed_direction=NONE {sdy.deferred_constant_split} : tensor<8x16xf32>
+  %2 = stablehlo.add %1, %arg0 : tensor<8x16xf32>
+  %3 = sdy.propagation_barrier %0 allowed_direction=NONE {sdy.deferred_constant_split} : tensor<8x16xf32>
+  return %3, %2 : tensor<8x16xf32>, tensor<8x16xf32>
+}
+
+// CHECK-LABEL: func @unmarked_barrier_is_kept
+func.func @unmarked_barrier_is_kept(%arg0: tensor<8x16xf32>) -> tensor<8x16xf32> {
+  // CHECK-NEXT: %[[BARRIER:.*]] = sdy.propagation_barrier %arg0 allowed_direction=NONE
+  // CHECK-NEXT: return %[[BARRIER]]
+  %0 = sdy.propagation_barrier %arg0 allowed_direction=NONE : tensor<8x16xf32>
+  return %0 : tensor<8x16xf32>
+}
@@ -19,6 +19,7 @@ limitations under the License.
 #include <cstdint>
 #include <iterator>
 #include <memory>
+#include <optional>
 #include <utility>
 #include <variant>
 
@@ -37,11 +38,14 @@ limitations under the License.
 #include "mlir/Support/LLVM.h"
 #include "mlir/Support/LogicalResult.h"
 #include "shardy/common/file_utils.h"
+#include "shardy/common/tracing.h"
 #include "shardy/dialect/sdy/ir/data_flow_utils.h"
 #include "shardy/dialect/sdy/ir/dialect.h"
+#include "shardy/dialect/sdy/transforms/common/attribute_footprint.h"
 #include "shardy/dialect/sdy/transforms/common/sharding_walker.h"
 #include "shardy/dialect/sdy/transforms/propagation/auto_partitioner_registry.h"
 #include "shardy/dialect/sdy/transforms/propagation/basic_propagation.h"
+#include "shardy/dialect/sdy/transforms/propagation/debugging/sharding_delta.h"
 #include "shardy/dialect/sdy/transforms/propagation/op_priority_propagation.h"
 #include "shardy/dialect/sdy/transforms/propagation/sharding_group_map.h"
 
@@ -224,11 +228,33 @@ struct UserPriorityPropagationPass
   }
 };
 
-void saveModuleOpAfterPriority(ModuleOp moduleOp, StringRef dumpDirectory,
-                               int64_t priority) {
+// Saves `moduleOp` after propagating shardings with the given `priority`, or
+// only the sharding changes since the previous priority if `deltaRecorder` is
+// set.
+void saveModuleOpAfterPriority(
+    ModuleOp moduleOp, StringRef dumpDirectory,
+    const SaveModuleOpOptions& saveModuleOpOptions, int64_t priority,
+    std::optional<ShardingDeltaRecorder>& deltaRecorder) {
+  if (deltaRecorder) {
+    saveJson(deltaRecorder->takeDelta(), dumpDirectory,
+             llvm::formatv("sdy_sharding_delta_after_user_priority_{0}",
+                           priority)
+                 .str(),
+             /*pretty=*/false);
+    return;
+  }
   saveModuleOp(
       moduleOp, dumpDirectory,
-      llvm::formatv("sdy_module_after_user_priority_{0}", priority).str());
+      llvm::formatv("sdy_module_after_user_priority_{0}", priority).str(),
+      saveModuleOpOptions);
+}
+
+// Records the SDY attribute footprint of `moduleOp` as trace counters, so that
+// the attribute growth of each priority shows up in the trace.
+void traceAttributeFootprint(ModuleOp moduleOp) {
+  if (isTracingEnabled()) {
+    SdyAttributeFootprint::collect(moduleOp).addTraceCounters();
+  }
 }
 
 }  // namespace
@@ -237,24 +263,43 @@ LogicalResult UserPriorityPropagationPassImpl::propagate(
     ModuleOp moduleOp, const SymbolTable& symbolTable,
     const ShardingGroupMap& shardingGroupMap,
     GetDirectionToPropagateFn getDirectionToPropagate) {
+  SaveModuleOpOptions saveModuleOpOptions = getSaveModuleOpOptions();
+  std::optional<ShardingDeltaRecorder> deltaRecorder;
+  if (dumpShardingDeltas && !dumpDirectory.empty()) {
+    // The deltas of all priorities are relative to this module.
+    saveModuleOp(moduleOp, dumpDirectory, "sdy_module_before_user_priorities",
+                 saveModuleOpOptions);
+    deltaRecorder.emplace(moduleOp);
+  }
   SmallVector<PriorityShardingReferences> shardingReferencesPerPriority =
       getShardingReferencesPerPriorityAndInitialize(moduleOp, symbolTable);
   // We first run the first iteration (priority 0):
-  if (failed(OpPriorityPropagationPassImpl::propagate(
-          moduleOp, symbolTable, shardingGroupMap, getDirectionToPropagate))) {
-    return failure();
+  {
+    TraceScope traceScope("user_priority_0", "propagation");
+    if (failed(OpPriorityPropagationPassImpl::propagate(
+            moduleOp, symbolTable, shardingGroupMap,
+            getDirectionToPropagate))) {
+      return failure();
+    }
   }
-  saveModuleOpAfterPriority(moduleOp, dumpDirectory, 0);
+  saveModuleOpAfterPriority(moduleOp, dumpDirectory, saveModuleOpOptions, 0,
+                            deltaRecorder);
+  traceAttributeFootprint(moduleOp);
   // Then we run the remaining iterations (priority >0):
   for (const auto& [priority, shardingReferences] :
        shardingReferencesPerPriority) {
+    TraceScope traceScope(
+        [&]() { return llvm::formatv("user_priority_{0}", priority).str(); },
+        "propagation");
     updateReferencedShardingsForPriority(shardingReferences, priority);
     if (failed(OpPriorityPropagationPassImpl::propagate(
             moduleOp, symbolTable, shardingGroupMap,
             getDirectionToPropagate))) {
       return failure();
     }
-    saveModuleOpAfterPriority(moduleOp, dumpDirectory, priority);
+    saveModuleOpAfterPriority(moduleOp, dumpDirectory, saveModuleOpOptions,
+                              priority, deltaRecorder);
+    traceAttributeFootprint(moduleOp);
   }
 
   // Finally we run automatic partitioning if enabled by the user
@@ -263,8 +308,10 @@ LogicalResult UserPriorityPropagationPassImpl::propagate(
       useAutoSpmdPartitioning && useAutoSpmdPartitioning.getValue()) {
     PassManager autoPartitionerPm(moduleOp.getContext());
     AutoPartitionerRegistry::addPasses(autoPartitionerPm);
-    autoPartitionerPm.addPass(createSaveModuleOpPass(
-        dumpDirectory, "sdy_module_after_auto_partitioning"));
+    autoPartitionerPm.addPass(
+        createSaveModuleOpPass(dumpDirectory,
+                               "sdy_module_after_auto_partitioning",
+                               saveModuleOpOptions));
     if (failed(runPipeline(autoPartitionerPm, moduleOp))) {
       return failure();
     }
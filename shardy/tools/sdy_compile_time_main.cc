@@ -0,0 +1,417 @@
+/* Copyright 2024 The Shardy Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Tool for measuring the compile time of an SDY pass pipeline on a module, and
+// detecting regressions against a baseline.
+//
+// The module is loaded once, and the pipeline is run `-n` times on clones of
+// it. The tool reports, as JSON, the median wall time of the pipeline and of
+// each pass, the peak resident set size of the process, and the number of SDY
+// attributes in the module after the pipeline (see `SdyAttributeFootprint`).
+// Passes are run single threaded so the times are stable.
+//
+// Usage:
+//   sdy_compile_time <module> [-pass-pipeline=<passes>] [-n <runs>] \
+//     [-o <report>] [-baseline=<report>] [-time-threshold=<ratio>] ...
+//
+// Instead of a module file, a synthetic module (see `SyntheticModuleKind`) can
+// be used, e.g. `-synthetic=transformer -synthetic-scale=16`.
+//
+// To detect regressions, save a report of the current version with `-o`, and
+// pass it as `-baseline` to the new version. The tool prints each metric that
+// regressed beyond its threshold, and returns 1 if any did.
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/ToolOutputFile.h"
+#include "llvm/Support/raw_ostream.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Diagnostics.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Pass/PassInstrumentation.h"
+#include "mlir/Pass/PassManager.h"
+#include "mlir/Pass/PassRegistry.h"
+#include "mlir/Support/FileUtilities.h"
+#include "mlir/Support/LLVM.h"
+#include "mlir/Support/LogicalResult.h"
+#include "mlir/Transforms/Passes.h"
+#include "shardy/benchmarks/synthetic_modules.h"
+#include "shardy/dialect/sdy/ir/register.h"
+#include "shardy/dialect/sdy/transforms/common/attribute_footprint.h"
+#include "shardy/dialect/sdy/transforms/passes.h"
+
+namespace {
+
+using ::mlir::sdy::SdyAttrKind;
+using ::mlir::sdy::SdyAttributeFootprint;
+using ::mlir::sdy::SyntheticModuleKind;
+
+llvm::cl::opt<std::string> inputFilename(llvm::cl::Positional,
+                                         llvm::cl::desc("<module>"),
+                                         llvm::cl::init(""));
+
+llvm::cl::opt<std::string> syntheticModule(
+    "synthetic",
+    llvm::cl::desc("use a synthetic module of this kind instead of a file, "
+                   "one of transformer, moe, conv_net and while_loop"),
+    llvm::cl::init(""));
+
+llvm::cl::opt<int64_t> syntheticScale(
+    "synthetic-scale", llvm::cl::desc("the scale of the synthetic module"),
+    llvm::cl::init(4));
+
+llvm::cl::opt<std::string> passPipeline(
+    "pass-pipeline",
+    llvm::cl::desc("the passes to run on the module, in the textual pass "
+                   "pipeline format without the builtin.module anchor"),
+    llvm::cl::init("sdy-propagation-pipeline"));
+
+llvm::cl::opt<int64_t> numRuns("n",
+                               llvm::cl::desc("the number of measured runs"),
+                               llvm::cl::init(10));
+
+llvm::cl::opt<int64_t> numWarmupRuns(
+    "warmup", llvm::cl::desc("the number of runs before the measured runs"),
+    llvm::cl::init(1));
+
+llvm::cl::opt<std::string> outputFilename(
+    "o", llvm::cl::desc("the file to write the report to"),
+    llvm::cl::value_desc("filename"), llvm::cl::init("-"));
+
+llvm::cl::opt<std::string> baselineFilename(
+    "baseline",
+    llvm::cl::desc("a report of a previous run to compare against"),
+    llvm::cl::init(""));
+
+llvm::cl::opt<double> timeThreshold(
+    "time-threshold",
+    llvm::cl::desc("the relative increase in wall time that is a regression"),
+    llvm::cl::init(0.1));
+
+llvm::cl::opt<double> minTimeDeltaMs(
+    "min-time-delta-ms",
+    llvm::cl::desc("the increase in wall time in milliseconds below which "
+                   "it isn't a regression, to ignore noise in short passes"),
+    llvm::cl::init(1.0));
+
+llvm::cl::opt<double> memoryThreshold(
+    "memory-threshold",
+    llvm::cl::desc("the relative increase in peak RSS that is a regression"),
+    llvm::cl::init(0.1));
+
+llvm::cl::opt<double> attributeThreshold(
+    "attribute-threshold",
+    llvm::cl::desc("the relative increase in the number of SDY attributes "
+                   "that is a regression"),
+    llvm::cl::init(0.0));
+
+using Clock = std::chrono::steady_clock;
+
+double getElapsedMs(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+int64_t getPeakRssBytes() {
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  // `ru_maxrss` is in kilobytes on Linux.
+  return static_cast<int64_t>(usage.ru_maxrss) * 1024;
+}
+
+double getMedian(llvm::SmallVector<double> values) {
+  if (values.empty()) {
+    return 0;
+  }
+  llvm::sort(values);
+  int64_t middle = values.size() / 2;
+  if (values.size() % 2 == 1) {
+    return values[middle];
+  }
+  return (values[middle - 1] + values[middle]) / 2;
+}
+
+// Adds the wall time of each pass to `passTimesMs`, summing the times of all
+// runs of the same pass (e.g. on different functions). Passes must run on a
+// single thread.
+//
+// Only leaf passes are recorded, i.e., passes that don't run nested passes, as
+// the time of the others (e.g. the adaptors that run passes nested under
+// functions) includes the time of their nested passes.
+class PassTimingInstrumentation : public mlir::PassInstrumentation {
+ public:
+  explicit PassTimingInstrumentation(
+      llvm::MapVector<std::string, double>& passTimesMs)
+      : passTimesMs(passTimesMs) {}
+
+  void runBeforePass(mlir::Pass*, mlir::Operation*) override {
+    if (!openPasses.empty()) {
+      openPasses.back().hasNestedPasses = true;
+    }
+    openPasses.push_back({Clock::now(), /*hasNestedPasses=*/false});
+  }
+
+  void runAfterPass(mlir::Pass* pass, mlir::Operation*) override {
+    recordPass(pass);
+  }
+
+  void runAfterPassFailed(mlir::Pass* pass, mlir::Operation*) override {
+    recordPass(pass);
+  }
+
+ private:
+  struct OpenPass {
+    Clock::time_point start;
+    bool hasNestedPasses;
+  };
+
+  void recordPass(mlir::Pass* pass) {
+    OpenPass openPass = openPasses.pop_back_val();
+    if (openPass.hasNestedPasses) {
+      return;
+    }
+    llvm::StringRef name = pass->getArgument();
+    if (name.empty()) {
+      name = pass->getName();
+    }
+    passTimesMs[name.str()] += getElapsedMs(openPass.start);
+  }
+
+  llvm::MapVector<std::string, double>& passTimesMs;
+  llvm::SmallVector<OpenPass> openPasses;
+};
+
+mlir::OwningOpRef<mlir::ModuleOp> loadModule(mlir::MLIRContext* context,
+                                             llvm::SourceMgr& sourceMgr) {
+  if (syntheticModule.empty()) {
+    return mlir::parseSourceFile<mlir::ModuleOp>(inputFilename, sourceMgr,
+                                                 context);
+  }
+  for (SyntheticModuleKind kind :
+       {SyntheticModuleKind::kTransformer,
+        SyntheticModuleKind::kMixtureOfExperts, SyntheticModuleKind::kConvNet,
+        SyntheticModuleKind::kWhileLoop}) {
+    if (mlir::sdy::getSyntheticModuleKindName(kind) == syntheticModule) {
+      return mlir::sdy::parseSyntheticModule(context, kind, syntheticScale);
+    }
+  }
+  llvm::errs() << "unknown synthetic module kind: " << syntheticModule << "\n";
+  return nullptr;
+}
+
+// Runs the pipeline on clones of `moduleOp` and returns the report.
+std::optional<llvm::json::Object> measure(mlir::ModuleOp moduleOp) {
+  mlir::MLIRContext* context = moduleOp.getContext();
+  llvm::MapVector<std::string, double> passTimesMs;
+  mlir::PassManager pm(context);
+  if (mlir::failed(mlir::parsePassPipeline(passPipeline, pm))) {
+    return std::nullopt;
+  }
+  pm.addInstrumentation(
+      std::make_unique<PassTimingInstrumentation>(passTimesMs));
+
+  llvm::SmallVector<double> wallTimesMs;
+  llvm::MapVector<std::string, llvm::SmallVector<double>> passWallTimesMs;
+  std::optional<SdyAttributeFootprint> footprint;
+  for (int64_t run = 0; run < numWarmupRuns + numRuns; ++run) {
+    mlir::OwningOpRef<mlir::ModuleOp> clonedModuleOp = moduleOp.clone();
+    passTimesMs.clear();
+    Clock::time_point start = Clock::now();
+    if (mlir::failed(pm.run(clonedModuleOp.get()))) {
+      return std::nullopt;
+    }
+    double wallTimeMs = getElapsedMs(start);
+    if (run < numWarmupRuns) {
+      continue;
+    }
+    wallTimesMs.push_back(wallTimeMs);
+    for (const auto& [name, timeMs] : passTimesMs) {
+      passWallTimesMs[name].push_back(timeMs);
+    }
+    if (!footprint) {
+      footprint = SdyAttributeFootprint::collect(clonedModuleOp.get());
+    }
+  }
+
+  llvm::json::Object passesJson;
+  for (const auto& [name, timesMs] : passWallTimesMs) {
+    passesJson[name] = getMedian(timesMs);
+  }
+  llvm::json::Object attributesJson;
+  if (footprint) {
+    for (int64_t kind = 0; kind < mlir::sdy::kNumSdyAttrKinds; ++kind) {
+      auto sdyAttrKind = static_cast<SdyAttrKind>(kind);
+      attributesJson[mlir::sdy::getSdyAttrKindName(sdyAttrKind)] =
+          (*footprint)[sdyAttrKind].count;
+    }
+    attributesJson["total"] = footprint->total().count;
+  }
+  return llvm::json::Object{
+      {"pass_pipeline", passPipeline},
+      {"runs", static_cast<int64_t>(numRuns)},
+      {"wall_time_ms", getMedian(wallTimesMs)},
+      {"pass_wall_time_ms", std::move(passesJson)},
+      {"peak_rss_bytes", getPeakRssBytes()},
+      {"attributes", std::move(attributesJson)},
+  };
+}
+
+// Compares the metrics of `report` against `baseline`, printing each metric
+// and whether it regressed. Metrics that are missing from either are skipped.
+// Returns the number of regressions.
+int64_t compareToBaseline(const llvm::json::Object& report,
+                          const llvm::json::Object& baseline) {
+  int64_t numRegressions = 0;
+  auto compare = [&](llvm::StringRef name, std::optional<double> current,
+                     std::optional<double> previous, double threshold,
+                     double minDelta) {
+    if (!current || !previous) {
+      return;
+    }
+    double delta = *current - *previous;
+    bool regressed = delta > std::max(*previous * threshold, minDelta);
+    numRegressions += regressed;
+    llvm::errs() << llvm::formatv(
+        "{0,-60} {1,14:f2} -> {2,14:f2} ({3}{4:f1}%){5}\n", name, *previous,
+        *current, delta >= 0 ? "+" : "",
+        *previous != 0 ? delta / *previous * 100 : 0.0,
+        regressed ? "  REGRESSION" : "");
+  };
+  auto compareObjects = [&](llvm::StringRef key, double threshold,
+                            double minDelta) {
+    const llvm::json::Object* current = report.getObject(key);
+    const llvm::json::Object* previous = baseline.getObject(key);
+    if (!current || !previous) {
+      return;
+    }
+    for (const auto& [name, value] : *current) {
+      if (const llvm::json::Value* previousValue = previous->get(name)) {
+        compare(llvm::formatv("{0}.{1}", key, llvm::StringRef(name)).str(),
+                value.getAsNumber(),
+                previousValue->getAsNumber(), threshold, minDelta);
+      }
+    }
+  };
+
+  compare("wall_time_ms", report.getNumber("wall_time_ms"),
+          baseline.getNumber("wall_time_ms"), timeThreshold, minTimeDeltaMs);
+  compareObjects("pass_wall_time_ms", timeThreshold, minTimeDeltaMs);
+  compare("peak_rss_bytes", report.getNumber("peak_rss_bytes"),
+          baseline.getNumber("peak_rss_bytes"), memoryThreshold, 0);
+  compareObjects("attributes", attributeThreshold, 0);
+  return numRegressions;
+}
+
+std::optional<llvm::json::Object> loadBaseline() {
+  std::string errorMessage;
+  std::unique_ptr<llvm::MemoryBuffer> file =
+      mlir::openInputFile(baselineFilename, &errorMessage);
+  if (!file) {
+    llvm::errs() << errorMessage << "\n";
+    return std::nullopt;
+  }
+  llvm::Expected<llvm::json::Value> baseline =
+      llvm::json::parse(file->getBuffer());
+  if (!baseline) {
+    llvm::errs() << "error when parsing " << baselineFilename << ": "
+                 << llvm::toString(baseline.takeError()) << "\n";
+    return std::nullopt;
+  }
+  if (llvm::json::Object* baselineObject = baseline->getAsObject()) {
+    return std::move(*baselineObject);
+  }
+  llvm::errs() << "baseline must be a JSON object\n";
+  return std::nullopt;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  llvm::InitLLVM initLlvm(argc, argv);
+  mlir::registerTransformsPasses();
+  mlir::sdy::registerAllSdyPassesAndPipelines();
+  llvm::cl::ParseCommandLineOptions(argc, argv, "SDY compile time tool\n");
+
+  if (inputFilename.empty() == syntheticModule.empty()) {
+    llvm::errs() << "exactly one of a module file and -synthetic must be "
+                    "specified\n";
+    return 1;
+  }
+
+  mlir::MLIRContext context;
+  mlir::sdy::loadAllRequiredDialects(&context);
+  context.disableMultithreading();
+
+  llvm::SourceMgr sourceMgr;
+  mlir::SourceMgrDiagnosticHandler diagnosticHandler(sourceMgr, &context);
+  mlir::OwningOpRef<mlir::ModuleOp> moduleOp = loadModule(&context, sourceMgr);
+  if (!moduleOp) {
+    return 1;
+  }
+
+  std::optional<llvm::json::Object> report = measure(moduleOp.get());
+  if (!report) {
+    return 1;
+  }
+
+  int64_t numRegressions = 0;
+  if (!baselineFilename.empty()) {
+    std::optional<llvm::json::Object> baseline = loadBaseline();
+    if (!baseline) {
+      return 1;
+    }
+    numRegressions = compareToBaseline(*report, *baseline);
+  }
+
+  std::string errorMessage;
+  std::unique_ptr<llvm::ToolOutputFile> output =
+      mlir::openOutputFile(outputFilename, &errorMessage);
+  if (!output) {
+    llvm::errs() << errorMessage << "\n";
+    return 1;
+  }
+  output->os() << llvm::formatv("{0:2}\n",
+                                llvm::json::Value(std::move(*report)));
+  output->keep();
+
+  if (numRegressions > 0) {
+    llvm::errs() << numRegressions << " metrics regressed\n";
+    return 1;
+  }
+  return 0;
+}
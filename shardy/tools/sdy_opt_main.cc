@@ -18,16 +18,170 @@ limitations under the License.
 // Usage:
 //   sdy_opt <file> <llvm options>
 
+#include <memory>
+#include <string>
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/ToolOutputFile.h"
+#include "llvm/Support/raw_ostream.h"
+#include "mlir/Bytecode/BytecodeWriter.h"
 #include "mlir/Dialect/Func/Extensions/AllExtensions.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Dialect/Quant/IR/Quant.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Diagnostics.h"
 #include "mlir/IR/DialectRegistry.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
 #include "mlir/InitAllPasses.h"
+#include "mlir/Pass/PassManager.h"
+#include "mlir/Support/FileUtilities.h"
+#include "mlir/Support/LogicalResult.h"
 #include "mlir/Tools/mlir-opt/MlirOptMain.h"
+#include "shardy/common/lazy_module_loader.h"
+#include "shardy/common/save_module_op.h"
+#include "shardy/common/tracing.h"
 #include "shardy/dialect/sdy/ir/dialect.h"
+#include "shardy/dialect/sdy/transforms/common/attribute_footprint.h"
 #include "shardy/dialect/sdy/transforms/passes.h"
 #include "stablehlo/dialect/StablehloOps.h"
 
+namespace {
+
+llvm::cl::opt<bool> printShardingAliases(
+    "sdy-print-sharding-aliases",
+    llvm::cl::desc("print shardings and sharding rules as aliases defined at "
+                   "the top of the module, including in dumped modules"));
+
+llvm::cl::opt<bool> printAttributeFootprint(
+    "sdy-print-attribute-footprint",
+    llvm::cl::desc("print the number and approximate size of SDY attributes "
+                   "referenced by the module before the first pass and after "
+                   "each module pass"));
+
+// Adds the SDY pass instrumentations to `pm`: tracing (which only records
+// anything if tracing is enabled), and the attribute footprint if requested.
+void addSdyInstrumentations(mlir::PassManager& pm) {
+  pm.addInstrumentation(mlir::sdy::createTracingInstrumentation());
+  if (printAttributeFootprint) {
+    pm.addInstrumentation(mlir::sdy::createAttributeFootprintInstrumentation());
+  }
+}
+
+// Same as `MlirOptMain`, but adds the SDY instrumentations to the pass manager.
+mlir::LogicalResult runWithSdyInstrumentations(
+    llvm::StringRef inputFilename, llvm::StringRef outputFilename,
+    mlir::DialectRegistry& dialects) {
+  mlir::MlirOptMainConfig config =
+      mlir::MlirOptMainConfig::createFromCLOptions();
+  config.setPassPipelineSetupFn(
+      [cliConfig = config](mlir::PassManager& pm) -> mlir::LogicalResult {
+        addSdyInstrumentations(pm);
+        return cliConfig.setupPassPipeline(pm);
+      });
+
+  std::string errorMessage;
+  std::unique_ptr<llvm::MemoryBuffer> input =
+      mlir::openInputFile(inputFilename, &errorMessage);
+  if (!input) {
+    llvm::errs() << errorMessage << "\n";
+    return mlir::failure();
+  }
+  std::unique_ptr<llvm::ToolOutputFile> output =
+      mlir::openOutputFile(outputFilename, &errorMessage);
+  if (!output) {
+    llvm::errs() << errorMessage << "\n";
+    return mlir::failure();
+  }
+  if (mlir::failed(mlir::MlirOptMain(output->os(), std::move(input), dialects,
+                                     config))) {
+    return mlir::failure();
+  }
+  output->keep();
+  return mlir::success();
+}
+
+llvm::cl::opt<bool> lazyLoadFunctionBodies(
+    "sdy-lazy-load-function-bodies",
+    llvm::cl::desc("for bytecode input, only read the bodies of functions that "
+                   "are reachable from public symbols, dropping the others "
+                   "without reading them"));
+
+// Same as `MlirOptMain`, but loads the module with
+// `loadModuleWithReachableBodies`.
+//
+// Only supports the options of `MlirOptMain` that affect the pass pipeline and
+// the output format, and fails if any other option that changes the behavior
+// of `MlirOptMain` is set.
+mlir::LogicalResult runWithLazyLoading(llvm::StringRef inputFilename,
+                                       llvm::StringRef outputFilename,
+                                       mlir::DialectRegistry& dialects) {
+  mlir::MlirOptMainConfig config =
+      mlir::MlirOptMainConfig::createFromCLOptions();
+  if (!config.inputSplitMarker().empty() || config.shouldVerifyDiagnostics() ||
+      config.bytecodeVersionToEmit()) {
+    llvm::errs() << "--sdy-lazy-load-function-bodies can't be combined with "
+                    "--split-input-file, --verify-diagnostics or "
+                    "--emit-bytecode-version\n";
+    return mlir::failure();
+  }
+
+  std::string errorMessage;
+  std::unique_ptr<llvm::MemoryBuffer> input =
+      mlir::openInputFile(inputFilename, &errorMessage);
+  if (!input) {
+    llvm::errs() << errorMessage << "\n";
+    return mlir::failure();
+  }
+  std::unique_ptr<llvm::ToolOutputFile> output =
+      mlir::openOutputFile(outputFilename, &errorMessage);
+  if (!output) {
+    llvm::errs() << errorMessage << "\n";
+    return mlir::failure();
+  }
+
+  mlir::MLIRContext context(dialects);
+  context.allowUnregisteredDialects(config.shouldAllowUnregisteredDialects());
+  auto sourceMgr = std::make_shared<llvm::SourceMgr>();
+  sourceMgr->AddNewSourceBuffer(std::move(input), llvm::SMLoc());
+  mlir::SourceMgrDiagnosticHandler diagnosticHandler(*sourceMgr, &context);
+
+  mlir::OwningOpRef<mlir::ModuleOp> module =
+      mlir::sdy::loadModuleWithReachableBodies(sourceMgr, &context);
+  if (!module) {
+    return mlir::failure();
+  }
+
+  mlir::PassManager pm(&context, mlir::ModuleOp::getOperationName(),
+                       mlir::OpPassManager::Nesting::Implicit);
+  pm.enableVerifier(config.shouldVerifyPasses());
+  if (mlir::failed(mlir::applyPassManagerCLOptions(pm))) {
+    return mlir::failure();
+  }
+  addSdyInstrumentations(pm);
+  if (mlir::failed(config.setupPassPipeline(pm)) ||
+      mlir::failed(pm.run(*module))) {
+    return mlir::failure();
+  }
+
+  if (config.shouldEmitBytecode()) {
+    if (mlir::failed(mlir::writeBytecodeToFile(*module, output->os()))) {
+      return mlir::failure();
+    }
+  } else {
+    module->print(output->os());
+    output->os() << "\n";
+  }
+  output->keep();
+  return mlir::success();
+}
+
+}  // namespace
+
 int main(int argc, char** argv) {
   mlir::registerAllPasses();
 
@@ -39,6 +193,32 @@ int main(int argc, char** argv) {
   // Register all SDY passes and pipelines.
   mlir::sdy::registerAllSdyPassesAndPipelines();
 
-  return mlir::asMainReturnCode(
-      mlir::MlirOptMain(argc, argv, "SDY pass driver\n", dialects));
+  auto [inputFilename, outputFilename] = mlir::registerAndParseCLIOptions(
+      argc, argv, "SDY pass driver\n", dialects);
+  // These options don't read the input, so they're left to `MlirOptMain`.
+  mlir::MlirOptMainConfig config =
+      mlir::MlirOptMainConfig::createFromCLOptions();
+  if (config.shouldShowDialects() || config.shouldListPasses()) {
+    return mlir::asMainReturnCode(mlir::MlirOptMain(
+        argc, argv, inputFilename, outputFilename, dialects));
+  }
+  // Prints a stack trace on a crash, same as `MlirOptMain`.
+  llvm::InitLLVM initLLVM(argc, argv);
+  if (printShardingAliases) {
+    // The option is set per context, so it's applied to each context that
+    // loads the SDY dialect.
+    dialects.addExtension(
+        +[](mlir::MLIRContext*, mlir::sdy::SdyDialect* dialect) {
+          dialect->setPrintShardingAliases(true);
+        });
+  }
+  mlir::LogicalResult result = mlir::success();
+  if (lazyLoadFunctionBodies) {
+    result = runWithLazyLoading(inputFilename, outputFilename, dialects);
+  } else {
+    result =
+        runWithSdyInstrumentations(inputFilename, outputFilename, dialects);
+  }
+  mlir::sdy::waitForPendingModuleSaves();
+  return mlir::asMainReturnCode(result);
 }
@@ -0,0 +1,118 @@
+/* Copyright 2024 The Shardy Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Tool for reconstructing an intermediate module of SDY propagation from the
+// sharding deltas dumped with `dump-sharding-deltas`.
+//
+// Usage:
+//   sdy_reconstruct_module <base module> [<delta>...] [-o <output file>]
+//
+// Where the base module is the module dumped before the first checkpoint
+// (e.g. `sdy_module_before_user_priorities.mlir`), and the deltas are applied
+// in the given order, e.g., to reconstruct the module after user priority 2:
+//
+//   sdy_reconstruct_module sdy_module_before_user_priorities.mlir \
+//     sdy_sharding_delta_after_user_priority_0.json \
+//     sdy_sharding_delta_after_user_priority_1.json \
+//     sdy_sharding_delta_after_user_priority_2.json
+
+#include <memory>
+#include <string>
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/ToolOutputFile.h"
+#include "llvm/Support/raw_ostream.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Diagnostics.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Support/FileUtilities.h"
+#include "mlir/Support/LogicalResult.h"
+#include "shardy/dialect/sdy/ir/register.h"
+#include "shardy/dialect/sdy/transforms/propagation/debugging/sharding_delta.h"
+
+namespace {
+
+llvm::cl::opt<std::string> baseModuleFilename(llvm::cl::Positional,
+                                              llvm::cl::desc("<base module>"),
+                                              llvm::cl::Required);
+
+llvm::cl::list<std::string> deltaFilenames(llvm::cl::Positional,
+                                           llvm::cl::desc("<delta>..."));
+
+llvm::cl::opt<std::string> outputFilename("o",
+                                          llvm::cl::desc("Output filename"),
+                                          llvm::cl::value_desc("filename"),
+                                          llvm::cl::init("-"));
+
+mlir::LogicalResult applyDeltaFile(mlir::ModuleOp moduleOp,
+                                   llvm::StringRef deltaFilename) {
+  std::string errorMessage;
+  std::unique_ptr<llvm::MemoryBuffer> file =
+      mlir::openInputFile(deltaFilename, &errorMessage);
+  if (!file) {
+    llvm::errs() << errorMessage << "\n";
+    return mlir::failure();
+  }
+  llvm::Expected<llvm::json::Value> delta =
+      llvm::json::parse(file->getBuffer());
+  if (!delta) {
+    llvm::errs() << "error when parsing " << deltaFilename << ": "
+                 << llvm::toString(delta.takeError()) << "\n";
+    return mlir::failure();
+  }
+  return mlir::sdy::applyShardingDelta(moduleOp, *delta);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  llvm::InitLLVM initLlvm(argc, argv);
+  llvm::cl::ParseCommandLineOptions(argc, argv, "SDY module reconstructor\n");
+
+  mlir::MLIRContext context;
+  mlir::sdy::loadAllRequiredDialects(&context);
+
+  llvm::SourceMgr sourceMgr;
+  mlir::SourceMgrDiagnosticHandler diagnosticHandler(sourceMgr, &context);
+  mlir::OwningOpRef<mlir::ModuleOp> moduleOp =
+      mlir::parseSourceFile<mlir::ModuleOp>(baseModuleFilename, sourceMgr,
+                                            &context);
+  if (!moduleOp) {
+    return 1;
+  }
+
+  for (const std::string& deltaFilename : deltaFilenames) {
+    if (mlir::failed(applyDeltaFile(moduleOp.get(), deltaFilename))) {
+      return 1;
+    }
+  }
+
+  std::string errorMessage;
+  std::unique_ptr<llvm::ToolOutputFile> output =
+      mlir::openOutputFile(outputFilename, &errorMessage);
+  if (!output) {
+    llvm::errs() << errorMessage << "\n";
+    return 1;
+  }
+  moduleOp->print(output->os());
+  output->keep();
+  return 0;
+}